@@ -6,7 +6,10 @@
 #include <zephyr/drivers/i2s.h>
 #include <zephyr/drivers/gpio.h>
 #include <string.h>
-#include <math.h>
+#include <app/drivers/audio/es8311.h>
+#include <app/lib/audio_mix.h>
+#include <app/lib/audio_osc.h>
+#include <app/lib/audio_out.h>
 
 LOG_MODULE_REGISTER(app_main, CONFIG_APP_LOG_LEVEL);
 
@@ -14,38 +17,63 @@ LOG_MODULE_REGISTER(app_main, CONFIG_APP_LOG_LEVEL);
 #define SAMPLE_FREQUENCY    16000  /* 16kHz sample rate */
 #define SAMPLE_BIT_WIDTH    16     /* 16-bit samples */
 #define BYTES_PER_SAMPLE    sizeof(int16_t)
-#define NUMBER_OF_CHANNELS  2      /* Stereo output */
-#define SAMPLES_PER_BLOCK   ((SAMPLE_FREQUENCY / 10) * NUMBER_OF_CHANNELS)  /* 100ms blocks */
+#define NUMBER_OF_CHANNELS  1      /* Mono, the ES8311 has a single DAC */
+#define SAMPLES_PER_BLOCK   ((SAMPLE_FREQUENCY / 100) * NUMBER_OF_CHANNELS)  /* 10ms blocks */
+#define FRAMES_PER_BLOCK    (SAMPLE_FREQUENCY / 100)
 #define BLOCK_SIZE          (BYTES_PER_SAMPLE * SAMPLES_PER_BLOCK)
-#define BLOCK_COUNT         4
+#define BLOCK_DEPTH         3      /* Blocks queued ahead of the DMA, 30ms latency */
 #define TIMEOUT_MS          1000
 
-/* Memory slab for audio buffers */
-K_MEM_SLAB_DEFINE_STATIC(tx_mem_slab, BLOCK_SIZE, BLOCK_COUNT, 4);
+/* Playback engine, fills blocks ahead of the I2S DMA */
+AUDIO_OUT_DEFINE(audio_out, BLOCK_SIZE, BLOCK_DEPTH);
 
-/* Generate a sine wave tone for testing audio output */
-static void generate_tone(void *mem_block, uint32_t num_samples, uint32_t *phase, uint32_t frequency) {
-    int16_t *samples = (int16_t *) mem_block;
-    const int16_t amplitude = 8000; /* Amplitude (about 25% of max to avoid clipping) */
+/* Mixer feeding the engine: the tone stream plus sound effects */
+#define MIX_VOICES          4
+AUDIO_MIX_DEFINE(mixer, MIX_VOICES, NUMBER_OF_CHANNELS, FRAMES_PER_BLOCK);
 
-    for (uint32_t i = 0; i < num_samples; i += NUMBER_OF_CHANNELS) {
-        /* Calculate sine wave sample */
-        uint32_t angle = (*phase * frequency * 360) / SAMPLE_FREQUENCY;
-        angle = angle % 360;
+/* Sound effects decoded into RAM at startup, 1 second in total */
+AUDIO_MIX_CACHE_DEFINE(sfx_cache, SAMPLE_FREQUENCY, 2);
 
-        /* Simple sine approximation (for demonstration) */
-        double radians = (double) angle * 3.14159265359 / 180.0;
-        int16_t sample = (int16_t) (amplitude * sin(radians));
+/* Tone generation parameters */
+static const uint32_t tone_frequencies[] = {440, 880, 1320}; /* A4, A5, E6 notes */
+#define FRAMES_PER_TONE     (3 * SAMPLE_FREQUENCY) /* 3 seconds per tone */
+#define TONE_AMPLITUDE      8000 /* Q15, about 25% of full scale to avoid clipping */
 
-        /* Write to both channels (stereo) */
-        samples[i] = sample; /* Left channel */
-        samples[i + 1] = sample; /* Right channel */
+struct tone_state {
+    struct audio_osc osc;
+    uint32_t freq_idx;
+    uint32_t frames;
+};
 
-        (*phase)++;
-        if (*phase >= SAMPLE_FREQUENCY) {
-            *phase = 0;
-        }
+/* Stream voice of the mixer, runs on the engine thread */
+static size_t tone_render(int16_t *dst, size_t frames, void *user_data) {
+    struct tone_state *tone = user_data;
+
+    audio_osc_fill(&tone->osc, dst, frames, 1);
+
+    /* Change tone every 3 seconds, the phase carries over so there is no click */
+    tone->frames += frames;
+    if (tone->frames >= FRAMES_PER_TONE) {
+        tone->frames -= FRAMES_PER_TONE;
+        tone->freq_idx = (tone->freq_idx + 1) % ARRAY_SIZE(tone_frequencies);
+        audio_osc_set_freq(&tone->osc, tone_frequencies[tone->freq_idx], SAMPLE_FREQUENCY);
     }
+
+    return frames;
+}
+
+/* Beep effect: 80 ms of a 2 kHz square wave */
+#define BEEP_FRAMES         (SAMPLE_FREQUENCY * 80 / 1000)
+#define BEEP_FREQUENCY      2000
+#define BEEP_AMPLITUDE      6000
+
+static int beep_decode(int16_t *dst, size_t frames, void *user_data) {
+    struct audio_osc osc;
+
+    audio_osc_init(&osc, AUDIO_OSC_SQUARE, BEEP_FREQUENCY, SAMPLE_FREQUENCY, BEEP_AMPLITUDE);
+    audio_osc_fill(&osc, dst, frames, 1);
+
+    return 0;
 }
 
 int main(void) {
@@ -71,6 +99,11 @@ int main(void) {
         printk("ERROR: Codec device not ready\n");
         return -ENODEV;
     }
+    ret = es8311_init_wait(codec, K_SECONDS(1));
+    if (ret < 0) {
+        printk("ERROR: Codec init failed: %d\n", ret);
+        return ret;
+    }
     printk("ES8311 codec ready\n");
 
     /* Get the I2S device */
@@ -93,9 +126,6 @@ int main(void) {
                 .format = I2S_FMT_DATA_FORMAT_I2S,
                 .options = I2S_OPT_FRAME_CLK_MASTER | I2S_OPT_BIT_CLK_MASTER,
                 .frame_clk_freq = SAMPLE_FREQUENCY,
-                .mem_slab = &tx_mem_slab,
-                .block_size = BLOCK_SIZE,
-                .timeout = TIMEOUT_MS,
             },
         },
     };
@@ -129,111 +159,69 @@ int main(void) {
     /* Apply codec properties */
     audio_codec_apply_properties(codec);
 
-    /* Configure I2S for TX (transmit/playback) */
+    /* Stream format, the engine provides the memory slab and block size */
     struct i2s_config i2s_cfg = {
         .word_size = SAMPLE_BIT_WIDTH,
         .channels = NUMBER_OF_CHANNELS,
         .format = I2S_FMT_DATA_FORMAT_I2S,
         .options = I2S_OPT_BIT_CLK_MASTER | I2S_OPT_FRAME_CLK_MASTER,
         .frame_clk_freq = SAMPLE_FREQUENCY,
-        .mem_slab = &tx_mem_slab,
-        .block_size = BLOCK_SIZE,
         .timeout = TIMEOUT_MS,
     };
+    static struct tone_state tone;
+    const struct audio_mix_voice_cfg tone_cfg = {.gain = INT16_MAX, .fade_ms = 50};
+    const struct audio_mix_voice_cfg beep_cfg = {.gain = INT16_MAX, .fade_ms = 5};
+    const struct audio_mix_sound *beep;
+
+    audio_mix_init(&mixer, SAMPLE_FREQUENCY);
+    beep = audio_mix_cache_add(&sfx_cache, BEEP_FRAMES, beep_decode, NULL);
+    if (beep == NULL) {
+        printk("ERROR: Failed to cache the beep\n");
+        return -ENOMEM;
+    }
 
-    ret = i2s_configure(i2s_dev, I2S_DIR_TX, &i2s_cfg);
+    audio_osc_init(&tone.osc, AUDIO_OSC_SINE, tone_frequencies[0], SAMPLE_FREQUENCY,
+                   TONE_AMPLITUDE);
+    ret = audio_mix_play_stream(&mixer, tone_render, &tone, &tone_cfg);
     if (ret < 0) {
-        printk("ERROR: Failed to configure I2S TX: %d\n", ret);
+        printk("ERROR: Failed to start the tone voice: %d\n", ret);
         return ret;
     }
-    printk("I2S TX configured\n");
-
-    /* Tone generation parameters */
-    uint32_t phase = 0;
-    uint32_t tone_frequencies[] = {440, 880, 1320}; /* A4, A5, E6 notes */
-    uint32_t current_freq_idx = 0;
-    uint32_t blocks_per_tone = 30; /* 3 seconds per tone at 100ms blocks */
-    uint32_t block_count = 0;
-
-    /* Pre-fill the I2S TX queue with initial buffers before starting */
-    printk("Pre-filling I2S TX buffers...\n");
-    for (int i = 0; i < 2; i++) {
-        void *mem_block;
-        ret = k_mem_slab_alloc(&tx_mem_slab, &mem_block, K_MSEC(TIMEOUT_MS));
-        if (ret < 0) {
-            printk("ERROR: Failed to allocate initial buffer: %d\n", ret);
-            return ret;
-        }
-
-        /* Generate initial tone data */
-        generate_tone(mem_block, SAMPLES_PER_BLOCK, &phase, tone_frequencies[0]);
-
-        /* Queue the buffer */
-        ret = i2s_write(i2s_dev, mem_block, BLOCK_SIZE);
-        if (ret < 0) {
-            printk("ERROR: Failed to queue initial buffer: %d\n", ret);
-            k_mem_slab_free(&tx_mem_slab, mem_block);
-            return ret;
-        }
-    }
-    printk("Initial buffers queued\n");
 
-    /* Start I2S transmission */
-    ret = i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_START);
+    /* Fills the queue, starts I2S TX and keeps it fed from the engine thread */
+    ret = audio_out_start(&audio_out, i2s_dev, &i2s_cfg, audio_mix_fill, &mixer);
     if (ret < 0) {
-        printk("ERROR: Failed to start I2S TX: %d\n", ret);
+        printk("ERROR: Failed to start playback: %d\n", ret);
         return ret;
     }
+    if (audio_out_is_expanding(&audio_out)) {
+        printk("I2S has no mono mode, frames are sent on both slots\n");
+    }
     printk("\n>>> Starting audio playback <<<\n");
-    printk("Playing sine wave tones...\n\n");
+    printk("Playing sine wave tones with a beep every second...\n\n");
 
-
-    /* Main loop: Generate and send audio data */
+    /* Beep and print status every second */
     while (1) {
-        void *mem_block;
-
-        /* Allocate a memory block for audio data */
-        ret = k_mem_slab_alloc(&tx_mem_slab, &mem_block, K_MSEC(TIMEOUT_MS));
-        if (ret < 0) {
-            printk("ERROR: Failed to allocate memory block: %d\n", ret);
-            k_sleep(K_MSEC(100));
-            continue;
-        }
+        struct audio_out_stats stats;
+        struct audio_mix_stats mix_stats;
 
-        /* Generate tone data */
-        uint32_t current_freq = tone_frequencies[current_freq_idx];
-        generate_tone(mem_block, SAMPLES_PER_BLOCK, &phase, current_freq);
-
-        /* Write audio data to I2S */
-        ret = i2s_write(i2s_dev, mem_block, BLOCK_SIZE);
+        k_sleep(K_SECONDS(1));
+        ret = audio_mix_play(&mixer, beep, &beep_cfg);
         if (ret < 0) {
-            printk("ERROR: Failed to write I2S data: %d\n", ret);
-            k_mem_slab_free(&tx_mem_slab, mem_block);
-            k_sleep(K_MSEC(100));
-            continue;
-        }
-
-        block_count++;
-
-        /* Change tone every N blocks */
-        if (block_count % blocks_per_tone == 0) {
-            current_freq_idx = (current_freq_idx + 1) % 3;
-            phase = 0; /* Reset phase for clean transition */
-            printk("Switching to %u Hz tone\n", tone_frequencies[current_freq_idx]);
-        }
-
-        /* Print status every 10 blocks (~1 second) */
-        if (block_count % 10 == 0) {
-            printk("Playing: %u Hz | Blocks sent: %u (%u.%u seconds)\n",
-                   current_freq, block_count, block_count / 10, block_count % 10);
+            printk("Beep dropped: %d\n", ret);
         }
 
-        /* Optional: Add stop condition after some time or button press */
-        // Can add stop condition here if needed
+        audio_out_get_stats(&audio_out, &stats);
+        audio_mix_get_stats(&mixer, &mix_stats);
+        printk("Playing: %u Hz | Blocks sent: %u | underruns %u, late fills %u, "
+               "min depth %u, max fill %u us | voices %u, max mix %u cycles\n",
+               tone_frequencies[tone.freq_idx], stats.blocks, stats.underruns,
+               stats.late_fills, stats.min_depth, stats.max_fill_us,
+               mix_stats.max_voices, mix_stats.max_cycles);
     }
 
-    /* Stop I2S (unreachable in current loop, but shown for completeness) */
-    i2s_trigger(i2s_dev, I2S_DIR_TX, I2S_TRIGGER_STOP);
+    /* Stop playback (unreachable in current loop, but shown for completeness) */
+    audio_out_stop(&audio_out);
     printk("Audio playback stopped\n");
 
     return 0;
@@ -1,19 +1,40 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/sensor.h>
+#include <app/drivers/sensor/qmi8658.h>
 #include <stdio.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_main, CONFIG_APP_LOG_LEVEL);
 
+static K_SEM_DEFINE(drdy_sem, 0, 1);
+
+static void drdy_handler(const struct device *dev, const struct sensor_trigger *trig) {
+    ARG_UNUSED(dev);
+    ARG_UNUSED(trig);
+
+    k_sem_give(&drdy_sem);
+}
+
 int main(void) {
     const struct device *const dev = DEVICE_DT_GET_ONE(qst_qmi8658);
     struct sensor_value acc[3], gyr[3];
     struct sensor_value full_scale, sampling_freq;
+    const struct sensor_trigger drdy_trig = {
+        .type = SENSOR_TRIG_DATA_READY,
+        .chan = SENSOR_CHAN_ALL,
+    };
+    bool use_trigger;
+    int ret;
 
     if (!device_is_ready(dev)) {
         LOG_ERR("Device %s is not ready\n", dev->name);
         return 0;
     }
+    ret = qmi8658_init_wait(dev, K_SECONDS(1));
+    if (ret < 0) {
+        LOG_ERR("Device %s init failed: %d", dev->name, ret);
+        return ret;
+    }
 
     LOG_INF("Device %p name is %s\n", dev, dev->name);
 
@@ -48,9 +69,17 @@ int main(void) {
                     SENSOR_ATTR_SAMPLING_FREQUENCY,
                     &sampling_freq);
 
+    /* Pace reads by the data ready interrupt when int-gpios is wired */
+    use_trigger = sensor_trigger_set(dev, &drdy_trig, drdy_handler) == 0;
+    LOG_INF("Sampling paced by %s", use_trigger ? "data ready trigger" : "sleep");
+
     while (1) {
-        /* 10ms period, 100Hz Sampling frequency */
-        k_sleep(K_MSEC(50));
+        if (use_trigger) {
+            k_sem_take(&drdy_sem, K_FOREVER);
+        } else {
+            /* 10ms period, 100Hz Sampling frequency */
+            k_sleep(K_MSEC(50));
+        }
 
         sensor_sample_fetch(dev);
 
@@ -14,7 +14,11 @@
 #include <zephyr/drivers/clock_control.h>
 #include <zephyr/audio/codec.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
 #include <zephyr/sys/util.h>
+#include <string.h>
+
+#include <app/drivers/audio/es8311.h>
 
 #include "es8311_reg.h"
 #include "es8311.h"
@@ -23,6 +27,7 @@ LOG_MODULE_REGISTER(es8311, CONFIG_AUDIO_CODEC_LOG_LEVEL);
 
 /* Forward declarations */
 static void es8311_start_output(const struct device *dev);
+static void es8311_start_input(const struct device *dev);
 
 /* Device configuration structure */
 struct es8311_config {
@@ -30,6 +35,11 @@ struct es8311_config {
     const struct device *mclk_dev;
     clock_control_subsys_t mclk_subsys;
     uint32_t mclk_freq;  /* Fixed MCLK frequency from DT */
+    uint8_t mic_input;   /* enum es8311_input */
+    uint8_t mic_gain;    /* PGA gain in 3dB steps */
+    struct es8311_dynamics alc;
+    struct es8311_dynamics drc;
+    bool adc_hpf;
 };
 
 
@@ -41,6 +51,25 @@ static const uint32_t es8311_bclk_divs[] = {
     22, 24, 25, 30, 32, 33, 34, 36, 44, 48, 66, 72
 };
 
+/* Rates and word sizes of es8311_data.clk_images */
+static const uint32_t es8311_rates[] = {
+    8000, 11025, 16000, 22050, 32000, 44100, 48000, 64000, 88200, 96000
+};
+
+static const struct {
+    uint8_t word_size;
+    uint8_t wl;
+} es8311_word_sizes[] = {
+    {16, ES8311_SDP_WL_16},
+    {18, ES8311_SDP_WL_18},
+    {20, ES8311_SDP_WL_20},
+    {24, ES8311_SDP_WL_24},
+    {32, ES8311_SDP_WL_32},
+};
+
+BUILD_ASSERT(ARRAY_SIZE(es8311_rates) == ES8311_NUM_RATES);
+BUILD_ASSERT(ARRAY_SIZE(es8311_word_sizes) == ES8311_NUM_WORD_SIZES);
+
 /* MCLK coefficients table */
 static const struct es8311_mclk_coeff es8311_mclk_coeffs[] = {
     {8000, 2048000, 1, 1, 1},
@@ -68,16 +97,126 @@ static const struct es8311_mclk_coeff es8311_mclk_coeffs[] = {
     {96000, 18432000, 3, 4, 1},
 };
 
-/* I2C register access functions */
+#ifndef CONFIG_ES8311_DEFERRED_INIT
+/* Enter reset and hold it, es8311_init_seq leaves it */
+static const struct es8311_reg_seq es8311_reset_seq[] = {
+    ES8311_SEQ_DELAY(ES8311_RESET,
+                     ES8311_RESET_CSM_ON | ES8311_RESET_RST_MASK,
+                     ES8311_RESET_RST_MASK, ES8311_RESET_DELAY_MS),
+};
+#endif
+
+/* Leave reset and bring up the playback path */
+static const struct es8311_reg_seq es8311_init_seq[] = {
+    ES8311_SEQ_UPDATE(ES8311_RESET,
+                      ES8311_RESET_CSM_ON | ES8311_RESET_RST_MASK,
+                      ES8311_RESET_CSM_ON),
+    /* Minimal power-up time, VMID for normal operation and analog on */
+    ES8311_SEQ_WRITE(ES8311_SYS1, 0),
+    ES8311_SEQ_WRITE(ES8311_SYS2, 0),
+    ES8311_SEQ_WRITE(ES8311_SYS3, ES8311_SYS3_PDN_VMIDSEL_NORMAL_OPERATION),
+    /* Power up DAC, enable headphone switch for output */
+    ES8311_SEQ_UPDATE(ES8311_SYS8, BIT(ES8311_SYS8_PDN_DAC_SHIFT), 0),
+    ES8311_SEQ_UPDATE(ES8311_SYS9, BIT(ES8311_SYS9_HPSW_SHIFT),
+                      BIT(ES8311_SYS9_HPSW_SHIFT)),
+    /* Unmute DAC, then the default volume (240 = +24dB, 192 = 0dB) */
+    ES8311_SEQ_UPDATE(ES8311_DAC1,
+                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE, 0),
+    ES8311_SEQ_WRITE(ES8311_DAC2, 240),
+    /* DAC ramp rate for smooth transitions */
+    ES8311_SEQ_UPDATE(ES8311_DAC6, 0x0F << ES8311_DAC6_RAMPRATE_SHIFT,
+                      0x04 << ES8311_DAC6_RAMPRATE_SHIFT),
+    /* GPIO for DAC to output routing */
+    ES8311_SEQ_WRITE(ES8311_GPIO, 0x00),
+};
+
+/* DAC clocks on, DAC powered and unmuted */
+static const struct es8311_reg_seq es8311_start_output_seq[] = {
+    ES8311_SEQ_UPDATE(ES8311_CLKMGR1,
+                      BIT(ES8311_CLKMGR1_CLKDAC_ON_SHIFT) |
+                      BIT(ES8311_CLKMGR1_ANACLKDAC_ON_SHIFT),
+                      BIT(ES8311_CLKMGR1_CLKDAC_ON_SHIFT) |
+                      BIT(ES8311_CLKMGR1_ANACLKDAC_ON_SHIFT)),
+    ES8311_SEQ_UPDATE(ES8311_SYS8, BIT(ES8311_SYS8_PDN_DAC_SHIFT), 0),
+    ES8311_SEQ_UPDATE(ES8311_DAC1,
+                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE, 0),
+};
+
+/* ADC clocks on, PGA and modulator powered */
+static const struct es8311_reg_seq es8311_start_input_seq[] = {
+    ES8311_SEQ_UPDATE(ES8311_CLKMGR1,
+                      BIT(ES8311_CLKMGR1_CLKADC_ON_SHIFT) |
+                      BIT(ES8311_CLKMGR1_ANACLKADC_ON_SHIFT),
+                      BIT(ES8311_CLKMGR1_CLKADC_ON_SHIFT) |
+                      BIT(ES8311_CLKMGR1_ANACLKADC_ON_SHIFT)),
+    ES8311_SEQ_UPDATE(ES8311_SYS4,
+                      BIT(ES8311_SYS4_PDN_PGA_SHIFT) | BIT(ES8311_SYS4_PDN_MOD_SHIFT),
+                      0),
+};
+
+/* ADC output muted, then powered down and unclocked */
+static const struct es8311_reg_seq es8311_stop_input_seq[] = {
+    ES8311_SEQ_UPDATE(ES8311_SDP_OUT, BIT(ES8311_SDP_MUTE_SHIFT),
+                      BIT(ES8311_SDP_MUTE_SHIFT)),
+    ES8311_SEQ_UPDATE(ES8311_SYS4,
+                      BIT(ES8311_SYS4_PDN_PGA_SHIFT) | BIT(ES8311_SYS4_PDN_MOD_SHIFT),
+                      BIT(ES8311_SYS4_PDN_PGA_SHIFT) | BIT(ES8311_SYS4_PDN_MOD_SHIFT)),
+    ES8311_SEQ_UPDATE(ES8311_CLKMGR1,
+                      BIT(ES8311_CLKMGR1_CLKADC_ON_SHIFT) |
+                      BIT(ES8311_CLKMGR1_ANACLKADC_ON_SHIFT),
+                      0),
+};
+
+static const struct es8311_reg_seq es8311_stop_output_seq[] = {
+    ES8311_SEQ_UPDATE(ES8311_DAC1,
+                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE,
+                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE),
+};
+
+/*
+ * I2C register access functions
+ *
+ * Registers 0x00..ES8311_GPIO are shadowed in es8311_data::cache, so updates
+ * cost a single write or nothing. While the codec is unpowered writes only
+ * reach the cache and are marked dirty, es8311_cache_sync() replays them.
+ */
+static inline bool es8311_reg_cached(uint8_t reg) {
+    return reg < ES8311_CACHE_SIZE;
+}
+
 static int es8311_write_reg(const struct device *dev, uint8_t reg, uint8_t val) {
     const struct es8311_config *config = DEV_CFG(dev);
+    struct es8311_data *data = DEV_DATA(dev);
     uint8_t buf[2] = {reg, val};
+    int ret;
+
+    if (!es8311_reg_cached(reg)) {
+        return i2c_write_dt(&config->i2c, buf, sizeof(buf));
+    }
+
+    data->cache[reg] = val;
+    if (data->cache_only) {
+        atomic_set_bit(data->dirty, reg);
+        return 0;
+    }
 
-    return i2c_write_dt(&config->i2c, buf, sizeof(buf));
+    ret = i2c_write_dt(&config->i2c, buf, sizeof(buf));
+    if (ret < 0) {
+        /* Retried by the next sync */
+        atomic_set_bit(data->dirty, reg);
+    }
+
+    return ret;
 }
 
 static int es8311_read_reg(const struct device *dev, uint8_t reg, uint8_t *val) {
     const struct es8311_config *config = DEV_CFG(dev);
+    struct es8311_data *data = DEV_DATA(dev);
+
+    if (es8311_reg_cached(reg)) {
+        *val = data->cache[reg];
+        return 0;
+    }
 
     return i2c_write_read_dt(&config->i2c, &reg, 1, val, 1);
 }
@@ -100,18 +239,158 @@ static int es8311_update_reg(const struct device *dev, uint8_t reg,
     return ret;
 }
 
-/* Reset codec */
-static void es8311_reset(const struct device *dev, bool reset) {
-    uint8_t mask = (uint8_t) (ES8311_RESET_CSM_ON | ES8311_RESET_RST_MASK);
+/* Load the cache from the codec, the address auto-increments on reads */
+static int es8311_cache_init(const struct device *dev) {
+    const struct es8311_config *config = DEV_CFG(dev);
+    struct es8311_data *data = DEV_DATA(dev);
+
+    memset(data->dirty, 0, sizeof(data->dirty));
+    data->cache_only = false;
 
-    if (reset) {
-        /* Enter reset mode */
-        es8311_update_reg(dev, ES8311_RESET, mask, (uint8_t) ES8311_RESET_RST_MASK);
-    } else {
-        /* Leave reset mode */
-        k_sleep(K_MSEC(5));
-        es8311_update_reg(dev, ES8311_RESET, mask, ES8311_RESET_CSM_ON);
+    return i2c_burst_read_dt(&config->i2c, 0, data->cache, sizeof(data->cache));
+}
+
+/* Issue the pending bursts as one transfer, each after a repeated start */
+static int es8311_seq_flush(const struct device *dev, struct i2c_msg *msgs,
+                            uint8_t *num_msgs, size_t *used) {
+    const struct es8311_config *config = DEV_CFG(dev);
+    struct es8311_data *data = DEV_DATA(dev);
+    int ret;
+
+    if (*num_msgs == 0) {
+        return 0;
     }
+
+    msgs[*num_msgs - 1].flags |= I2C_MSG_STOP;
+    ret = i2c_transfer_dt(&config->i2c, msgs, *num_msgs);
+    if (ret < 0) {
+        /* Retried by the next sync */
+        for (uint8_t i = 0; i < *num_msgs; i++) {
+            for (uint32_t n = 1; n < msgs[i].len; n++) {
+                atomic_set_bit(data->dirty, msgs[i].buf[0] + n - 1);
+            }
+        }
+    }
+    *num_msgs = 0;
+    *used = 0;
+
+    return ret;
+}
+
+/*
+ * Apply a register sequence. Entries are folded into the cache first, then
+ * runs of entries on consecutive registers go out as one auto-increment burst
+ * and all bursts up to the next delay share a single i2c_transfer(). Entries
+ * that leave a register unchanged are dropped unless they are forced.
+ */
+static int es8311_write_seq(const struct device *dev,
+                            const struct es8311_reg_seq *seq, size_t len) {
+    struct es8311_data *data = DEV_DATA(dev);
+    struct i2c_msg msgs[ES8311_SEQ_MAX_MSGS];
+    uint8_t buf[ES8311_SEQ_MAX_BYTES];
+    uint8_t num_msgs = 0;
+    size_t used = 0;
+    int last_reg = -1;
+    int ret;
+
+    for (size_t i = 0; i < len; i++) {
+        const uint8_t reg = seq[i].reg;
+        const uint8_t val = (data->cache[reg] & ~seq[i].mask) |
+                            (seq[i].val & seq[i].mask);
+
+        __ASSERT_NO_MSG(es8311_reg_cached(reg));
+
+        if ((val != data->cache[reg]) || seq[i].force) {
+            data->cache[reg] = val;
+
+            if (data->cache_only) {
+                atomic_set_bit(data->dirty, reg);
+            } else if ((reg == last_reg + 1) && (used < sizeof(buf))) {
+                /* Extend the current burst */
+                buf[used++] = val;
+                msgs[num_msgs - 1].len++;
+                last_reg = reg;
+            } else {
+                if ((num_msgs == ARRAY_SIZE(msgs)) || (used + 2 > sizeof(buf))) {
+                    ret = es8311_seq_flush(dev, msgs, &num_msgs, &used);
+                    if (ret < 0) {
+                        return ret;
+                    }
+                }
+                msgs[num_msgs].buf = &buf[used];
+                msgs[num_msgs].len = 2;
+                msgs[num_msgs].flags = I2C_MSG_WRITE |
+                                       (num_msgs ? I2C_MSG_RESTART : 0);
+                num_msgs++;
+                buf[used++] = reg;
+                buf[used++] = val;
+                last_reg = reg;
+            }
+        }
+
+        if (seq[i].delay_ms) {
+            ret = es8311_seq_flush(dev, msgs, &num_msgs, &used);
+            if (ret < 0) {
+                return ret;
+            }
+            last_reg = -1;
+            k_msleep(seq[i].delay_ms);
+        }
+    }
+
+    return es8311_seq_flush(dev, msgs, &num_msgs, &used);
+}
+
+/*
+ * Write back the dirty registers through es8311_write_seq(), so runs of
+ * neighbours go out as bursts. The reset register goes last, so the codec
+ * only leaves reset once its clocks and formats are restored.
+ */
+static int es8311_cache_sync(const struct device *dev) {
+    struct es8311_data *data = DEV_DATA(dev);
+    struct es8311_reg_seq seq[ES8311_CACHE_SIZE];
+    size_t len = 0;
+    int ret;
+
+    data->cache_only = false;
+
+    /* 0x01 upwards, then 0x00 */
+    for (int i = 1; i <= ES8311_CACHE_SIZE; i++) {
+        const uint8_t reg = i % ES8311_CACHE_SIZE;
+
+        if (atomic_test_and_clear_bit(data->dirty, reg)) {
+            /* The cache already holds the value, force it out */
+            seq[len++] = (struct es8311_reg_seq){
+                .reg = reg, .mask = 0xFF, .val = data->cache[reg], .force = true,
+            };
+        }
+    }
+
+    ret = es8311_write_seq(dev, seq, len);
+    if (ret < 0) {
+        /* Bursts after the failed one were never sent, retry them all */
+        for (size_t i = 0; i < len; i++) {
+            atomic_set_bit(data->dirty, seq[i].reg);
+        }
+        LOG_ERR("Failed to sync the register cache");
+    }
+
+    return ret;
+}
+
+/* -EAGAIN while a deferred init is still running, its result afterwards */
+static int es8311_check_ready(const struct device *dev) {
+#ifdef CONFIG_ES8311_DEFERRED_INIT
+    struct es8311_data *data = DEV_DATA(dev);
+
+    if (!k_event_test(&data->init_done, BIT(0))) {
+        return -EAGAIN;
+    }
+    return data->init_res;
+#else
+    ARG_UNUSED(dev);
+    return 0;
+#endif
 }
 
 /* Compare and adjust MCLK coefficient */
@@ -172,87 +451,44 @@ static int es8311_get_mclk_coeff(uint32_t mclk_freq, uint32_t rate,
     return -EINVAL;
 }
 
-/* Configure audio format */
-static int es8311_configure_fmt(const struct device *dev,
-                                const struct audio_codec_cfg *cfg) {
-    struct es8311_data *data = DEV_DATA(dev);
-    uint8_t wl;
-    uint32_t rate = cfg->dai_cfg.i2s.frame_clk_freq;
-    uint32_t word_size = cfg->dai_cfg.i2s.word_size;
-    uint32_t mclk_freq = data->mclk_freq;
-    uint8_t clkmgr;
-    uint8_t mask;
+/*
+ * Compute the clock manager registers of one rate and frame length in BCLK
+ * cycles. CLKMGR6..8 only matter as provider, provider_ok tells whether they
+ * could be derived.
+ */
+static int es8311_clk_image_calc(uint32_t mclk_freq, uint32_t rate,
+                                 uint32_t frame_bits,
+                                 struct es8311_clk_image *img) {
+    struct es8311_mclk_coeff coeff;
+    uint8_t mult;
     int ret;
 
-    /* Configure word length */
-    switch (word_size) {
-        case 16:
-            wl = ES8311_SDP_WL_16;
-            break;
-        case 18:
-            wl = ES8311_SDP_WL_18;
-            break;
-        case 20:
-            wl = ES8311_SDP_WL_20;
-            break;
-        case 24:
-            wl = ES8311_SDP_WL_24;
-            break;
-        case 32:
-            wl = ES8311_SDP_WL_32;
-            break;
-        default:
-            LOG_ERR("Invalid word size: %d", word_size);
-            return -EINVAL;
-    }
+    memset(img, 0, sizeof(*img));
 
-    es8311_update_reg(dev, ES8311_SDP_IN, (uint8_t) ES8311_SDP_WL_MASK,
-                      wl << ES8311_SDP_WL_SHIFT);
-    es8311_update_reg(dev, ES8311_SDP_OUT, (uint8_t) ES8311_SDP_WL_MASK,
-                      wl << ES8311_SDP_WL_SHIFT);
-
-    /* Check MCLK frequency */
     if (mclk_freq > ES8311_MCLK_MAX_FREQ) {
-        LOG_ERR("MCLK frequency %u too high", mclk_freq);
         return -EINVAL;
     }
 
-    /* If MCLK not configured, use BCLK as internal MCLK (slave mode only) */
+    /* Without MCLK, BCLK is used as internal MCLK (consumer mode only) */
     if (!mclk_freq) {
-        if (data->is_provider) {
-            LOG_ERR("MCLK not configured, cannot run as provider");
-            return -EINVAL;
-        }
-        LOG_DBG("MCLK not configured, use BCLK as internal MCLK");
-        clkmgr = ES8311_CLKMGR1_MCLK_SEL;
-        mclk_freq = rate * word_size * 2;
+        img->clkmgr1 = ES8311_CLKMGR1_MCLK_SEL | ES8311_CLKMGR1_BCLK_ON;
+        mclk_freq = rate * frame_bits;
     } else {
-        clkmgr = ES8311_CLKMGR1_MCLK_ON;
+        img->clkmgr1 = ES8311_CLKMGR1_MCLK_ON | ES8311_CLKMGR1_BCLK_ON;
+        img->provider_ok = true;
     }
 
-    /* Get MCLK coefficient */
-    struct es8311_mclk_coeff coeff;
     ret = es8311_get_mclk_coeff(mclk_freq, rate, &coeff);
     if (ret) {
-        LOG_ERR("Unable to find MCLK coefficient for rate %u", rate);
         return ret;
     }
 
-    /* Configure clock manager */
-    mask = (uint8_t) (ES8311_CLKMGR1_MCLK_SEL | ES8311_CLKMGR1_MCLK_ON |
-                      ES8311_CLKMGR1_BCLK_ON);
-    clkmgr |= ES8311_CLKMGR1_BCLK_ON;
-    es8311_update_reg(dev, ES8311_CLKMGR1, mask, clkmgr);
-
     /* Validate divisors */
     if (coeff.div == 0 || coeff.div > 8 ||
         coeff.div_adc_dac == 0 || coeff.div_adc_dac > 8) {
-        LOG_ERR("Invalid coefficient divisors");
         return -EINVAL;
     }
 
-    /* Configure multiplier */
-    uint8_t mult;
     switch (coeff.mult) {
         case 1:
             mult = 0;
@@ -267,86 +503,120 @@ static int es8311_configure_fmt(const struct device *dev,
             mult = 3;
             break;
         default:
-            LOG_ERR("Invalid multiplier: %u", coeff.mult);
             return -EINVAL;
     }
 
-    /* Set pre-divider and multiplier */
-    mask = (uint8_t) (ES8311_CLKMGR2_DIV_PRE_MASK | ES8311_CLKMGR2_MULT_PRE_MASK);
-    clkmgr = ((coeff.div - 1) << ES8311_CLKMGR2_DIV_PRE_SHIFT) |
-             (mult << ES8311_CLKMGR2_MULT_PRE_SHIFT);
-    es8311_update_reg(dev, ES8311_CLKMGR2, mask, clkmgr);
+    img->clkmgr2 = ((coeff.div - 1) << ES8311_CLKMGR2_DIV_PRE_SHIFT) |
+                   (mult << ES8311_CLKMGR2_MULT_PRE_SHIFT);
+    img->clkmgr5 = ((coeff.div_adc_dac - 1) << ES8311_CLKMGR5_ADC_DIV_SHIFT) |
+                   ((coeff.div_adc_dac - 1) << ES8311_CLKMGR5_DAC_DIV_SHIFT);
+    img->valid = true;
 
-    /* Set ADC/DAC divider */
-    mask = (uint8_t) (ES8311_CLKMGR5_ADC_DIV_MASK | ES8311_CLKMGR5_DAC_DIV_MASK);
-    clkmgr = ((coeff.div_adc_dac - 1) << ES8311_CLKMGR5_ADC_DIV_SHIFT) |
-             ((coeff.div_adc_dac - 1) << ES8311_CLKMGR5_DAC_DIV_SHIFT);
-    es8311_update_reg(dev, ES8311_CLKMGR5, mask, clkmgr);
+    /* LRCLK and BCLK dividers, provider mode only */
+    uint32_t div_lrclk = mclk_freq / rate;
 
-    /* Configure LRCLK and BCLK dividers if provider mode */
-    if (data->is_provider) {
-        uint32_t div_lrclk = mclk_freq / rate;
+    if (div_lrclk == 0 || div_lrclk > ES8311_CLKMGR_LRCLK_DIV_MAX + 1 ||
+        div_lrclk % frame_bits != 0) {
+        img->provider_ok = false;
+        return 0;
+    }
 
-        if (div_lrclk == 0 || div_lrclk > ES8311_CLKMGR_LRCLK_DIV_MAX + 1) {
-            LOG_ERR("Invalid LRCLK divider: %u", div_lrclk);
-            return -EINVAL;
+    img->clkmgr7 = (uint8_t) ((div_lrclk - 1) >> 8);
+    img->clkmgr8 = (uint8_t) ((div_lrclk - 1) & 0xFF);
+
+    uint32_t div_bclk = div_lrclk / frame_bits;
+
+    if (div_bclk <= ES8311_BCLK_DIV_IDX_OFFSET) {
+        img->clkmgr6 = (uint8_t) (div_bclk - 1);
+    } else {
+        size_t i;
+        for (i = 0; i < ARRAY_SIZE(es8311_bclk_divs); i++) {
+            if (es8311_bclk_divs[i] == div_bclk) {
+                break;
+            }
+        }
+        if (i == ARRAY_SIZE(es8311_bclk_divs)) {
+            img->provider_ok = false;
+            return 0;
         }
+        img->clkmgr6 = (uint8_t) (i + ES8311_BCLK_DIV_IDX_OFFSET);
+    }
 
-        /* Set LRCLK divider */
-        mask = (uint8_t) ES8311_CLKMGR7_LRCLK_DIV_H_MASK;
-        clkmgr = (uint8_t) ((div_lrclk - 1) >> 8);
-        es8311_update_reg(dev, ES8311_CLKMGR7, mask, clkmgr);
-        es8311_write_reg(dev, ES8311_CLKMGR8, (uint8_t) ((div_lrclk - 1) & 0xFF));
+    return 0;
+}
 
-        /* Calculate BCLK divider */
-        if (div_lrclk % (2 * word_size) != 0) {
-            LOG_ERR("Unable to divide MCLK to generate BCLK");
-            return -EINVAL;
+/* Build the clock image table of two-slot frames once the MCLK is known */
+static void es8311_clk_images_init(const struct device *dev) {
+    struct es8311_data *data = DEV_DATA(dev);
+
+    for (size_t r = 0; r < ARRAY_SIZE(es8311_rates); r++) {
+        for (size_t w = 0; w < ARRAY_SIZE(es8311_word_sizes); w++) {
+            (void) es8311_clk_image_calc(data->mclk_freq, es8311_rates[r],
+                                         2 * es8311_word_sizes[w].word_size,
+                                         &data->clk_images[r][w]);
         }
+    }
+}
 
-        uint32_t div_bclk = div_lrclk / (2 * word_size);
+/* Look up the clock image and word length of a stream format */
+static const struct es8311_clk_image *es8311_clk_image_get(const struct device *dev,
+                                                           uint32_t rate,
+                                                           uint32_t word_size,
+                                                           uint8_t *wl) {
+    struct es8311_data *data = DEV_DATA(dev);
+    size_t r, w;
 
-        mask = (uint8_t) ES8311_CLKMGR6_DIV_BCLK_MASK;
-        if (div_bclk <= ES8311_BCLK_DIV_IDX_OFFSET) {
-            clkmgr = (uint8_t) (div_bclk - 1);
-        } else {
-            size_t i;
-            for (i = 0; i < ARRAY_SIZE(es8311_bclk_divs); i++) {
-                if (es8311_bclk_divs[i] == div_bclk) {
-                    break;
-                }
-            }
-            if (i == ARRAY_SIZE(es8311_bclk_divs)) {
-                LOG_ERR("BCLK divider %u not supported", div_bclk);
-                return -EINVAL;
-            }
-            clkmgr = (uint8_t) (i + ES8311_BCLK_DIV_IDX_OFFSET);
+    for (r = 0; r < ARRAY_SIZE(es8311_rates); r++) {
+        if (es8311_rates[r] == rate) {
+            break;
+        }
+    }
+    for (w = 0; w < ARRAY_SIZE(es8311_word_sizes); w++) {
+        if (es8311_word_sizes[w].word_size == word_size) {
+            break;
         }
-        es8311_update_reg(dev, ES8311_CLKMGR6, mask, clkmgr);
+    }
+    if ((r == ARRAY_SIZE(es8311_rates)) || (w == ARRAY_SIZE(es8311_word_sizes))) {
+        return NULL;
     }
 
-    return 0;
+    *wl = es8311_word_sizes[w].wl;
+    return &data->clk_images[r][w];
 }
 
-/* Configure DAI format */
+/*
+ * Configure DAI format and clocks. Everything lives in registers 0x00..0x0A,
+ * so the changed fields go out as one burst and an unchanged configuration
+ * costs no bus traffic.
+ *
+ * The codec is mono: the DAC plays the first slot and the ADC sends on it.
+ * I2S and left justified frames always carry two slots. DSP frames carry
+ * one slot per channel, so a mono DSP link runs BCLK at half the stereo rate.
+ */
 static int es8311_configure_dai(const struct device *dev,
                                 const struct audio_codec_cfg *cfg) {
     struct es8311_data *data = DEV_DATA(dev);
+    const uint32_t rate = cfg->dai_cfg.i2s.frame_clk_freq;
+    const uint32_t word_size = cfg->dai_cfg.i2s.word_size;
+    const uint8_t channels = cfg->dai_cfg.i2s.channels;
+    const struct es8311_clk_image *img;
+    struct es8311_clk_image slot_img;
+    uint8_t slots = 2;
+    struct es8311_reg_seq seq[9];
+    size_t len = 0;
     uint8_t sdp = 0;
     uint8_t mask;
+    uint8_t wl;
 
     /* Configure provider/consumer mode */
     switch (cfg->dai_cfg.i2s.options & I2S_OPT_FRAME_CLK_MASTER) {
         case I2S_OPT_FRAME_CLK_MASTER:
             /* Provider mode (Master) */
             data->is_provider = true;
-            es8311_update_reg(dev, ES8311_RESET, ES8311_RESET_MSC,
-                              ES8311_RESET_MSC);
             break;
         default:
             /* Consumer mode (Slave) */
             data->is_provider = false;
-            es8311_update_reg(dev, ES8311_RESET, ES8311_RESET_MSC, 0);
             break;
     }
 
@@ -366,18 +636,71 @@ static int es8311_configure_dai(const struct device *dev,
             __fallthrough;
         case AUDIO_DAI_TYPE_PCMA:
             sdp |= ES8311_SDP_FMT_DSP;
+            slots = channels;
             break;
         default:
             LOG_ERR("Unsupported DAI type");
             return -EINVAL;
     }
 
-    /* Apply DAI format configuration */
-    mask = (uint8_t) (ES8311_SDP_FMT_MASK | ES8311_SDP_LRP);
-    es8311_update_reg(dev, ES8311_SDP_IN, mask, sdp);
-    es8311_update_reg(dev, ES8311_SDP_OUT, mask, sdp);
+    if ((channels == 0) || (channels > slots) || (slots > ES8311_DSP_MAX_SLOTS)) {
+        LOG_ERR("Unsupported channel count %u", channels);
+        return -EINVAL;
+    }
+
+    img = es8311_clk_image_get(dev, rate, word_size, &wl);
+    if (img == NULL) {
+        LOG_ERR("Unsupported rate %u with word size %u", rate, word_size);
+        return -EINVAL;
+    }
+
+    /*
+     * The table holds two-slot frames. Other frame lengths only change
+     * the BCLK derived clocks, computed here for the less common case.
+     */
+    if ((slots != 2) && (data->is_provider || !data->mclk_freq)) {
+        (void) es8311_clk_image_calc(data->mclk_freq, rate, slots * word_size,
+                                     &slot_img);
+        img = &slot_img;
+    }
+
+    if (!img->valid) {
+        LOG_ERR("Unsupported rate %u with %u x %u bit slots and MCLK %u",
+                rate, slots, word_size, data->mclk_freq);
+        return -EINVAL;
+    }
+    if (data->is_provider && !img->provider_ok) {
+        LOG_ERR("Cannot provide rate %u with word size %u from MCLK %u",
+                rate, word_size, data->mclk_freq);
+        return -EINVAL;
+    }
+
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_RESET,
+        ES8311_RESET_MSC, data->is_provider ? ES8311_RESET_MSC : 0);
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_CLKMGR1,
+        ES8311_CLKMGR1_MCLK_SEL | ES8311_CLKMGR1_MCLK_ON | ES8311_CLKMGR1_BCLK_ON,
+        img->clkmgr1);
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_CLKMGR2,
+        ES8311_CLKMGR2_DIV_PRE_MASK | ES8311_CLKMGR2_MULT_PRE_MASK, img->clkmgr2);
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_CLKMGR5,
+        ES8311_CLKMGR5_ADC_DIV_MASK | ES8311_CLKMGR5_DAC_DIV_MASK, img->clkmgr5);
+    if (data->is_provider) {
+        seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_CLKMGR6,
+            ES8311_CLKMGR6_DIV_BCLK_MASK, img->clkmgr6);
+        seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_CLKMGR7,
+            ES8311_CLKMGR7_LRCLK_DIV_H_MASK, img->clkmgr7);
+        seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_WRITE(ES8311_CLKMGR8,
+            img->clkmgr8);
+    }
+
+    mask = (uint8_t) (ES8311_SDP_FMT_MASK | ES8311_SDP_LRP | ES8311_SDP_WL_MASK);
+    sdp |= wl << ES8311_SDP_WL_SHIFT;
+    /* The DAC plays the first slot, the left one in I2S */
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_SDP_IN,
+        mask | ES8311_SDP_IN_SEL, sdp);
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_SDP_OUT, mask, sdp);
 
-    return es8311_configure_fmt(dev, cfg);
+    return es8311_write_seq(dev, seq, len);
 }
 
 /* Configure codec */
@@ -390,18 +713,35 @@ static int es8311_configure(const struct device *dev,
         return -EINVAL;
     }
 
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
     ret = es8311_configure_dai(dev, cfg);
     if (ret < 0) {
         LOG_ERR("Failed to configure DAI");
         return ret;
     }
 
-    /* Start output if configured for playback */
-    if (cfg->dai_route == AUDIO_ROUTE_PLAYBACK) {
-        es8311_start_output(dev);
-        LOG_INF("Codec configured for playback and started");
-    } else {
-        LOG_DBG("Codec configured successfully");
+    /* Start the paths of the route, both share the I2S clocks */
+    switch (cfg->dai_route) {
+        case AUDIO_ROUTE_PLAYBACK:
+            es8311_start_output(dev);
+            LOG_INF("Codec configured for playback and started");
+            break;
+        case AUDIO_ROUTE_CAPTURE:
+            es8311_start_input(dev);
+            LOG_INF("Codec configured for capture and started");
+            break;
+        case AUDIO_ROUTE_PLAYBACK_CAPTURE:
+            es8311_start_output(dev);
+            es8311_start_input(dev);
+            LOG_INF("Codec configured for full duplex and started");
+            break;
+        default:
+            LOG_DBG("Codec configured successfully");
+            break;
     }
 
     return 0;
@@ -409,29 +749,238 @@ static int es8311_configure(const struct device *dev,
 
 /* Start codec operation */
 static void es8311_start_output(const struct device *dev) {
-    /* Enable DAC digital and analog clocks */
-    uint8_t mask = BIT(ES8311_CLKMGR1_CLKDAC_ON_SHIFT) |
-                   BIT(ES8311_CLKMGR1_ANACLKDAC_ON_SHIFT);
-    es8311_update_reg(dev, ES8311_CLKMGR1, mask, mask);
-
-    /* Power up DAC if not already */
-    es8311_update_reg(dev, ES8311_SYS8, BIT(ES8311_SYS8_PDN_DAC_SHIFT), 0);
+    if (es8311_check_ready(dev) < 0) {
+        LOG_WRN("Codec not initialized, output not started");
+        return;
+    }
 
-    /* Unmute DAC */
-    es8311_update_reg(dev, ES8311_DAC1,
-                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE, 0);
+    if (es8311_write_seq(dev, es8311_start_output_seq,
+                         ARRAY_SIZE(es8311_start_output_seq)) < 0) {
+        LOG_ERR("Failed to start output");
+        return;
+    }
 
     LOG_INF("Output started - DAC enabled and unmuted");
 }
 
 /* Stop codec operation */
 static void es8311_stop_output(const struct device *dev) {
-    /* Mute DAC */
-    uint8_t mask = ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE;
-    es8311_update_reg(dev, ES8311_DAC1, mask, mask);
+    if (es8311_check_ready(dev) < 0) {
+        LOG_WRN("Codec not initialized, output not stopped");
+        return;
+    }
+
+    if (es8311_write_seq(dev, es8311_stop_output_seq,
+                         ARRAY_SIZE(es8311_stop_output_seq)) < 0) {
+        LOG_ERR("Failed to stop output");
+        return;
+    }
+
     LOG_DBG("Output stopped");
 }
 
+/* Start capture, the ADC output follows AUDIO_PROPERTY_INPUT_MUTE */
+static void es8311_start_input(const struct device *dev) {
+    struct es8311_data *data = DEV_DATA(dev);
+
+    if (es8311_check_ready(dev) < 0) {
+        LOG_WRN("Codec not initialized, input not started");
+        return;
+    }
+
+    if ((es8311_write_seq(dev, es8311_start_input_seq,
+                          ARRAY_SIZE(es8311_start_input_seq)) < 0) ||
+        (es8311_update_reg(dev, ES8311_SDP_OUT, BIT(ES8311_SDP_MUTE_SHIFT),
+                           data->input_muted ? BIT(ES8311_SDP_MUTE_SHIFT) : 0) < 0)) {
+        LOG_ERR("Failed to start input");
+        return;
+    }
+
+    LOG_INF("Input started - ADC enabled");
+}
+
+/* Stop capture */
+static void es8311_stop_input(const struct device *dev) {
+    if (es8311_check_ready(dev) < 0) {
+        LOG_WRN("Codec not initialized, input not stopped");
+        return;
+    }
+
+    if (es8311_write_seq(dev, es8311_stop_input_seq,
+                         ARRAY_SIZE(es8311_stop_input_seq)) < 0) {
+        LOG_ERR("Failed to stop input");
+        return;
+    }
+
+    LOG_DBG("Input stopped");
+}
+
+/* Select the analog or the digital microphone */
+static int es8311_route_input(const struct device *dev, audio_channel_t channel,
+                              uint32_t input) {
+    uint8_t sys10;
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Mono ADC */
+    if ((channel != AUDIO_CHANNEL_ALL) && (channel != AUDIO_CHANNEL_FRONT_LEFT)) {
+        return -EINVAL;
+    }
+
+    switch (input) {
+        case ES8311_INPUT_MIC1:
+            sys10 = 1 << ES8311_SYS10_LINESEL_SHIFT;
+            break;
+        case ES8311_INPUT_DMIC:
+            sys10 = BIT(ES8311_SYS10_DMIC_ON_SHIFT);
+            break;
+        default:
+            LOG_ERR("Unsupported input: %u", input);
+            return -EINVAL;
+    }
+
+    return es8311_update_reg(dev, ES8311_SYS10,
+                             BIT(ES8311_SYS10_DMIC_ON_SHIFT) |
+                             (0x03 << ES8311_SYS10_LINESEL_SHIFT),
+                             sys10);
+}
+
+int es8311_set_mic_gain(const struct device *dev, uint8_t gain_db) {
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if ((gain_db % 3) || (gain_db / 3 > ES8311_SYS10_PGAGAIN_MAX)) {
+        LOG_ERR("Unsupported PGA gain: %u dB", gain_db);
+        return -EINVAL;
+    }
+
+    return es8311_update_reg(dev, ES8311_SYS10, 0x0F << ES8311_SYS10_PGAGAIN_SHIFT,
+                             (gain_db / 3) << ES8311_SYS10_PGAGAIN_SHIFT);
+}
+
+static int es8311_check_dynamics(const struct es8311_dynamics *cfg) {
+    if ((cfg->window > ES8311_DYN_WINSIZE_MASK) ||
+        (cfg->max_level > ES8311_ADC5_ALC_MAXLEVEL_MAX) ||
+        (cfg->min_level > ES8311_ADC5_ALC_MINLEVEL_MAX) ||
+        (cfg->min_level > cfg->max_level)) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/* Enable/window and level registers are adjacent, one burst for both */
+static void es8311_dynamics_seq(struct es8311_reg_seq *seq, uint8_t reg,
+                                const struct es8311_dynamics *cfg) {
+    seq[0] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(reg,
+        ES8311_DYN_EN | ES8311_DYN_WINSIZE_MASK,
+        (cfg->enable ? ES8311_DYN_EN : 0) |
+        FIELD_PREP(ES8311_DYN_WINSIZE_MASK, cfg->window));
+    seq[1] = (struct es8311_reg_seq)ES8311_SEQ_WRITE(reg + 1,
+        FIELD_PREP(ES8311_DYN_MAXLEVEL_MASK, cfg->max_level) |
+        FIELD_PREP(ES8311_DYN_MINLEVEL_MASK, cfg->min_level));
+}
+
+int es8311_set_alc(const struct device *dev, const struct es8311_dynamics *cfg) {
+    struct es8311_reg_seq seq[2];
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (es8311_check_dynamics(cfg) < 0) {
+        LOG_ERR("Invalid ALC settings");
+        return -EINVAL;
+    }
+
+    es8311_dynamics_seq(seq, ES8311_ADC4, cfg);
+    return es8311_write_seq(dev, seq, ARRAY_SIZE(seq));
+}
+
+int es8311_set_drc(const struct device *dev, const struct es8311_dynamics *cfg) {
+    struct es8311_reg_seq seq[2];
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (es8311_check_dynamics(cfg) < 0) {
+        LOG_ERR("Invalid DRC settings");
+        return -EINVAL;
+    }
+
+    es8311_dynamics_seq(seq, ES8311_DAC4, cfg);
+    return es8311_write_seq(dev, seq, ARRAY_SIZE(seq));
+}
+
+int es8311_set_adc_hpf(const struct device *dev, bool enable) {
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return es8311_update_reg(dev, ES8311_ADC8, BIT(ES8311_ADC8_HPF_SHIFT),
+                             enable ? BIT(ES8311_ADC8_HPF_SHIFT) : 0);
+}
+
+/*
+ * Coefficients go out in one burst while the equalizer is bypassed, it is
+ * switched in afterwards.
+ */
+int es8311_set_eq(const struct device *dev, enum es8311_eq_path path,
+                  const uint8_t *coeffs) {
+    struct es8311_reg_seq seq[ES8311_ADCEQ_SIZE + 2];
+    uint8_t reg, size, bypass_reg, bypass;
+    size_t len = 0;
+    int ret;
+
+    ret = es8311_check_ready(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    switch (path) {
+        case ES8311_EQ_ADC:
+            reg = ES8311_ADCEQ1;
+            size = ES8311_ADCEQ_SIZE;
+            bypass_reg = ES8311_ADC8;
+            bypass = BIT(ES8311_ADC8_EQBYPASS_SHIFT);
+            break;
+        case ES8311_EQ_DAC:
+            reg = ES8311_DACEQ1;
+            size = ES8311_DACEQ_SIZE;
+            bypass_reg = ES8311_DAC6;
+            bypass = BIT(ES8311_DAC6_EQBYPASS_SHIFT);
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(bypass_reg, bypass, bypass);
+    if (coeffs != NULL) {
+        for (uint8_t i = 0; i < size; i++) {
+            seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_WRITE(reg + i, coeffs[i]);
+        }
+        seq[len++] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(bypass_reg, bypass, 0);
+    }
+
+    return es8311_write_seq(dev, seq, len);
+}
+
 /* Mute/unmute output */
 static int es8311_mute_output(const struct device *dev, bool mute) {
     uint8_t mask = ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE;
@@ -447,7 +996,11 @@ static int es8311_set_property(const struct device *dev,
                                audio_property_t property,
                                audio_channel_t channel,
                                audio_property_value_t val) {
-    int ret = 0;
+    int ret = es8311_check_ready(dev);
+
+    if (ret < 0) {
+        return ret;
+    }
 
     switch (property) {
         case AUDIO_PROPERTY_OUTPUT_VOLUME:
@@ -467,7 +1020,8 @@ static int es8311_set_property(const struct device *dev,
             break;
 
         case AUDIO_PROPERTY_INPUT_MUTE:
-            /* Mute ADC */
+            /* Mute ADC, kept while capture is stopped and restarted */
+            DEV_DATA(dev)->input_muted = val.mute;
             ret = es8311_update_reg(dev, ES8311_SDP_OUT,
                                     BIT(ES8311_SDP_MUTE_SHIFT),
                                     val.mute ? BIT(ES8311_SDP_MUTE_SHIFT) : 0);
@@ -494,22 +1048,43 @@ static const struct audio_codec_api es8311_api = {
     .configure = es8311_configure,
     .start_output = es8311_start_output,
     .stop_output = es8311_stop_output,
+    .start_input = es8311_start_input,
+    .stop_input = es8311_stop_input,
     .set_property = es8311_set_property,
     .apply_properties = es8311_apply_properties,
+    .route_input = es8311_route_input,
 };
 
-/* Initialize codec */
-static int es8311_initialize(const struct device *dev) {
-    const struct es8311_config *config = DEV_CFG(dev);
+#ifdef CONFIG_PM_DEVICE
+static int es8311_pm_action(const struct device *dev,
+                            enum pm_device_action action) {
     struct es8311_data *data = DEV_DATA(dev);
-    uint8_t chip_id1, chip_id2;
-    int ret;
 
-    /* Check I2C bus ready */
-    if (!device_is_ready(config->i2c.bus)) {
-        LOG_ERR("I2C bus not ready");
-        return -ENODEV;
+    switch (action) {
+        case PM_DEVICE_ACTION_SUSPEND:
+            return 0;
+        case PM_DEVICE_ACTION_RESUME:
+            /* Replay what was written while the codec had no power */
+            return es8311_cache_sync(dev);
+        case PM_DEVICE_ACTION_TURN_OFF:
+            /* Registers are lost, every cached value has to be written again */
+            data->cache_only = true;
+            for (int reg = 0; reg < ES8311_CACHE_SIZE; reg++) {
+                atomic_set_bit(data->dirty, reg);
+            }
+            return 0;
+        case PM_DEVICE_ACTION_TURN_ON:
+            return 0;
+        default:
+            return -ENOTSUP;
     }
+}
+#endif
+
+/* Identify the codec and read back its registers */
+static int es8311_probe(const struct device *dev) {
+    uint8_t chip_id1, chip_id2;
+    int ret;
 
     /* Read chip ID */
     ret = es8311_read_reg(dev, ES8311_CHIPID1, &chip_id1);
@@ -531,37 +1106,56 @@ static int es8311_initialize(const struct device *dev) {
 
     LOG_INF("ES8311 codec detected (ID: 0x%02x%02x)", chip_id1, chip_id2);
 
-    /* Reset codec */
-    es8311_reset(dev, true);
-    es8311_reset(dev, false);
-
-    /* Set minimal power-up time */
-    es8311_write_reg(dev, ES8311_SYS1, 0);
-    es8311_write_reg(dev, ES8311_SYS2, 0);
-
-    /* Configure VMID for normal operation and power up analog */
-    es8311_write_reg(dev, ES8311_SYS3, ES8311_SYS3_PDN_VMIDSEL_NORMAL_OPERATION);
+    /* The codec keeps its registers across a host reset, start from them */
+    ret = es8311_cache_init(dev);
+    if (ret < 0) {
+        LOG_ERR("Failed to read register cache");
+    }
 
-    /* Power up DAC - Clear power down bit */
-    es8311_update_reg(dev, ES8311_SYS8, BIT(ES8311_SYS8_PDN_DAC_SHIFT), 0);
+    return ret;
+}
 
-    /* Enable headphone switch for output */
-    es8311_update_reg(dev, ES8311_SYS9, BIT(ES8311_SYS9_HPSW_SHIFT),
-                      BIT(ES8311_SYS9_HPSW_SHIFT));
+/* Leave reset and apply the default configuration */
+static int es8311_setup(const struct device *dev) {
+    const struct es8311_config *config = DEV_CFG(dev);
+    struct es8311_data *data = DEV_DATA(dev);
+    struct es8311_reg_seq dyn_seq[5];
+    int ret;
 
-    /* Configure GPIO for DAC to output routing */
-    es8311_write_reg(dev, ES8311_GPIO, 0x00);
+    /* Leave reset and apply the defaults in one transfer */
+    ret = es8311_write_seq(dev, es8311_init_seq, ARRAY_SIZE(es8311_init_seq));
+    if (ret < 0) {
+        LOG_ERR("Failed to write init sequence");
+        return ret;
+    }
 
-    /* Set default DAC volume (240 = +24dB, range 0-255 where 192=0dB) */
-    es8311_write_reg(dev, ES8311_DAC2, 240);
+    /* Microphone input and PGA gain from DT, the ADC stays powered down */
+    ret = es8311_write_reg(dev, ES8311_SYS10,
+                           (config->mic_input == ES8311_INPUT_DMIC ?
+                            BIT(ES8311_SYS10_DMIC_ON_SHIFT) :
+                            1 << ES8311_SYS10_LINESEL_SHIFT) |
+                           (config->mic_gain << ES8311_SYS10_PGAGAIN_SHIFT));
+    if (ret < 0) {
+        LOG_ERR("Failed to configure microphone");
+        return ret;
+    }
 
-    /* Enable DAC ramp rate for smooth transitions */
-    es8311_update_reg(dev, ES8311_DAC6, (uint8_t)(0x0F << ES8311_DAC6_RAMPRATE_SHIFT),
-                      (0x04 << ES8311_DAC6_RAMPRATE_SHIFT));
+    /* Hardware ALC, DRC and high-pass filter defaults from DT */
+    if ((es8311_check_dynamics(&config->alc) < 0) ||
+        (es8311_check_dynamics(&config->drc) < 0)) {
+        LOG_ERR("Invalid ALC or DRC settings in devicetree");
+        return -EINVAL;
+    }
 
-    /* Unmute DAC by default */
-    es8311_update_reg(dev, ES8311_DAC1,
-                      ES8311_DAC1_DAC_DSMMUTE | ES8311_DAC1_DAC_DEMMUTE, 0);
+    es8311_dynamics_seq(&dyn_seq[0], ES8311_ADC4, &config->alc);
+    dyn_seq[2] = (struct es8311_reg_seq)ES8311_SEQ_UPDATE(ES8311_ADC8,
+        BIT(ES8311_ADC8_HPF_SHIFT), config->adc_hpf ? BIT(ES8311_ADC8_HPF_SHIFT) : 0);
+    es8311_dynamics_seq(&dyn_seq[3], ES8311_DAC4, &config->drc);
+    ret = es8311_write_seq(dev, dyn_seq, ARRAY_SIZE(dyn_seq));
+    if (ret < 0) {
+        LOG_ERR("Failed to configure dynamics processing");
+        return ret;
+    }
 
     /* Get MCLK frequency from clock controller if available */
     if (config->mclk_dev != NULL) {
@@ -582,10 +1176,110 @@ static int es8311_initialize(const struct device *dev) {
         LOG_INF("No MCLK configured, will use BCLK in consumer mode");
     }
 
+    es8311_clk_images_init(dev);
+
     LOG_INF("ES8311 codec initialized successfully");
     return 0;
 }
 
+#ifdef CONFIG_ES8311_DEFERRED_INIT
+/* Enter reset, es8311_init_seq leaves it after ES8311_RESET_DELAY_MS */
+static int es8311_reset(const struct device *dev) {
+    return es8311_update_reg(dev, ES8311_RESET,
+                             ES8311_RESET_CSM_ON | ES8311_RESET_RST_MASK,
+                             ES8311_RESET_RST_MASK);
+}
+
+/*
+ * The codec has no reset-done flag, so the reset hold time is a delay of the
+ * work item rather than a sleep of the init thread.
+ */
+static void es8311_init_work(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct es8311_data *data = CONTAINER_OF(dwork, struct es8311_data, init_work);
+
+    if (!data->in_reset) {
+        data->init_res = es8311_probe(data->dev);
+        if (data->init_res == 0) {
+            data->init_res = es8311_reset(data->dev);
+        }
+        if (data->init_res == 0) {
+            data->in_reset = true;
+            k_work_reschedule(dwork, K_MSEC(ES8311_RESET_DELAY_MS));
+            return;
+        }
+    } else {
+        data->init_res = es8311_setup(data->dev);
+    }
+
+    if (data->init_res < 0) {
+        LOG_ERR("Deferred init failed: %d", data->init_res);
+    }
+    k_event_post(&data->init_done, BIT(0));
+}
+#endif
+
+int es8311_init_wait(const struct device *dev, k_timeout_t timeout) {
+#ifdef CONFIG_ES8311_DEFERRED_INIT
+    struct es8311_data *data = DEV_DATA(dev);
+
+    if (k_event_wait(&data->init_done, BIT(0), false, timeout) == 0) {
+        return -EAGAIN;
+    }
+    return data->init_res;
+#else
+    ARG_UNUSED(dev);
+    ARG_UNUSED(timeout);
+    return 0;
+#endif
+}
+
+/* Initialize codec */
+static int es8311_initialize(const struct device *dev) {
+    const struct es8311_config *config = DEV_CFG(dev);
+
+    /* Check I2C bus ready */
+    if (!device_is_ready(config->i2c.bus)) {
+        LOG_ERR("I2C bus not ready");
+        return -ENODEV;
+    }
+
+#ifdef CONFIG_ES8311_DEFERRED_INIT
+    struct es8311_data *data = DEV_DATA(dev);
+
+    /* Brought up from the system workqueue, API calls return -EAGAIN until then */
+    data->dev = dev;
+    k_event_init(&data->init_done);
+    k_work_init_delayable(&data->init_work, es8311_init_work);
+    k_work_schedule(&data->init_work, K_NO_WAIT);
+    return 0;
+#else
+    int ret;
+
+    ret = es8311_probe(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = es8311_write_seq(dev, es8311_reset_seq, ARRAY_SIZE(es8311_reset_seq));
+    if (ret < 0) {
+        LOG_ERR("Failed to reset codec");
+        return ret;
+    }
+
+    return es8311_setup(dev);
+#endif
+}
+
+/* ALC or DRC settings from the <name>-* properties */
+#define ES8311_DT_DYNAMICS(inst, name)						\
+	{									\
+		.enable = DT_INST_PROP(inst, name##_enable),			\
+		.window = DT_INST_PROP(inst, name##_window),			\
+		.max_level = DT_INST_PROP(inst, name##_max_level),		\
+		.min_level = DT_INST_PROP(inst, name##_min_level),		\
+	}
+
 /* Device instantiation macro */
 #define ES8311_DEVICE_INIT(inst)						\
 										\
@@ -603,11 +1297,19 @@ static int es8311_initialize(const struct device *dev) {
 			((clock_control_subsys_t)DT_INST_CLOCKS_CELL_BY_NAME(inst, mclk, name)), \
 			(NULL)),						\
 		.mclk_freq = DT_INST_PROP_OR(inst, mclk_frequency, 0),		\
+		.mic_input = DT_INST_PROP(inst, digital_mic) ?			\
+			ES8311_INPUT_DMIC : ES8311_INPUT_MIC1,			\
+		.mic_gain = DT_INST_PROP(inst, mic_gain_db) / 3,		\
+		.alc = ES8311_DT_DYNAMICS(inst, alc),				\
+		.drc = ES8311_DT_DYNAMICS(inst, drc),				\
+		.adc_hpf = DT_INST_PROP(inst, adc_hpf),				\
 	};									\
 										\
+	PM_DEVICE_DT_INST_DEFINE(inst, es8311_pm_action);			\
+										\
 	DEVICE_DT_INST_DEFINE(inst,						\
 			      es8311_initialize,				\
-			      NULL,						\
+			      PM_DEVICE_DT_INST_GET(inst),			\
 			      &es8311_data_##inst,				\
 			      &es8311_config_##inst,				\
 			      POST_KERNEL,					\
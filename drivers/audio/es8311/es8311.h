@@ -9,6 +9,10 @@
 #define _ES8311_H
 
 #include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "es8311_reg.h"
 
 /* MCLK coefficient structure */
 struct es8311_mclk_coeff {
@@ -23,10 +27,78 @@ struct es8311_mclk_coeff {
 #define ES8311_BCLK_DIV_IDX_OFFSET 20
 #define ES8311_MCLK_MAX_FREQ 49200000
 
+/* Rates and word sizes with a precomputed clock image */
+#define ES8311_NUM_RATES 10
+#define ES8311_NUM_WORD_SIZES 5
+
+/* Slots of a DSP frame, the codec uses the first one */
+#define ES8311_DSP_MAX_SLOTS 8
+
+/*
+ * Clock manager registers of one rate and word size for the current MCLK.
+ * The table covers two-slot frames, I2S, left justified and stereo DSP.
+ * CLKMGR6..8 only apply as provider.
+ */
+struct es8311_clk_image {
+	uint8_t clkmgr1;
+	uint8_t clkmgr2;
+	uint8_t clkmgr5;
+	uint8_t clkmgr6;
+	uint8_t clkmgr7;
+	uint8_t clkmgr8;
+	bool valid;
+	bool provider_ok;
+};
+
+/* Time the codec is held in reset during init */
+#define ES8311_RESET_DELAY_MS 5
+
+/*
+ * One step of a register sequence, see es8311_write_seq(). The masked bits
+ * are only written when they change the cached value, force writes them
+ * regardless. The delay is waited after the write.
+ */
+struct es8311_reg_seq {
+	uint8_t reg;
+	uint8_t mask;
+	uint8_t val;
+	uint8_t delay_ms;
+	bool force;
+};
+
+#define ES8311_SEQ_WRITE(_reg, _val) \
+	{ .reg = (_reg), .mask = 0xFF, .val = (uint8_t)(_val) }
+#define ES8311_SEQ_UPDATE(_reg, _mask, _val) \
+	{ .reg = (_reg), .mask = (uint8_t)(_mask), .val = (uint8_t)(_val) }
+#define ES8311_SEQ_DELAY(_reg, _mask, _val, _ms) \
+	{ .reg = (_reg), .mask = (uint8_t)(_mask), .val = (uint8_t)(_val), \
+	  .delay_ms = (_ms) }
+
+/* Scratch space of one sequence transfer */
+#define ES8311_SEQ_MAX_MSGS 8
+#define ES8311_SEQ_MAX_BYTES 32
+
+/* Registers shadowed by the driver, 0x00 up to and including GPIO */
+#define ES8311_CACHE_SIZE (ES8311_GPIO + 1)
+
 /* Driver data structure */
 struct es8311_data {
 	uint32_t mclk_freq;
 	bool is_provider;
+	bool input_muted;
+	/* Indexed by es8311_rates and es8311_word_sizes, built during setup */
+	struct es8311_clk_image clk_images[ES8311_NUM_RATES][ES8311_NUM_WORD_SIZES];
+	/* Register shadow, dirty entries have not reached the codec yet */
+	uint8_t cache[ES8311_CACHE_SIZE];
+	ATOMIC_DEFINE(dirty, ES8311_CACHE_SIZE);
+	bool cache_only;
+#ifdef CONFIG_ES8311_DEFERRED_INIT
+	const struct device *dev;
+	struct k_work_delayable init_work;
+	struct k_event init_done;
+	int init_res;
+	bool in_reset;
+#endif
 };
 
 #endif /* _ES8311_H */
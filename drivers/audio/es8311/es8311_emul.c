@@ -0,0 +1,208 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * es8311_emul.c -- Register-level I2C emulator of the ES8311 codec
+ *
+ * Copyright (C) 2024
+ */
+
+#define DT_DRV_COMPAT everest_es8311
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include <app/drivers/audio/es8311_emul.h>
+
+#include "es8311_reg.h"
+
+LOG_MODULE_REGISTER(es8311_emul, CONFIG_AUDIO_CODEC_LOG_LEVEL);
+
+#define ES8311_EMUL_NUM_REGS (ES8311_REG_MAX + 1)
+
+struct es8311_emul_data {
+    uint8_t regs[ES8311_EMUL_NUM_REGS];
+    struct es8311_emul_stats stats;
+    /* Uptime the codec entered reset, and how long it was last held there */
+    int64_t reset_start;
+    uint32_t reset_hold_ms;
+};
+
+/* Power-on values of the datasheet, registers not listed read as 0 */
+static const struct {
+    uint8_t reg;
+    uint8_t val;
+} es8311_emul_defaults[] = {
+    {ES8311_RESET, 0x1F},
+    {ES8311_CLKMGR3, 0x10},
+    {ES8311_CLKMGR4, 0x10},
+    {ES8311_CLKMGR6, 0x03},
+    {ES8311_CLKMGR8, 0xFF},
+    {ES8311_SYS2, 0x20},
+    {ES8311_SYS3, 0xFC},
+    {ES8311_SYS4, 0x6A},
+    {ES8311_SYS6, 0x13},
+    {ES8311_SYS7, 0x7C},
+    {ES8311_SYS8, 0x02},
+    {ES8311_SYS9, 0x40},
+    {ES8311_SYS10, 0x10},
+    {ES8311_ADC2, 0x04},
+    {ES8311_ADC7, 0x0C},
+    {ES8311_ADC8, 0x4C},
+    {ES8311_DAC6, 0x08},
+    {ES8311_CHIPID1, 0x83},
+    {ES8311_CHIPID2, 0x11},
+};
+
+/* The state machine is off or a reset bit is set */
+static bool es8311_emul_reset_held(uint8_t val) {
+    return !(val & ES8311_RESET_CSM_ON) || (val & ES8311_RESET_RST_MASK);
+}
+
+void es8311_emul_power_on(const struct emul *target) {
+    struct es8311_emul_data *data = target->data;
+
+    memset(data->regs, 0, sizeof(data->regs));
+    for (size_t i = 0; i < ARRAY_SIZE(es8311_emul_defaults); i++) {
+        data->regs[es8311_emul_defaults[i].reg] = es8311_emul_defaults[i].val;
+    }
+    data->reset_start = k_uptime_get();
+}
+
+static void es8311_emul_write(struct es8311_emul_data *data, uint8_t reg,
+                              uint8_t val) {
+    switch (reg) {
+        case ES8311_CHIPID1:
+        case ES8311_CHIPID2:
+        case ES8311_CHIPVER:
+            LOG_WRN("write to read-only register 0x%02X", reg);
+            break;
+        case ES8311_RESET:
+            if (!es8311_emul_reset_held(data->regs[reg]) &&
+                es8311_emul_reset_held(val)) {
+                data->reset_start = k_uptime_get();
+            } else if (es8311_emul_reset_held(data->regs[reg]) &&
+                       !es8311_emul_reset_held(val)) {
+                data->reset_hold_ms = (uint32_t)(k_uptime_get() - data->reset_start);
+            }
+            data->regs[reg] = val;
+            break;
+        default:
+            /*
+             * The reset bits only hold the digital blocks, the register
+             * file keeps its contents.
+             */
+            data->regs[reg] = val;
+            break;
+    }
+}
+
+/*
+ * Every write message that opens the transfer or follows a repeated start
+ * carries a register address, the address auto-increments from there.
+ */
+static int es8311_emul_transfer_i2c(const struct emul *target,
+                                    struct i2c_msg *msgs, int num_msgs,
+                                    int addr) {
+    struct es8311_emul_data *data = target->data;
+    unsigned int reg = 0;
+    bool have_reg = false;
+
+    i2c_dump_msgs_rw(target->dev, msgs, num_msgs, addr, false);
+
+    data->stats.transfers++;
+
+    for (int i = 0; i < num_msgs; i++) {
+        uint32_t j = 0;
+
+        data->stats.bytes += msgs[i].len;
+
+        if (!(msgs[i].flags & I2C_MSG_READ) &&
+            (!have_reg || (msgs[i].flags & I2C_MSG_RESTART))) {
+            if (msgs[i].len < 1) {
+                LOG_ERR("write without a register address");
+                return -EIO;
+            }
+            reg = msgs[i].buf[0];
+            have_reg = true;
+            j = 1;
+        } else if (!have_reg) {
+            LOG_ERR("transfer must start with a register address");
+            return -EIO;
+        }
+
+        for (; j < msgs[i].len; j++) {
+            if (reg >= ES8311_EMUL_NUM_REGS) {
+                LOG_ERR("register 0x%02X out of range", reg);
+                return -EIO;
+            }
+            if (msgs[i].flags & I2C_MSG_READ) {
+                msgs[i].buf[j] = data->regs[reg];
+            } else {
+                es8311_emul_write(data, reg, msgs[i].buf[j]);
+            }
+            reg++;
+        }
+    }
+
+    return 0;
+}
+
+void es8311_emul_set_reg(const struct emul *target, uint8_t reg, uint8_t val) {
+    struct es8311_emul_data *data = target->data;
+
+    data->regs[reg] = val;
+}
+
+uint8_t es8311_emul_get_reg(const struct emul *target, uint8_t reg) {
+    const struct es8311_emul_data *data = target->data;
+
+    return data->regs[reg];
+}
+
+bool es8311_emul_in_reset(const struct emul *target) {
+    const struct es8311_emul_data *data = target->data;
+
+    return es8311_emul_reset_held(data->regs[ES8311_RESET]);
+}
+
+uint32_t es8311_emul_get_reset_hold(const struct emul *target) {
+    const struct es8311_emul_data *data = target->data;
+
+    return data->reset_hold_ms;
+}
+
+void es8311_emul_get_stats(const struct emul *target,
+                           struct es8311_emul_stats *stats) {
+    const struct es8311_emul_data *data = target->data;
+
+    *stats = data->stats;
+}
+
+void es8311_emul_reset_stats(const struct emul *target) {
+    struct es8311_emul_data *data = target->data;
+
+    memset(&data->stats, 0, sizeof(data->stats));
+}
+
+static int es8311_emul_init(const struct emul *target,
+                            const struct device *parent) {
+    ARG_UNUSED(parent);
+
+    es8311_emul_power_on(target);
+    return 0;
+}
+
+static const struct i2c_emul_api es8311_emul_api_i2c = {
+    .transfer = es8311_emul_transfer_i2c,
+};
+
+#define ES8311_EMUL(inst)							\
+	static struct es8311_emul_data es8311_emul_data_##inst;			\
+	EMUL_DT_INST_DEFINE(inst, es8311_emul_init, &es8311_emul_data_##inst,	\
+			    NULL, &es8311_emul_api_i2c, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(ES8311_EMUL)
@@ -55,6 +55,7 @@
 /* SDP Mode Registers */
 #define ES8311_SDP_IN 0x09
 #define ES8311_SDP_IN_SEL_SHIFT 7
+#define ES8311_SDP_IN_SEL BIT(ES8311_SDP_IN_SEL_SHIFT)
 #define ES8311_SDP_OUT 0x0A
 
 /* Following values are the same for both SPD_IN and SDP_OUT */
@@ -145,6 +146,10 @@
 #define ES8311_ADC8_EQBYPASS_SHIFT 6
 #define ES8311_ADC8_HPF_SHIFT 5
 
+/* ADC equalizer coefficients, ADCEQ1..ADCEQ20 */
+#define ES8311_ADCEQ1 0x1D
+#define ES8311_ADCEQ_SIZE 20
+
 /* DAC Registers */
 #define ES8311_DAC1 0x31
 #define ES8311_DAC1_DAC_DSMMUTE BIT(6)
@@ -169,6 +174,16 @@
 #define ES8311_DAC6_RAMPRATE_SHIFT 4
 #define ES8311_DAC6_EQBYPASS_SHIFT 3
 
+/* DAC equalizer coefficients, DACEQ1..DACEQ12 */
+#define ES8311_DACEQ1 0x38
+#define ES8311_DACEQ_SIZE 12
+
+/* Shared by the ALC (ADC4/ADC5) and the DRC (DAC4/DAC5) */
+#define ES8311_DYN_EN BIT(7)
+#define ES8311_DYN_WINSIZE_MASK GENMASK(3, 0)
+#define ES8311_DYN_MAXLEVEL_MASK GENMASK(7, 4)
+#define ES8311_DYN_MINLEVEL_MASK GENMASK(3, 0)
+
 /* GPIO Registers */
 #define ES8311_GPIO 0x44
 #define ES8311_GPIO_ADC2DAC_SEL_SHIFT 7
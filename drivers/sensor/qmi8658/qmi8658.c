@@ -1,13 +1,162 @@
 #define DT_DRV_COMPAT qst_qmi8658
 
 #include "qmi8658.h"
+#include "qmi8658_decoder.h"
 #include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
 
 #include "zephyr/sys/byteorder.h"
 LOG_MODULE_REGISTER(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
 
+// q31 multiplier rounded from micro units; the shift keeps full scale below 1.0
+#define QMI8658_SCALE(_micro, _shift) \
+    { \
+        .micro = (_micro), \
+        .q31 = (int32_t) ((((int64_t) (_micro) << (16 - (_shift))) + 500000) / 1000000), \
+        .shift = (_shift), \
+        .f = (_micro) / 32768e6f, \
+    }
+
+#define QMI8658_ACCEL_SCALE(range) QMI8658_SCALE((2LL << (range)) * SENSOR_G, 5 + (range))
+#define QMI8658_GYRO_SCALE(range) QMI8658_SCALE((16LL << (range)) * SENSOR_PI / 180, (range) - 1)
+
+const struct qmi8658_scale qmi8658_accel_scales[4] = {
+    QMI8658_ACCEL_SCALE(BIT_ACCEL_FS_2G),
+    QMI8658_ACCEL_SCALE(BIT_ACCEL_FS_4G),
+    QMI8658_ACCEL_SCALE(BIT_ACCEL_FS_8G),
+    QMI8658_ACCEL_SCALE(BIT_ACCEL_FS_16G),
+};
+
+const struct qmi8658_scale qmi8658_gyro_scales[8] = {
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_16DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_32DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_64DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_128DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_256DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_512DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_1024DPS),
+    QMI8658_GYRO_SCALE(BIT_GYRO_FS_2048DPS),
+};
+
+// Devicetree defaults resolved at build time with the rounding of the setters
+// below, so init only has to write the register images
+#define QMI8658_ACCEL_FS_FIELD(g) (LOG2CEIL(g) - 1)
+#define QMI8658_GYRO_FS_FIELD(dps) (LOG2CEIL(dps) - 4)
+#define QMI8658_ODR_FIELD(hz) \
+    ((hz) > 4000 ? BIT_ACCEL_ODR_8000HZ : (hz) > 2000 ? BIT_ACCEL_ODR_4000HZ : \
+     (hz) > 1000 ? BIT_ACCEL_ODR_2000HZ : (hz) > 500 ? BIT_ACCEL_ODR_1000HZ : \
+     (hz) > 200 ? BIT_ACCEL_ODR_500HZ : (hz) > 100 ? BIT_ACCEL_ODR_200HZ : \
+     (hz) > 50 ? BIT_ACCEL_ODR_100HZ : BIT_ACCEL_ODR_50HZ)
+#define QMI8658_ODR_HZ(hz) \
+    ((hz) > 4000 ? 8000 : (hz) > 2000 ? 4000 : (hz) > 1000 ? 2000 : (hz) > 500 ? 1000 : \
+     (hz) > 200 ? 500 : (hz) > 100 ? 200 : (hz) > 50 ? 100 : 50)
+#define QMI8658_LP_ODR_FIELD(hz) \
+    ((hz) > 21 ? BIT_ACCEL_ODR_LP_128HZ : (hz) > 11 ? BIT_ACCEL_ODR_LP_21HZ : \
+     (hz) > 3 ? BIT_ACCEL_ODR_LP_11HZ : BIT_ACCEL_ODR_LP_3HZ)
+#define QMI8658_LP_ODR_HZ(hz) ((hz) > 21 ? 128 : (hz) > 11 ? 21 : (hz) > 3 ? 11 : 3)
+
+static int qmi8658_wait_cmd_done(const struct device *dev, const bool done) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t status;
+    int ret;
+
+    for (int i = 0; i < CTRL9_POLL_RETRIES; i++) {
+        ret = qmi8658_reg_read(cfg, REG_STATUS_INT, &status, 1);
+        if (ret) {
+            return ret;
+        }
+        if (!!(status & BIT_CMD_DONE) == done) {
+            return 0;
+        }
+        k_busy_wait(CTRL9_POLL_US);
+    }
+
+    return -ETIMEDOUT;
+}
+
+// Acknowledge, the chip then clears CmdDone
+static int qmi8658_ctrl9_ack(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    int ret;
+
+    ret = qmi8658_reg_write(cfg, REG_CTRL9, CTRL_CMD_ACK);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_wait_cmd_done(dev, false);
+}
+
+int qmi8658_ctrl9_cmd(const struct device *dev, const uint8_t cmd) {
+    const struct qmi8658_config *cfg = dev->config;
+    int ret;
+
+    ret = qmi8658_reg_write(cfg, REG_CTRL9, cmd);
+    if (ret) {
+        return ret;
+    }
+
+    ret = qmi8658_wait_cmd_done(dev, true);
+    if (ret) {
+        LOG_ERR("ctrl9 command 0x%02X timed out", cmd);
+        return ret;
+    }
+
+    return qmi8658_ctrl9_ack(dev);
+}
+
+int qmi8658_ctrl9_cmd_slow(const struct device *dev, const uint8_t cmd) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t status;
+    int ret;
+
+    ret = qmi8658_reg_write(cfg, REG_CTRL9, cmd);
+    if (ret) {
+        return ret;
+    }
+
+    for (int i = 0; i < CTRL9_SLOW_POLL_RETRIES; i++) {
+        ret = qmi8658_reg_read(cfg, REG_STATUS_INT, &status, 1);
+        if (ret) {
+            return ret;
+        }
+        if (status & BIT_CMD_DONE) {
+            return qmi8658_ctrl9_ack(dev);
+        }
+        k_msleep(CTRL9_SLOW_POLL_MS);
+    }
+
+    LOG_ERR("ctrl9 command 0x%02X timed out", cmd);
+    return -ETIMEDOUT;
+}
+
+int qmi8658_ctrl9_cmd_args(const struct device *dev, const uint8_t cmd, const uint8_t *args) {
+    const struct qmi8658_config *cfg = dev->config;
+    int ret;
+
+    for (int i = 0; i < CTRL9_ARGS_SIZE; i++) {
+        ret = qmi8658_reg_write(cfg, REG_CAL1_L + i, args[i]);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return qmi8658_ctrl9_cmd(dev, cmd);
+}
+
+// WoM owns CTRL7 and the accel ODR while armed
+static bool qmi8658_wom_owns_sensors(const struct device *dev) {
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+    return qmi8658_wom_is_armed(dev);
+#else
+    ARG_UNUSED(dev);
+    return false;
+#endif
+}
+
 static int qmi8658_set_accel_fs(const struct device *dev, const uint16_t fs) {
     const struct qmi8658_config *cfg = dev->config;
     struct qmi8658_data *data = dev->data;
@@ -35,9 +184,11 @@ static int qmi8658_set_accel_fs(const struct device *dev, const uint16_t fs) {
 
     sensor_g_to_ms2(round_fs, &accel_fs_value);
     data->accel_fs = accel_fs_value.val1;
+    data->accel_range = tmp;
+    data->accel_scale = qmi8658_accel_scales[tmp];
 
-    return cfg->bus_io->update(&cfg->bus, REG_CTRL2, (uint8_t) MASK_ACCEL_FS,
-                               tmp);
+    return qmi8658_reg_update(cfg, REG_CTRL2, (uint8_t) MASK_ACCEL_FS,
+                              FIELD_PREP(MASK_ACCEL_FS, tmp));
 }
 
 static int qmi8658_set_gyro_fs(const struct device *dev, const uint16_t fs) {
@@ -80,9 +231,11 @@ static int qmi8658_set_gyro_fs(const struct device *dev, const uint16_t fs) {
 
     sensor_degrees_to_rad(round_fs, &gyro_fs_value);
     data->gyro_fs = gyro_fs_value.val1;
+    data->gyro_range = tmp;
+    data->gyro_scale = qmi8658_gyro_scales[tmp];
 
-    return cfg->bus_io->update(&cfg->bus, REG_CTRL3, (uint8_t) MASK_GYRO_FS,
-                               tmp);
+    return qmi8658_reg_update(cfg, REG_CTRL3, (uint8_t) MASK_GYRO_FS,
+                              FIELD_PREP(MASK_GYRO_FS, tmp));
 }
 
 static int qmi8658_set_accel_odr(const struct device *dev, const uint16_t rate) {
@@ -123,9 +276,49 @@ static int qmi8658_set_accel_odr(const struct device *dev, const uint16_t rate)
     }
 
     data->accel_hz = round_rate;
+    data->accel_odr = tmp;
+
+    // Kept for when the accel leaves low power mode
+    if ((data->accel_mode == QMI8658_POWER_LOW) || qmi8658_wom_owns_sensors(dev)) {
+        return 0;
+    }
 
-    return cfg->bus_io->update(&cfg->bus, REG_CTRL2, (uint8_t) MASK_ACCEL_ODR,
-                               tmp);
+    return qmi8658_reg_update(cfg, REG_CTRL2, (uint8_t) MASK_ACCEL_ODR, tmp);
+}
+
+static int qmi8658_set_accel_lp_odr(const struct device *dev, const uint16_t rate) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t tmp;
+    uint16_t round_rate;
+
+    if ((rate > 128) || (rate < 1)) {
+        LOG_ERR("Unsupported accel low power odr frequency");
+        return -ENOTSUP;
+    }
+
+    if (rate > 21) {
+        tmp = BIT_ACCEL_ODR_LP_128HZ;
+        round_rate = 128;
+    } else if (rate > 11) {
+        tmp = BIT_ACCEL_ODR_LP_21HZ;
+        round_rate = 21;
+    } else if (rate > 3) {
+        tmp = BIT_ACCEL_ODR_LP_11HZ;
+        round_rate = 11;
+    } else {
+        tmp = BIT_ACCEL_ODR_LP_3HZ;
+        round_rate = 3;
+    }
+
+    data->accel_lp_hz = round_rate;
+    data->accel_lp_odr = tmp;
+
+    if ((data->accel_mode != QMI8658_POWER_LOW) && !qmi8658_wom_owns_sensors(dev)) {
+        return 0;
+    }
+
+    return qmi8658_reg_update(cfg, REG_CTRL2, (uint8_t) MASK_ACCEL_ODR, tmp);
 }
 
 static int qmi8658_set_gyro_odr(const struct device *dev, const uint16_t rate) {
@@ -166,29 +359,119 @@ static int qmi8658_set_gyro_odr(const struct device *dev, const uint16_t rate) {
     }
 
     data->gyro_hz = round_rate;
+    data->gyro_odr = tmp;
 
-    return cfg->bus_io->update(&cfg->bus, REG_CTRL3, (uint8_t) MASK_GYRO_ODR,
-                               tmp);
+    return qmi8658_reg_update(cfg, REG_CTRL3, (uint8_t) MASK_GYRO_ODR, tmp);
 }
 
-static int qmi8658_sensor_init(const struct device *dev) {
-    int ret = 0;
-    uint8_t value;
-    const struct qmi8658_data *data = dev->data;
+static int qmi8658_power_write(const struct device *dev) {
     const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    uint8_t ctrl7 = 0;
+    int ret;
+
+    if (data->accel_mode != QMI8658_POWER_OFF) {
+        ctrl7 |= BIT_AEN;
+    }
+    if (data->gyro_mode == QMI8658_POWER_NORMAL) {
+        ctrl7 |= BIT_GEN;
+    } else if (data->gyro_mode == QMI8658_POWER_LOW) {
+        ctrl7 |= BIT_GEN | BIT_GSN;
+    }
 
-    k_msleep(3);
+    // The accel only switches between 6DoF and low power rates while disabled
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, 0);
+    if (ret) {
+        return ret;
+    }
 
-    ret = cfg->bus_io->write(&cfg->bus, REG_SOFT_RESET,BIT_SOFT_RESET);
+    ret = qmi8658_reg_update(cfg, REG_CTRL2, (uint8_t) MASK_ACCEL_ODR,
+                             data->accel_mode == QMI8658_POWER_LOW ? data->accel_lp_odr
+                                                                   : data->accel_odr);
     if (ret) {
-        LOG_ERR("soft reset failed");
         return ret;
     }
 
-    k_msleep(3);
+    return qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, ctrl7);
+}
+
+int qmi8658_power_apply(const struct device *dev) {
+#ifdef CONFIG_PM_DEVICE
+    enum pm_device_state state;
+
+    // Applied on resume
+    (void) pm_device_state_get(dev, &state);
+    if (state != PM_DEVICE_STATE_ACTIVE) {
+        return 0;
+    }
+#endif
+    if (qmi8658_wom_owns_sensors(dev)) {
+        return 0;
+    }
+
+    return qmi8658_power_write(dev);
+}
+
+static int qmi8658_set_accel_mode(const struct device *dev, const int32_t mode) {
+    struct qmi8658_data *data = dev->data;
+
+    if ((mode < QMI8658_POWER_NORMAL) || (mode > QMI8658_POWER_OFF)) {
+        LOG_ERR("Unsupported power mode %d", mode);
+        return -ENOTSUP;
+    }
+
+    // Low power rates are only generated without the gyro running
+    if ((mode == QMI8658_POWER_LOW) && (data->gyro_mode != QMI8658_POWER_OFF)) {
+        LOG_ERR("accel low power mode requires the gyro off");
+        return -EBUSY;
+    }
+
+    data->accel_mode = mode;
+
+    return qmi8658_power_apply(dev);
+}
+
+static int qmi8658_set_gyro_mode(const struct device *dev, const int32_t mode) {
+    struct qmi8658_data *data = dev->data;
+
+    if ((mode < QMI8658_POWER_NORMAL) || (mode > QMI8658_POWER_OFF)) {
+        LOG_ERR("Unsupported power mode %d", mode);
+        return -ENOTSUP;
+    }
+
+    if ((mode != QMI8658_POWER_OFF) && (data->accel_mode == QMI8658_POWER_LOW)) {
+        LOG_ERR("gyro requires the accel out of low power mode");
+        return -EBUSY;
+    }
+
+    data->gyro_mode = mode;
+
+    return qmi8658_power_apply(dev);
+}
+
+// 0 once the chip reports the soft reset complete, -EBUSY until then
+static int qmi8658_reset_poll(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t value;
+
+    // Reset cleared the interface settings, restore them before reading. The
+    // chip does not answer while it restarts, that is not an error yet.
+    if (qmi8658_bus_init(cfg) ||
+        qmi8658_reg_read(cfg, REG_RESET_STATUS, &value, 1)) {
+        return -EBUSY;
+    }
+
+    return value == RESET_STATUS_DONE ? 0 : -EBUSY;
+}
+
+static int qmi8658_sensor_init(const struct device *dev) {
+    int ret = 0;
+    uint8_t value;
+    const struct qmi8658_data *data = dev->data;
+    const struct qmi8658_config *cfg = dev->config;
 
     // Verify chip ID
-    ret = cfg->bus_io->read(&cfg->bus, REG_WHO_AM_I, &value, 1);
+    ret = qmi8658_reg_read(cfg, REG_WHO_AM_I, &value, 1);
     if (ret) {
         LOG_ERR("who_am_i read failed");
         return ret;
@@ -201,94 +484,100 @@ static int qmi8658_sensor_init(const struct device *dev) {
     LOG_DBG("device id: 0x%02X", value);
 
     // Enable address auto increment and internal oscillator
-    ret = cfg->bus_io->update(&cfg->bus, REG_CTRL1, BIT_ADDR_AI, BIT_ADDR_AI);
+    ret = qmi8658_reg_update(cfg, REG_CTRL1, BIT_ADDR_AI, BIT_ADDR_AI);
     if (ret) {
         LOG_ERR("reg_ctrl1 setup failed");
         return ret;
     }
 
-    // enable acc and gyro in full mode, and
-    // disable syncSample mode
-    ret = cfg->bus_io->update(&cfg->bus, REG_CTRL7, BIT_GEN | BIT_AEN,
-                              BIT_GEN | BIT_AEN);
+    // Report CTRL9 command completion through STATUS_INT instead of INT1
+    ret = qmi8658_reg_update(cfg, REG_CTRL8, BIT_CTRL9_HANDSHAKE, BIT_CTRL9_HANDSHAKE);
     if (ret) {
-        LOG_ERR("reg_ctrl7 setup failed");
+        LOG_ERR("reg_ctrl8 setup failed");
         return ret;
     }
 
-    ret = qmi8658_set_accel_fs(dev, data->accel_fs);
-    if (ret) {
-        LOG_ERR("set accel fs failed");
-        return ret;
-    }
-    ret = qmi8658_set_accel_odr(dev, data->accel_hz);
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+    ret = qmi8658_sync_init(dev);
     if (ret) {
-        LOG_ERR("set accel odr failed");
+        LOG_ERR("sync sample setup failed");
         return ret;
     }
-    ret = qmi8658_set_gyro_fs(dev, data->gyro_fs);
+#endif
+
+    // Ranges and rates are kept across a reset, sensors are enabled when the
+    // device is resumed
+    ret = qmi8658_reg_write(cfg, REG_CTRL2,
+                            FIELD_PREP(MASK_ACCEL_FS, data->accel_range) |
+                            (data->accel_mode == QMI8658_POWER_LOW ? data->accel_lp_odr
+                                                                   : data->accel_odr));
     if (ret) {
-        LOG_ERR("set gyro fs failed");
+        LOG_ERR("reg_ctrl2 setup failed");
         return ret;
     }
-    ret = qmi8658_set_gyro_odr(dev, data->gyro_hz);
+    ret = qmi8658_reg_write(cfg, REG_CTRL3,
+                            FIELD_PREP(MASK_GYRO_FS, data->gyro_range) | data->gyro_odr);
     if (ret) {
-        LOG_ERR("set gyro odr failed");
+        LOG_ERR("reg_ctrl3 setup failed");
         return ret;
     }
-    k_sleep(K_MSEC(30));
 
     LOG_DBG("qmi8658 initialized successfully");
     return ret;
 }
 
-static void qmi8658_convert_accel(struct sensor_value *val, const int16_t raw_val) {
-    const int64_t conv_val = ((int64_t) raw_val * SENSOR_G) >> ACCEL_SENSITIVITY_SHIFT;
-    val->val1 = (int32_t) (conv_val / 1000000LL);
-    val->val2 = (int32_t) (conv_val % 1000000LL);
-}
-
-static void qmi8658_convert_gyro(struct sensor_value *val, const int16_t raw_val) {
-    const int64_t conv_val = ((int64_t) raw_val * SENSOR_PI) >> GYRO_SENSITIVITY_SHIFT;
-    val->val1 = (int32_t) (conv_val / 1000000LL);
-    val->val2 = (int32_t) (conv_val % 1000000LL);
-}
-
 static int qmi8658_channel_get(const struct device *dev, const enum sensor_channel chan,
                                struct sensor_value *val) {
     int res = 0;
     const struct qmi8658_data *data = dev->data;
 
     switch (chan) {
+        case SENSOR_CHAN_ALL:
+            qmi8658_convert_sensor_value(&data->accel_scale, data->accel, &val[0], 3);
+            qmi8658_convert_sensor_value(&data->gyro_scale, data->gyro, &val[3], 3);
+            break;
         case SENSOR_CHAN_ACCEL_XYZ:
-            qmi8658_convert_accel(&val[0], data->accel_x);
-            qmi8658_convert_accel(&val[1], data->accel_y);
-            qmi8658_convert_accel(&val[2], data->accel_z);
+            qmi8658_convert_sensor_value(&data->accel_scale, data->accel, val, 3);
             break;
         case SENSOR_CHAN_ACCEL_X:
-            qmi8658_convert_accel(val, data->accel_x);
-            break;
         case SENSOR_CHAN_ACCEL_Y:
-            qmi8658_convert_accel(val, data->accel_y);
-            break;
         case SENSOR_CHAN_ACCEL_Z:
-            qmi8658_convert_accel(val, data->accel_z);
+            qmi8658_convert_sensor_value(&data->accel_scale,
+                                         &data->accel[chan - SENSOR_CHAN_ACCEL_X], val, 1);
             break;
         case SENSOR_CHAN_GYRO_XYZ:
-            qmi8658_convert_gyro(&val[0], data->gyro_x);
-            qmi8658_convert_gyro(&val[1], data->gyro_y);
-            qmi8658_convert_gyro(&val[2], data->gyro_z);
+            qmi8658_convert_sensor_value(&data->gyro_scale, data->gyro, val, 3);
             break;
         case SENSOR_CHAN_GYRO_X:
-            qmi8658_convert_gyro(val, data->gyro_x);
-            break;
         case SENSOR_CHAN_GYRO_Y:
-            qmi8658_convert_gyro(val, data->gyro_y);
-            break;
         case SENSOR_CHAN_GYRO_Z:
-            qmi8658_convert_gyro(val, data->gyro_z);
+            qmi8658_convert_sensor_value(&data->gyro_scale,
+                                         &data->gyro[chan - SENSOR_CHAN_GYRO_X], val, 1);
+            break;
+        case SENSOR_CHAN_DIE_TEMP:
+            // Signed 8.8 degrees Celsius
+            sensor_value_from_micro(val, (int64_t) data->temp * 1000000 / 256);
             break;
         default:
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+            if (qmi8658_ae_is_channel(chan)) {
+                res = qmi8658_ae_channel_get(dev, chan, val);
+                break;
+            }
+#endif
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+            if (chan == (enum sensor_channel) QMI8658_CHAN_TIMESTAMP) {
+                qmi8658_sync_channel_get(dev, val);
+                break;
+            }
+#endif
+#ifdef CONFIG_QMI8658_MOTION
+            if (chan == (enum sensor_channel) QMI8658_CHAN_STEP_COUNT) {
+                val->val1 = data->step_count;
+                val->val2 = 0;
+                break;
+            }
+#endif
             LOG_ERR("Unsupported channel");
             res = -ENOTSUP;
             break;
@@ -297,102 +586,202 @@ static int qmi8658_channel_get(const struct device *dev, const enum sensor_chann
     return res;
 }
 
-static int qmi8658_sample_fetch_accel(const struct device *dev) {
-    uint8_t ret = 0;
+int qmi8658_get_scale(const struct device *dev, const enum sensor_channel chan,
+                      struct qmi8658_scale *scale) {
+    const struct qmi8658_data *data = dev->data;
+
+    switch (chan) {
+        case SENSOR_CHAN_ACCEL_XYZ:
+            *scale = data->accel_scale;
+            return 0;
+        case SENSOR_CHAN_GYRO_XYZ:
+            *scale = data->gyro_scale;
+            return 0;
+        default:
+            return -ENOTSUP;
+    }
+}
+
+// Registers are read straight into the sample array and swapped in place
+int qmi8658_read_samples(const struct device *dev, const uint8_t reg, int16_t *samples) {
     const struct qmi8658_config *cfg = dev->config;
-    struct qmi8658_data *data = dev->data;
-    uint8_t buffer[ACCEL_DATA_SIZE];
+    int ret;
 
-    ret = cfg->bus_io->read(&cfg->bus, REG_AX_L, buffer, ACCEL_DATA_SIZE);
+    ret = qmi8658_reg_read(cfg, reg, (uint8_t *) samples, 3 * sizeof(int16_t));
     if (ret) {
-        LOG_ERR("read accel data failed");
         return ret;
     }
-    data->accel_x = (int16_t) sys_get_le16(&buffer[0]);
-    data->accel_y = (int16_t) sys_get_le16(&buffer[2]);
-    data->accel_z = (int16_t) sys_get_le16(&buffer[4]);
 
-    return ret;
+    for (int i = 0; i < 3; i++) {
+        samples[i] = (int16_t) sys_le16_to_cpu(samples[i]);
+    }
+
+    return 0;
 }
 
-static int qmi8658_sample_fetch_gyro(const struct device *dev) {
-    uint8_t ret = 0;
+#ifndef CONFIG_QMI8658_SYNC_SAMPLE
+// Status, temperature, accel and gyro in one auto-increment read. STATUS0
+// tells which sensors produced a sample since the last read, stale values
+// are left alone.
+static int qmi8658_fetch_burst(const struct device *dev, const enum sensor_channel chan) {
     const struct qmi8658_config *cfg = dev->config;
     struct qmi8658_data *data = dev->data;
-    uint8_t buffer[GYRO_DATA_SIZE];
+    uint8_t buf[FETCH_DATA_SIZE];
+    uint8_t status0, wanted;
+    int ret;
 
-    ret = cfg->bus_io->read(&cfg->bus, REG_GX_L, buffer, GYRO_DATA_SIZE);
+    ret = qmi8658_reg_read(cfg, REG_STATUS0, buf, sizeof(buf));
     if (ret) {
-        LOG_ERR("read gyro data failed");
+        LOG_ERR("read sensor data failed");
         return ret;
     }
-    data->gyro_x = (int16_t) sys_get_le16(&buffer[0]);
-    data->gyro_y = (int16_t) sys_get_le16(&buffer[2]);
-    data->gyro_z = (int16_t) sys_get_le16(&buffer[4]);
 
-    return ret;
+#if defined(CONFIG_QMI8658_MOTION) || defined(CONFIG_QMI8658_WAKE_ON_MOTION)
+    // STATUS1 is cleared by this read, keep its events for the interrupt handler
+    data->status1 |= buf[REG_STATUS1 - REG_STATUS0];
+#endif
+
+    status0 = buf[0];
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+    // Sample flags latched by an engine fetch count here, SDA is kept for the engine
+    status0 |= data->status0;
+    data->status0 = status0 & BIT_SDA;
+#endif
+    if (status0 & BIT_ADA) {
+        for (int i = 0; i < 3; i++) {
+            data->accel[i] = (int16_t) sys_get_le16(&buf[REG_AX_L - REG_STATUS0 + i * 2]);
+        }
+    }
+    if (status0 & BIT_GDA) {
+        for (int i = 0; i < 3; i++) {
+            data->gyro[i] = (int16_t) sys_get_le16(&buf[REG_GX_L - REG_STATUS0 + i * 2]);
+        }
+    }
+    // The temperature has no data ready flag, it updates at its own slow rate
+    data->temp = (int16_t) sys_get_le16(&buf[REG_TEMP_L - REG_STATUS0]);
+
+    switch (chan) {
+        case SENSOR_CHAN_DIE_TEMP:
+            return 0;
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+            wanted = BIT_ADA;
+            break;
+        case SENSOR_CHAN_GYRO_XYZ:
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            wanted = BIT_GDA;
+            break;
+        default:
+            wanted = BIT_ADA | BIT_GDA;
+            break;
+    }
+
+    return (status0 & wanted) ? 0 : -EBUSY;
 }
+#endif
 
 static int qmi8658_sample_fetch(const struct device *dev, const enum sensor_channel chan) {
-    uint8_t ret = 0;
-    uint8_t status;
-    const struct qmi8658_config *cfg = dev->config;
+    int ret = qmi8658_check_ready(dev);
 
-    ret = cfg->bus_io->read(&cfg->bus,REG_STATUS_INT, &status, 1);
     if (ret) {
-        LOG_ERR("read status 0 failed");
         return ret;
     }
-    if (!FIELD_GET(BIT_AVAIL, status)) {
-        return -EBUSY;
+
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+    const struct qmi8658_data *data = dev->data;
+
+    // Engine outputs have their own data ready flag in STATUS0
+    if (qmi8658_ae_is_channel(chan)) {
+        return qmi8658_ae_fetch(dev, true);
+    }
+#endif
+#ifdef CONFIG_QMI8658_MOTION
+    // The step counter is always valid, no need to check for new data
+    if (chan == (enum sensor_channel) QMI8658_CHAN_STEP_COUNT) {
+        return qmi8658_motion_fetch_steps(dev);
     }
+#endif
 
     switch (chan) {
         case SENSOR_CHAN_ALL:
-            ret = qmi8658_sample_fetch_accel(dev);
-            if (ret) {
-                break;
-            }
-            ret = qmi8658_sample_fetch_gyro(dev);
-            if (ret) {
-                break;
-            }
-            break;
         case SENSOR_CHAN_ACCEL_XYZ:
         case SENSOR_CHAN_ACCEL_X:
         case SENSOR_CHAN_ACCEL_Y:
         case SENSOR_CHAN_ACCEL_Z:
-            ret = qmi8658_sample_fetch_accel(dev);
-            break;
         case SENSOR_CHAN_GYRO_XYZ:
         case SENSOR_CHAN_GYRO_X:
         case SENSOR_CHAN_GYRO_Y:
         case SENSOR_CHAN_GYRO_Z:
-            ret = qmi8658_sample_fetch_gyro(dev);
+        case SENSOR_CHAN_DIE_TEMP:
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+        case (enum sensor_channel) QMI8658_CHAN_TIMESTAMP:
+            // Everything is latched together, any channel costs the same burst
+            ret = qmi8658_sync_fetch(dev);
+#else
+            ret = qmi8658_fetch_burst(dev, chan);
+#endif
             break;
         default:
             return -ENOTSUP;
     }
+
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+    // No new engine output yet is not an error for the whole sample. The burst
+    // has already latched SDA, a synchronized sample does not read STATUS0.
+    if (!ret && (chan == SENSOR_CHAN_ALL) && data->ae_hz) {
+        ret = qmi8658_ae_fetch(dev, IS_ENABLED(CONFIG_QMI8658_SYNC_SAMPLE));
+        if (ret == -EBUSY) {
+            ret = 0;
+        }
+    }
+#endif
     return ret;
 }
 
 static int qmi8658_attr_set(const struct device *dev, const enum sensor_channel chan, const enum sensor_attribute attr,
                             const struct sensor_value *val) {
     int ret = 0;
+    const struct qmi8658_data *data = dev->data;
     __ASSERT_NO_MSG(val!=NULL);
 
+    ret = qmi8658_check_ready(dev);
+    if (ret) {
+        return ret;
+    }
+
     switch (chan) {
         case SENSOR_CHAN_ACCEL_X:
         case SENSOR_CHAN_ACCEL_Y:
         case SENSOR_CHAN_ACCEL_Z:
         case SENSOR_CHAN_ACCEL_XYZ:
-            if (attr == SENSOR_ATTR_SAMPLING_FREQUENCY) {
+            if ((attr == SENSOR_ATTR_SAMPLING_FREQUENCY) &&
+                (data->accel_mode == QMI8658_POWER_LOW)) {
+                ret = qmi8658_set_accel_lp_odr(dev, val->val1);
+            } else if (attr == SENSOR_ATTR_SAMPLING_FREQUENCY) {
                 ret = qmi8658_set_accel_odr(dev, val->val1);
             } else if (attr == SENSOR_ATTR_FULL_SCALE) {
                 ret = qmi8658_set_accel_fs(dev, sensor_ms2_to_g(val));
+            } else if (attr == (enum sensor_attribute) QMI8658_ATTR_POWER_MODE) {
+                ret = qmi8658_set_accel_mode(dev, val->val1);
+#ifdef CONFIG_QMI8658_CALIBRATION
+            } else if (attr == SENSOR_ATTR_OFFSET) {
+                ret = qmi8658_cal_set_offset(dev, chan, val);
+#endif
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+            } else if (qmi8658_wom_is_attr(attr)) {
+                ret = qmi8658_wom_attr_set(dev, attr, val);
+#endif
             } else {
+#ifdef CONFIG_QMI8658_MOTION
+                ret = qmi8658_motion_attr_set(dev, attr, val);
+#else
                 LOG_ERR("Unsupported attribute %d", attr);
                 ret = -ENOTSUP;
+#endif
             }
             break;
         case SENSOR_CHAN_GYRO_X:
@@ -403,11 +792,37 @@ static int qmi8658_attr_set(const struct device *dev, const enum sensor_channel
                 ret = qmi8658_set_gyro_odr(dev, val->val1);
             } else if (attr == SENSOR_ATTR_FULL_SCALE) {
                 ret = qmi8658_set_gyro_fs(dev, val->val1);
+            } else if (attr == (enum sensor_attribute) QMI8658_ATTR_POWER_MODE) {
+                ret = qmi8658_set_gyro_mode(dev, val->val1);
+#ifdef CONFIG_QMI8658_CALIBRATION
+            } else if (attr == SENSOR_ATTR_OFFSET) {
+                ret = qmi8658_cal_set_offset(dev, chan, val);
+#endif
+            } else {
+                LOG_ERR("Unsupported attribute %d", attr);
+                ret = -ENOTSUP;
+            }
+            break;
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+        case SENSOR_CHAN_GAME_ROTATION_VECTOR:
+            if (attr == SENSOR_ATTR_SAMPLING_FREQUENCY) {
+                ret = qmi8658_ae_set_odr(dev, val->val1);
             } else {
                 LOG_ERR("Unsupported attribute %d", attr);
                 ret = -ENOTSUP;
             }
             break;
+#endif
+#ifdef CONFIG_QMI8658_FIFO
+        case SENSOR_CHAN_ALL:
+            if (attr == (enum sensor_attribute) QMI8658_ATTR_FIFO_WATERMARK) {
+                ret = qmi8658_fifo_set_watermark(dev, val->val1);
+            } else {
+                LOG_ERR("Unsupported attribute %d", attr);
+                ret = -ENOTSUP;
+            }
+            break;
+#endif
 
         default:
             LOG_ERR("Unsupported channel %d", attr);
@@ -423,6 +838,11 @@ static int qmi8658_attr_get(const struct device *dev, const enum sensor_channel
     const struct qmi8658_data *data = dev->data;
     __ASSERT_NO_MSG(val!=NULL);
 
+    ret = qmi8658_check_ready(dev);
+    if (ret) {
+        return ret;
+    }
+
     val->val2 = 0;
     switch (chan) {
         case SENSOR_CHAN_ACCEL_X:
@@ -430,9 +850,16 @@ static int qmi8658_attr_get(const struct device *dev, const enum sensor_channel
         case SENSOR_CHAN_ACCEL_Z:
         case SENSOR_CHAN_ACCEL_XYZ:
             if (attr == SENSOR_ATTR_SAMPLING_FREQUENCY) {
-                val->val1 = data->accel_hz;
+                val->val1 = data->accel_mode == QMI8658_POWER_LOW ? data->accel_lp_hz
+                                                                  : data->accel_hz;
             } else if (attr == SENSOR_ATTR_FULL_SCALE) {
                 val->val1 = data->accel_fs;
+            } else if (attr == (enum sensor_attribute) QMI8658_ATTR_POWER_MODE) {
+                val->val1 = data->accel_mode;
+#ifdef CONFIG_QMI8658_CALIBRATION
+            } else if (attr == SENSOR_ATTR_OFFSET) {
+                ret = qmi8658_cal_get_offset(dev, chan, val);
+#endif
             } else {
                 LOG_ERR("Unsupported channel %d", attr);
                 ret = -ENOTSUP;
@@ -446,11 +873,37 @@ static int qmi8658_attr_get(const struct device *dev, const enum sensor_channel
                 val->val1 = data->gyro_hz;
             } else if (attr == SENSOR_ATTR_FULL_SCALE) {
                 val->val1 = data->gyro_fs;
+            } else if (attr == (enum sensor_attribute) QMI8658_ATTR_POWER_MODE) {
+                val->val1 = data->gyro_mode;
+#ifdef CONFIG_QMI8658_CALIBRATION
+            } else if (attr == SENSOR_ATTR_OFFSET) {
+                ret = qmi8658_cal_get_offset(dev, chan, val);
+#endif
             } else {
                 LOG_ERR("Unsupported channel %d", attr);
                 ret = -ENOTSUP;
             }
             break;
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+        case SENSOR_CHAN_GAME_ROTATION_VECTOR:
+            if (attr == SENSOR_ATTR_SAMPLING_FREQUENCY) {
+                val->val1 = data->ae_hz;
+            } else {
+                LOG_ERR("Unsupported attribute %d", attr);
+                ret = -ENOTSUP;
+            }
+            break;
+#endif
+#ifdef CONFIG_QMI8658_FIFO
+        case SENSOR_CHAN_ALL:
+            if (attr == (enum sensor_attribute) QMI8658_ATTR_FIFO_WATERMARK) {
+                val->val1 = data->fifo_wm;
+            } else {
+                LOG_ERR("Unsupported attribute %d", attr);
+                ret = -ENOTSUP;
+            }
+            break;
+#endif
         default:
             LOG_ERR("Unsupported channel %d", attr);
             ret = -ENOTSUP;
@@ -459,21 +912,169 @@ static int qmi8658_attr_get(const struct device *dev, const enum sensor_channel
     return ret;
 }
 
-static inline int qmi8658_bus_check(const struct device *dev) {
+static int qmi8658_pm_action(const struct device *dev, const enum pm_device_action action) {
     const struct qmi8658_config *cfg = dev->config;
-    return cfg->bus_io->check(&cfg->bus);
-}
+    int ret;
 
-static int qmi8658_init(const struct device *dev) {
-    if (qmi8658_bus_check(dev) < 0) {
-        LOG_ERR("Bus is not ready");
-        return -ENODEV;
+    switch (action) {
+        case PM_DEVICE_ACTION_RESUME:
+            ret = qmi8658_reg_update(cfg, REG_CTRL1, BIT_OSC_DIS, 0);
+            if (ret) {
+                LOG_ERR("oscillator enable failed");
+                return ret;
+            }
+            if (qmi8658_wom_owns_sensors(dev)) {
+                return 0;
+            }
+            // No need to wait for the gyro to start up, until it has a
+            // sample STATUS0 makes fetches return -EBUSY
+            ret = qmi8658_power_write(dev);
+            if (ret) {
+                LOG_ERR("sensor enable failed");
+            }
+            return ret;
+        case PM_DEVICE_ACTION_SUSPEND:
+            // An armed WoM is the wake-up source, keep it sampling
+            if (qmi8658_wom_owns_sensors(dev)) {
+                return 0;
+            }
+            ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, 0);
+            if (ret) {
+                LOG_ERR("sensor disable failed");
+                return ret;
+            }
+            // Power-down, only the register interface stays alive
+            return qmi8658_reg_update(cfg, REG_CTRL1, BIT_OSC_DIS, BIT_OSC_DIS);
+        default:
+            return -ENOTSUP;
     }
+}
+
+// Everything after the reset, plain register accesses without waits
+static int qmi8658_setup(const struct device *dev) {
     if (qmi8658_sensor_init(dev)) {
         LOG_ERR("Sensor init failed");
         return -EIO;
     }
+#ifdef CONFIG_QMI8658_CALIBRATION
+    if (qmi8658_cal_init(dev)) {
+        LOG_ERR("Calibration init failed");
+        return -EIO;
+    }
+#endif
+#ifdef CONFIG_QMI8658_FIFO
+    if (qmi8658_fifo_init(dev)) {
+        LOG_ERR("FIFO init failed");
+        return -EIO;
+    }
+#endif
+#ifdef CONFIG_QMI8658_TRIGGER
+    if (qmi8658_trigger_init(dev)) {
+        LOG_ERR("Trigger init failed");
+        return -EIO;
+    }
+#endif
+#ifdef CONFIG_QMI8658_MOTION
+    if (qmi8658_motion_init(dev)) {
+        LOG_ERR("Motion engine init failed");
+        return -EIO;
+    }
+#endif
+    return pm_device_driver_init(dev, qmi8658_pm_action);
+}
+
+// Advance the bring-up by one step. Returns -EBUSY while the chip has to be
+// given time, 0 once the device is ready.
+static int qmi8658_init_step(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+    switch (data->init_step) {
+        case QMI8658_INIT_RESET:
+            // Retried until the chip has powered up and acknowledges
+            if (!qmi8658_reg_write(cfg, REG_SOFT_RESET, BIT_SOFT_RESET)) {
+                data->init_step = QMI8658_INIT_WAIT_RESET;
+            }
+            return -EBUSY;
+        case QMI8658_INIT_WAIT_RESET:
+            ret = qmi8658_reset_poll(dev);
+            if (ret) {
+                return ret;
+            }
+            data->init_step = QMI8658_INIT_DONE;
+            return qmi8658_setup(dev);
+        default:
+            return 0;
+    }
+}
+
+#ifdef CONFIG_QMI8658_DEFERRED_INIT
+static void qmi8658_init_work(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct qmi8658_data *data = CONTAINER_OF(dwork, struct qmi8658_data, init_work);
+    int ret;
+
+    ret = qmi8658_init_step(data->dev);
+    if ((ret == -EBUSY) && (++data->init_polls < INIT_POLL_RETRIES)) {
+        k_work_reschedule(dwork, K_MSEC(INIT_POLL_MS));
+        return;
+    }
+
+    data->init_res = (ret == -EBUSY) ? -ETIMEDOUT : ret;
+    if (data->init_res) {
+        LOG_ERR("Deferred init failed: %d", data->init_res);
+    }
+    k_event_post(&data->init_done, BIT(0));
+}
+#endif
+
+int qmi8658_init_wait(const struct device *dev, const k_timeout_t timeout) {
+#ifdef CONFIG_QMI8658_DEFERRED_INIT
+    struct qmi8658_data *data = dev->data;
+
+    if (k_event_wait(&data->init_done, BIT(0), false, timeout) == 0) {
+        return -EAGAIN;
+    }
+    return data->init_res;
+#else
+    ARG_UNUSED(dev);
+    ARG_UNUSED(timeout);
+    return 0;
+#endif
+}
+
+static int qmi8658_init(const struct device *dev) {
+    if (qmi8658_bus_check(dev->config) < 0) {
+        LOG_ERR("Bus is not ready");
+        return -ENODEV;
+    }
+
+#ifdef CONFIG_QMI8658_DEFERRED_INIT
+    struct qmi8658_data *data = dev->data;
+
+    // The chip is brought up from the system workqueue, API calls return
+    // -EAGAIN until it is done
+    data->dev = dev;
+    k_event_init(&data->init_done);
+    k_work_init_delayable(&data->init_work, qmi8658_init_work);
+    k_work_schedule(&data->init_work, K_NO_WAIT);
     return 0;
+#else
+    int ret;
+
+    // Poll the reset instead of sleeping for its worst case
+    for (int i = 0; i < INIT_POLL_RETRIES; i++) {
+        ret = qmi8658_init_step(dev);
+        if (ret != -EBUSY) {
+            return ret;
+        }
+        k_msleep(INIT_POLL_MS);
+    }
+
+    LOG_ERR("Reset did not complete");
+    return -ETIMEDOUT;
+#endif
 }
 
 static DEVICE_API(sensor, qmi8658_driver_api) = {
@@ -481,20 +1082,56 @@ static DEVICE_API(sensor, qmi8658_driver_api) = {
     .channel_get = qmi8658_channel_get,
     .attr_get = qmi8658_attr_get,
     .attr_set = qmi8658_attr_set,
+#ifdef CONFIG_QMI8658_TRIGGER
+    .trigger_set = qmi8658_trigger_set,
+#endif
+#ifdef CONFIG_SENSOR_ASYNC_API
+    .submit = qmi8658_submit,
+    .get_decoder = qmi8658_get_decoder,
+#endif
 };
 
+#define QMI8658_CONFIG_SPI(inst) \
+    .bus.spi = SPI_DT_SPEC_INST_GET(inst, QMI8658_SPI_OPERATION | \
+        COND_CODE_1(DT_INST_PROP(inst, spi_3wire), (SPI_HALF_DUPLEX), (0)), 0), \
+    IF_ENABLED(QMI8658_BUS_MIXED, (.bus_io = &qmi8658_bus_io_spi,))
+
+#define QMI8658_CONFIG_I2C(inst) \
+    .bus.i2c = I2C_DT_SPEC_INST_GET(inst), \
+    IF_ENABLED(QMI8658_BUS_MIXED, (.bus_io = &qmi8658_bus_io_i2c,))
+
 #define QMI8658_INIT(inst) \
     static struct qmi8658_data qmi8658_data_##inst = { \
-      .accel_hz = DT_INST_PROP(inst, accel_hz), \
-      .accel_fs = DT_INST_PROP(inst, accel_fs), \
-      .gyro_hz  = DT_INST_PROP(inst, gyro_hz),  \
-      .gyro_fs  = DT_INST_PROP(inst, gyro_fs),  \
+      .accel_range = QMI8658_ACCEL_FS_FIELD(DT_INST_PROP(inst, accel_fs)), \
+      .accel_scale = QMI8658_ACCEL_SCALE(QMI8658_ACCEL_FS_FIELD(DT_INST_PROP(inst, accel_fs))), \
+      .accel_fs = (int64_t) (1 << LOG2CEIL(DT_INST_PROP(inst, accel_fs))) * SENSOR_G / 1000000, \
+      .accel_odr = QMI8658_ODR_FIELD(DT_INST_PROP(inst, accel_hz)), \
+      .accel_hz = QMI8658_ODR_HZ(DT_INST_PROP(inst, accel_hz)), \
+      .accel_lp_odr = QMI8658_LP_ODR_FIELD(DT_INST_PROP(inst, accel_lp_hz)), \
+      .accel_lp_hz = QMI8658_LP_ODR_HZ(DT_INST_PROP(inst, accel_lp_hz)), \
+      .gyro_range = QMI8658_GYRO_FS_FIELD(DT_INST_PROP(inst, gyro_fs)), \
+      .gyro_scale = QMI8658_GYRO_SCALE(QMI8658_GYRO_FS_FIELD(DT_INST_PROP(inst, gyro_fs))), \
+      .gyro_fs = (int64_t) (1 << LOG2CEIL(DT_INST_PROP(inst, gyro_fs))) * SENSOR_PI / 180 / 1000000, \
+      .gyro_odr = QMI8658_ODR_FIELD(DT_INST_PROP(inst, gyro_hz)), \
+      .gyro_hz = QMI8658_ODR_HZ(DT_INST_PROP(inst, gyro_hz)), \
+      IF_ENABLED(CONFIG_QMI8658_WAKE_ON_MOTION, \
+          (.wom_th = QMI8658_WOM_TH_DEFAULT, \
+           .wom_blanking = QMI8658_WOM_BLANKING_DEFAULT,)) \
     }; \
     static const struct qmi8658_config qmi8658_cfg_##inst = { \
-        .bus.i2c = I2C_DT_SPEC_INST_GET(inst), \
-        .bus_io = &qmi8658_bus_io_i2c,\
+        COND_CODE_1(DT_INST_ON_BUS(inst, spi), \
+            (QMI8658_CONFIG_SPI(inst)), \
+            (QMI8658_CONFIG_I2C(inst))) \
+        IF_ENABLED(CONFIG_QMI8658_TRIGGER, \
+            (.int_gpio = GPIO_DT_SPEC_INST_GET_OR(inst, int_gpios, {0}),)) \
+        .int_pin = DT_INST_PROP(inst, int_pin), \
+        IF_ENABLED(CONFIG_QMI8658_FIFO, \
+            (.fifo_size = DT_INST_PROP(inst, fifo_size), \
+             .fifo_wm = DT_INST_PROP(inst, fifo_watermark),)) \
     }; \
-    SENSOR_DEVICE_DT_INST_DEFINE(inst, qmi8658_init, NULL, &qmi8658_data_##inst, \
+    PM_DEVICE_DT_INST_DEFINE(inst, qmi8658_pm_action); \
+    SENSOR_DEVICE_DT_INST_DEFINE(inst, qmi8658_init, PM_DEVICE_DT_INST_GET(inst), \
+        &qmi8658_data_##inst, \
         &qmi8658_cfg_##inst, POST_KERNEL, \
         CONFIG_SENSOR_INIT_PRIORITY, &qmi8658_driver_api);
 
@@ -1,25 +1,31 @@
-// TODO: add SPI support
-// TODO: add interrupt support
 // TODO: low pass filter support
-// TODO: temperature sensor support
 
 #ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_H_
 #define ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_H_
 
 #include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/spi.h>
+#include <app/drivers/sensor/qmi8658.h>
 
 #define QMI8658_BUS_I2C DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658, i2c)
 #define QMI8658_BUS_SPI DT_HAS_COMPAT_ON_BUS_STATUS_OKAY(qst_qmi8658, spi)
 
 union qmi8658_bus {
-#ifdef QMI8658_BUS_I2C
+#if QMI8658_BUS_I2C
     struct i2c_dt_spec i2c;
 #endif
+#if QMI8658_BUS_SPI
+    struct spi_dt_spec spi;
+#endif
 };
 
 typedef int (*qmi8658_bus_check_fn)(const union qmi8658_bus *bus);
 
+typedef int (*qmi8658_bus_init_fn)(const union qmi8658_bus *bus);
+
 typedef int (*qmi8658_reg_read_fn)(const union qmi8658_bus *bus, uint16_t reg, uint8_t *data, size_t size);
 
 typedef int (*qmi8658_reg_write_fn)(const union qmi8658_bus *bus, uint16_t reg, uint8_t data);
@@ -28,31 +34,338 @@ typedef int (*qmi8658_reg_update_fn)(const union qmi8658_bus *bus, uint16_t reg,
 
 struct qmi8658_bus_io {
     qmi8658_bus_check_fn check;
+    qmi8658_bus_init_fn init;
     qmi8658_reg_read_fn read;
     qmi8658_reg_write_fn write;
     qmi8658_reg_update_fn update;
 };
 
-#ifdef QMI8658_BUS_I2C
+// With a single bus type the register accessors below call its primitives
+// directly, the bus_io table is only dispatched through when both are used
+#define QMI8658_BUS_MIXED (QMI8658_BUS_I2C && QMI8658_BUS_SPI)
+
+#include "qmi8658_i2c.h"
+#include "qmi8658_spi.h"
+
+#if QMI8658_BUS_MIXED
 extern const struct qmi8658_bus_io qmi8658_bus_io_i2c;
+extern const struct qmi8658_bus_io qmi8658_bus_io_spi;
 #endif
 
+#if QMI8658_BUS_SPI
+#define QMI8658_SPI_OPERATION (SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_MODE_CPOL | SPI_MODE_CPHA)
+#endif
+
+#ifdef CONFIG_QMI8658_MOTION
+// Motion engine events, each with its own trigger
+enum qmi8658_event {
+    QMI8658_EVENT_ANY_MOTION,
+    QMI8658_EVENT_NO_MOTION,
+    QMI8658_EVENT_SIG_MOTION,
+    QMI8658_EVENT_TAP,
+    QMI8658_EVENT_DOUBLE_TAP,
+    QMI8658_EVENT_STEP,
+    QMI8658_EVENT_COUNT,
+};
+
+// Motion engine settings in the chip's units, see CTRL9 configure commands
+struct qmi8658_motion_cfg {
+    uint8_t any_motion_th;      // U3.5 g
+    uint8_t any_motion_win;     // samples
+    uint8_t no_motion_th;       // U3.5 g
+    uint8_t no_motion_win;      // samples
+    uint16_t sig_motion_wait;   // samples
+    uint16_t sig_motion_confirm; // samples
+    uint16_t tap_th;            // U5.11 g^2
+    uint16_t tap_win;           // samples
+    uint16_t dtap_win;          // samples
+    uint16_t step_th;           // U5.11 g
+    uint16_t step_win;          // samples
+};
+#endif
+
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+// Chip sample counter correlated with the host clock
+struct qmi8658_sync_clock {
+    uint64_t sample_ns;     // host uptime at which the last sample was latched
+    int64_t period_q8;      // tracked sample period, ns in Q8, 0 until the first sample
+    uint32_t count;         // counter value of the last sample
+    uint16_t hz;            // rate the period was tracked at
+};
+#endif
+
+#ifdef CONFIG_QMI8658_CALIBRATION
+// Calibration in the chip's units, persisted as is
+struct qmi8658_cal {
+    int16_t accel_offset[3];    // signed 4.12 g
+    int16_t gyro_offset[3];     // signed 11.5 dps
+    uint16_t gyro_gain[3];      // on-demand calibration result, 0 if never run
+};
+#endif
+
+// Bring-up steps, see qmi8658_init_step()
+enum qmi8658_init_step {
+    QMI8658_INIT_RESET,
+    QMI8658_INIT_WAIT_RESET,
+    QMI8658_INIT_DONE,
+};
+
 struct qmi8658_data {
-    int16_t accel_x;
-    int16_t accel_y;
-    int16_t accel_z;
+    // Raw samples, accel and gyro adjacent so SENSOR_CHAN_ALL converts in one pass
+    int16_t accel[3];
+    int16_t gyro[3];
+    struct qmi8658_scale accel_scale;
+    struct qmi8658_scale gyro_scale;
     uint16_t accel_fs;
     uint16_t accel_hz;
-    int16_t gyro_x;
-    int16_t gyro_y;
-    int16_t gyro_z;
+    uint8_t accel_range;
     uint16_t gyro_fs;
     uint16_t gyro_hz;
-    uint16_t temp;
+    uint8_t gyro_range;
+    uint8_t gyro_odr;
+    int16_t temp;
+
+    // Power modes and the CTRL2 ODR field of each accel mode, applied together
+    uint8_t accel_mode;
+    uint8_t gyro_mode;
+    uint8_t accel_odr;
+    uint8_t accel_lp_odr;
+    uint16_t accel_lp_hz;
+
+    uint8_t init_step;
+#ifdef CONFIG_QMI8658_DEFERRED_INIT
+    struct k_work_delayable init_work;
+    struct k_event init_done;
+    int init_res;
+    uint8_t init_polls;
+#endif
+
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+    struct qmi8658_sync_clock sync;
+#endif
+
+#ifdef CONFIG_QMI8658_CALIBRATION
+    struct qmi8658_cal cal;
+#endif
+
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+    uint16_t ae_hz;
+    // dQW, dQX, dQY, dQZ, dVX, dVY, dVZ of the last engine period
+    int16_t ae_raw[7];
+    // Orientation accumulated from the increments, w, x, y, z in Q30
+    int32_t ae_quat[4];
+    // STATUS0 flags read by one fetch and left for another, it clears on read
+    uint8_t status0;
+#endif
+
+#ifdef CONFIG_QMI8658_FIFO
+    uint8_t fifo_ctrl;
+    uint8_t fifo_wm;
+#endif
+
+#if defined(CONFIG_QMI8658_TRIGGER) || defined(CONFIG_QMI8658_DEFERRED_INIT)
+    const struct device *dev;
+#endif
+
+#ifdef CONFIG_QMI8658_TRIGGER
+    struct gpio_callback gpio_cb;
+
+    sensor_trigger_handler_t drdy_handler;
+    const struct sensor_trigger *drdy_trigger;
+    sensor_trigger_handler_t fifo_wm_handler;
+    const struct sensor_trigger *fifo_wm_trigger;
+    sensor_trigger_handler_t fifo_full_handler;
+    const struct sensor_trigger *fifo_full_trigger;
+
+#ifdef CONFIG_QMI8658_MOTION
+    struct qmi8658_motion_cfg motion;
+    struct {
+        sensor_trigger_handler_t handler;
+        const struct sensor_trigger *trigger;
+    } events[QMI8658_EVENT_COUNT];
+    uint32_t step_count;
+#endif
+
+#if defined(CONFIG_QMI8658_MOTION) || defined(CONFIG_QMI8658_WAKE_ON_MOTION)
+    // STATUS1 events consumed by a sample fetch, not yet handled
+    uint8_t status1;
+#endif
+
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+    sensor_trigger_handler_t wom_handler;
+    const struct sensor_trigger *wom_trigger;
+    uint8_t wom_th;         // mg
+    uint8_t wom_blanking;   // samples
+#endif
+
+#if defined(CONFIG_QMI8658_TRIGGER_OWN_THREAD)
+    K_KERNEL_STACK_MEMBER(thread_stack, CONFIG_QMI8658_THREAD_STACK_SIZE);
+    struct k_thread thread;
+    struct k_sem gpio_sem;
+#elif defined(CONFIG_QMI8658_TRIGGER_GLOBAL_THREAD)
+    struct k_work work;
+#endif
+#endif
 };
 
 struct qmi8658_config {
     union qmi8658_bus bus;
+#if QMI8658_BUS_MIXED
     const struct qmi8658_bus_io *bus_io;
+#endif
+#ifdef CONFIG_QMI8658_TRIGGER
+    struct gpio_dt_spec int_gpio;
+#endif
+    uint8_t int_pin;
+#ifdef CONFIG_QMI8658_FIFO
+    uint8_t fifo_size;
+    uint8_t fifo_wm;
+#endif
 };
+
+#if QMI8658_BUS_MIXED
+#define QMI8658_BUS_FN(cfg, op, fn) ((cfg)->bus_io->op)
+#elif QMI8658_BUS_SPI
+#define QMI8658_BUS_FN(cfg, op, fn) fn##_spi
+#else
+#define QMI8658_BUS_FN(cfg, op, fn) fn##_i2c
+#endif
+
+static inline int qmi8658_bus_check(const struct qmi8658_config *cfg) {
+    return QMI8658_BUS_FN(cfg, check, qmi8658_bus_check)(&cfg->bus);
+}
+
+static inline int qmi8658_bus_init(const struct qmi8658_config *cfg) {
+    return QMI8658_BUS_FN(cfg, init, qmi8658_bus_init)(&cfg->bus);
+}
+
+static inline int qmi8658_reg_read(const struct qmi8658_config *cfg, const uint16_t reg, uint8_t *data,
+                                   const size_t size) {
+    return QMI8658_BUS_FN(cfg, read, qmi8658_reg_read)(&cfg->bus, reg, data, size);
+}
+
+static inline int qmi8658_reg_write(const struct qmi8658_config *cfg, const uint16_t reg, const uint8_t data) {
+    return QMI8658_BUS_FN(cfg, write, qmi8658_reg_write)(&cfg->bus, reg, data);
+}
+
+static inline int qmi8658_reg_update(const struct qmi8658_config *cfg, const uint16_t reg, const uint8_t mask,
+                                     const uint8_t val) {
+    return QMI8658_BUS_FN(cfg, update, qmi8658_reg_update)(&cfg->bus, reg, mask, val);
+}
+
+// Conversion factors indexed by the CTRL2/CTRL3 full-scale field
+extern const struct qmi8658_scale qmi8658_accel_scales[4];
+extern const struct qmi8658_scale qmi8658_gyro_scales[8];
+
+// -EAGAIN while a deferred init is still running, its result afterwards
+static inline int qmi8658_check_ready(const struct device *dev) {
+#ifdef CONFIG_QMI8658_DEFERRED_INIT
+    const struct qmi8658_data *data = dev->data;
+
+    if (!k_event_test((struct k_event *) &data->init_done, BIT(0))) {
+        return -EAGAIN;
+    }
+    return data->init_res;
+#else
+    ARG_UNUSED(dev);
+    return 0;
+#endif
+}
+
+int qmi8658_ctrl9_cmd(const struct device *dev, uint8_t cmd);
+
+// Write the CTRL9_ARGS_SIZE argument bytes, then issue the command
+int qmi8658_ctrl9_cmd_args(const struct device *dev, uint8_t cmd, const uint8_t *args);
+
+// Same as qmi8658_ctrl9_cmd(), sleeping between polls for commands that take
+// hundreds of milliseconds
+int qmi8658_ctrl9_cmd_slow(const struct device *dev, uint8_t cmd);
+
+// Read three little-endian int16 registers starting at reg
+int qmi8658_read_samples(const struct device *dev, uint8_t reg, int16_t *samples);
+
+// Program CTRL7 and the accel ODR for the cached power modes
+int qmi8658_power_apply(const struct device *dev);
+
+#ifdef CONFIG_QMI8658_CALIBRATION
+int qmi8658_cal_init(const struct device *dev);
+
+int qmi8658_cal_set_offset(const struct device *dev, enum sensor_channel chan,
+                           const struct sensor_value *val);
+
+int qmi8658_cal_get_offset(const struct device *dev, enum sensor_channel chan,
+                           struct sensor_value *val);
+#endif
+
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+int qmi8658_sync_init(const struct device *dev);
+
+// Burst read of one latched sample, accel x, y, z then gyro x, y, z into
+// samples. timestamp may be NULL.
+int qmi8658_sync_read(const struct device *dev, int16_t *samples, int16_t *temp,
+                      uint64_t *timestamp);
+
+int qmi8658_sync_fetch(const struct device *dev);
+
+void qmi8658_sync_channel_get(const struct device *dev, struct sensor_value *val);
+#endif
+
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+bool qmi8658_ae_is_channel(enum sensor_channel chan);
+
+int qmi8658_ae_set_odr(const struct device *dev, uint16_t rate);
+
+int qmi8658_ae_fetch(const struct device *dev, bool poll);
+
+int qmi8658_ae_channel_get(const struct device *dev, enum sensor_channel chan,
+                           struct sensor_value *val);
+#endif
+
+#ifdef CONFIG_QMI8658_FIFO
+int qmi8658_fifo_init(const struct device *dev);
+
+int qmi8658_fifo_set_watermark(const struct device *dev, uint16_t wm);
+
+int qmi8658_fifo_status(const struct device *dev, uint8_t *status, uint16_t *frames);
+#endif
+
+#ifdef CONFIG_QMI8658_MOTION
+int qmi8658_motion_init(const struct device *dev);
+
+int qmi8658_motion_attr_set(const struct device *dev, enum sensor_attribute attr,
+                            const struct sensor_value *val);
+
+int qmi8658_motion_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                               sensor_trigger_handler_t handler);
+
+bool qmi8658_motion_is_enabled(const struct device *dev);
+
+void qmi8658_motion_handle_interrupt(const struct device *dev, uint8_t status1);
+
+int qmi8658_motion_fetch_steps(const struct device *dev);
+#endif
+
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+#define QMI8658_WOM_TH_DEFAULT 200 // mg
+#define QMI8658_WOM_BLANKING_DEFAULT 4
+
+bool qmi8658_wom_is_attr(enum sensor_attribute attr);
+
+bool qmi8658_wom_is_armed(const struct device *dev);
+
+int qmi8658_wom_attr_set(const struct device *dev, enum sensor_attribute attr,
+                         const struct sensor_value *val);
+
+int qmi8658_wom_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                            sensor_trigger_handler_t handler);
+
+void qmi8658_wom_handle_interrupt(const struct device *dev, uint8_t status1);
+#endif
+
+#ifdef CONFIG_QMI8658_TRIGGER
+int qmi8658_trigger_init(const struct device *dev);
+
+int qmi8658_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                        sensor_trigger_handler_t handler);
+#endif
 #endif //ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_H_
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/logging/log.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+// Accumulated orientation is kept in Q30, 1.0 = 2^30
+#define QUAT_SHIFT 30
+#define QUAT_ONE (1 << QUAT_SHIFT)
+
+static void qmi8658_ae_reset_orientation(struct qmi8658_data *data) {
+    data->ae_quat[0] = QUAT_ONE;
+    data->ae_quat[1] = 0;
+    data->ae_quat[2] = 0;
+    data->ae_quat[3] = 0;
+}
+
+// q = q * dq, with q in Q30 and dq in the chip's Q14 format
+static void qmi8658_ae_integrate(struct qmi8658_data *data, const int16_t *dq) {
+    const int64_t w = data->ae_quat[0], x = data->ae_quat[1];
+    const int64_t y = data->ae_quat[2], z = data->ae_quat[3];
+    int64_t norm = 0;
+    int32_t k;
+
+    data->ae_quat[0] = (w * dq[0] - x * dq[1] - y * dq[2] - z * dq[3]) >> AE_DQ_SHIFT;
+    data->ae_quat[1] = (w * dq[1] + x * dq[0] + y * dq[3] - z * dq[2]) >> AE_DQ_SHIFT;
+    data->ae_quat[2] = (w * dq[2] - x * dq[3] + y * dq[0] + z * dq[1]) >> AE_DQ_SHIFT;
+    data->ae_quat[3] = (w * dq[3] + x * dq[2] - y * dq[1] + z * dq[0]) >> AE_DQ_SHIFT;
+
+    // The Q14 increments are not exactly unit length, one Newton step of
+    // 1/sqrt(|q|^2) around 1.0 keeps the accumulated quaternion normalized
+    for (int i = 0; i < 4; i++) {
+        norm += ((int64_t) data->ae_quat[i] * data->ae_quat[i]) >> QUAT_SHIFT;
+    }
+    k = (int32_t) (((3LL << QUAT_SHIFT) - norm) >> 1);
+    for (int i = 0; i < 4; i++) {
+        data->ae_quat[i] = ((int64_t) data->ae_quat[i] * k) >> QUAT_SHIFT;
+    }
+}
+
+bool qmi8658_ae_is_channel(const enum sensor_channel chan) {
+    switch ((int) chan) {
+        case SENSOR_CHAN_GAME_ROTATION_VECTOR:
+        case QMI8658_CHAN_DELTA_QUAT:
+        case QMI8658_CHAN_DELTA_VELOCITY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int qmi8658_ae_set_odr(const struct device *dev, const uint16_t rate) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t tmp = BIT_AE_ODR_1HZ;
+    int ret;
+
+    if (rate > 64) {
+        LOG_ERR("Unsupported attitude engine odr frequency");
+        return -ENOTSUP;
+    }
+
+    if (rate == 0) {
+        ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_SEN, 0);
+        if (ret) {
+            return ret;
+        }
+        data->ae_hz = 0;
+        return 0;
+    }
+
+    // Round up to the next power of two, 1 Hz is field value 0
+    while ((1 << tmp) < rate) {
+        tmp++;
+    }
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL6, (uint8_t) MASK_AE_ODR, tmp);
+    if (ret) {
+        LOG_ERR("reg_ctrl6 setup failed");
+        return ret;
+    }
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_SEN, BIT_SEN);
+    if (ret) {
+        LOG_ERR("reg_ctrl7 setup failed");
+        return ret;
+    }
+
+    data->ae_hz = 1 << tmp;
+    data->status0 &= ~BIT_SDA;
+    qmi8658_ae_reset_orientation(data);
+
+    return 0;
+}
+
+int qmi8658_ae_fetch(const struct device *dev, const bool poll) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t status;
+    int ret;
+
+    if (data->ae_hz == 0) {
+        return -ENODATA;
+    }
+
+    // The accel and gyro flags cleared by this read are kept for their fetch
+    if (poll && !(data->status0 & BIT_SDA)) {
+        ret = qmi8658_reg_read(cfg, REG_STATUS0, &status, 1);
+        if (ret) {
+            LOG_ERR("read status 0 failed");
+            return ret;
+        }
+        data->status0 |= status;
+    }
+
+    // Integrating the same increment twice would corrupt the orientation
+    if (!(data->status0 & BIT_SDA)) {
+        return -EBUSY;
+    }
+
+    ret = qmi8658_reg_read(cfg, REG_DQW_L, (uint8_t *) data->ae_raw, AE_DATA_SIZE);
+    if (ret) {
+        LOG_ERR("read attitude engine data failed");
+        return ret;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(data->ae_raw); i++) {
+        data->ae_raw[i] = (int16_t) sys_le16_to_cpu(data->ae_raw[i]);
+    }
+
+    data->status0 &= ~BIT_SDA;
+    qmi8658_ae_integrate(data, &data->ae_raw[0]);
+
+    return 0;
+}
+
+static void qmi8658_ae_convert_quat(struct sensor_value *val, const int64_t q, const int shift) {
+    const int32_t micro = (int32_t) ((q * 1000000) >> shift);
+
+    val->val1 = micro / 1000000;
+    val->val2 = micro % 1000000;
+}
+
+int qmi8658_ae_channel_get(const struct device *dev, const enum sensor_channel chan,
+                           struct sensor_value *val) {
+    const struct qmi8658_data *data = dev->data;
+
+    if (!qmi8658_ae_is_channel(chan)) {
+        return -ENOTSUP;
+    }
+    if (data->ae_hz == 0) {
+        return -ENODATA;
+    }
+
+    switch ((int) chan) {
+        case SENSOR_CHAN_GAME_ROTATION_VECTOR:
+            for (int i = 0; i < 4; i++) {
+                qmi8658_ae_convert_quat(&val[i], data->ae_quat[i], QUAT_SHIFT);
+            }
+            return 0;
+        case QMI8658_CHAN_DELTA_QUAT:
+            for (int i = 0; i < 4; i++) {
+                qmi8658_ae_convert_quat(&val[i], data->ae_raw[i], AE_DQ_SHIFT);
+            }
+            return 0;
+        default:
+            // Velocity increments share the accelerometer sensitivity
+            qmi8658_convert_sensor_value(&data->accel_scale, &data->ae_raw[4], val, 3);
+            return 0;
+    }
+}
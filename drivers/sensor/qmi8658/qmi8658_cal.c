@@ -0,0 +1,402 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <stdlib.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+#define QMI8658_SETTINGS_KEY_SIZE 48
+
+static bool qmi8658_cal_busy(const struct device *dev) {
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+    if (qmi8658_wom_is_armed(dev)) {
+        LOG_ERR("wake on motion armed");
+        return true;
+    }
+#else
+    ARG_UNUSED(dev);
+#endif
+    return false;
+}
+
+#ifdef CONFIG_QMI8658_CALIBRATION_SETTINGS
+static void qmi8658_cal_key(const struct device *dev, char *key) {
+    snprintk(key, QMI8658_SETTINGS_KEY_SIZE, "qmi8658/%s", dev->name);
+}
+
+static int qmi8658_cal_load_cb(const char *key, const size_t len, const settings_read_cb read_cb,
+                               void *cb_arg, void *param) {
+    struct qmi8658_cal *cal = param;
+    struct qmi8658_cal tmp;
+    ssize_t ret;
+
+    ARG_UNUSED(key);
+
+    // Ignore a record written by an incompatible layout
+    if (len != sizeof(tmp)) {
+        LOG_WRN("stored calibration has unexpected size %zu", len);
+        return 0;
+    }
+
+    ret = read_cb(cb_arg, &tmp, sizeof(tmp));
+    if (ret < 0) {
+        return ret;
+    }
+
+    *cal = tmp;
+    return 0;
+}
+#endif
+
+static int qmi8658_cal_save(const struct device *dev) {
+#ifdef CONFIG_QMI8658_CALIBRATION_SETTINGS
+    const struct qmi8658_data *data = dev->data;
+    char key[QMI8658_SETTINGS_KEY_SIZE];
+    int ret;
+
+    qmi8658_cal_key(dev, key);
+    ret = settings_save_one(key, &data->cal, sizeof(data->cal));
+    if (ret) {
+        LOG_ERR("save calibration failed: %d", ret);
+    }
+
+    return ret;
+#else
+    ARG_UNUSED(dev);
+    return 0;
+#endif
+}
+
+static int qmi8658_cal_write_offset(const struct device *dev, const uint8_t cmd,
+                                    const int16_t *offset) {
+    uint8_t args[CTRL9_ARGS_SIZE] = {0};
+
+    for (int i = 0; i < 3; i++) {
+        sys_put_le16((uint16_t) offset[i], &args[i * 2]);
+    }
+
+    return qmi8658_ctrl9_cmd_args(dev, cmd, args);
+}
+
+static int qmi8658_cal_write_gains(const struct device *dev) {
+    const struct qmi8658_data *data = dev->data;
+    uint8_t args[CTRL9_ARGS_SIZE] = {0};
+
+    for (int i = 0; i < 3; i++) {
+        sys_put_le16(data->cal.gyro_gain[i], &args[i * 2]);
+    }
+
+    return qmi8658_ctrl9_cmd_args(dev, CTRL_CMD_APPLY_GYRO_GAINS, args);
+}
+
+// Offsets are subtracted from the sensor output by the chip
+static int qmi8658_cal_apply(const struct device *dev) {
+    const struct qmi8658_data *data = dev->data;
+    int ret;
+
+    ret = qmi8658_cal_write_offset(dev, CTRL_CMD_ACCEL_HOST_DELTA_OFFSET, data->cal.accel_offset);
+    if (ret) {
+        LOG_ERR("write accel offset failed");
+        return ret;
+    }
+
+    ret = qmi8658_cal_write_offset(dev, CTRL_CMD_GYRO_HOST_DELTA_OFFSET, data->cal.gyro_offset);
+    if (ret) {
+        LOG_ERR("write gyro offset failed");
+    }
+
+    return ret;
+}
+
+// Offset unit in micro SI units is SENSOR_G >> 12 or SENSOR_PI / (180 << 5)
+static int qmi8658_cal_from_micro(const bool accel, const int64_t micro, int16_t *out) {
+    const int64_t den = accel ? SENSOR_G : (int64_t) SENSOR_PI;
+    const int64_t num = accel ? (1 << CAL_ACCEL_OFFSET_SHIFT) : (180 << CAL_GYRO_OFFSET_SHIFT);
+    const int64_t q = (micro * num + (micro < 0 ? -den / 2 : den / 2)) / den;
+
+    if ((q < INT16_MIN) || (q > INT16_MAX)) {
+        return -EINVAL;
+    }
+
+    *out = q;
+    return 0;
+}
+
+static int64_t qmi8658_cal_to_micro(const bool accel, const int16_t q) {
+    if (accel) {
+        return ((int64_t) q * SENSOR_G) >> CAL_ACCEL_OFFSET_SHIFT;
+    }
+    return ((int64_t) q * SENSOR_PI) / (180 << CAL_GYRO_OFFSET_SHIFT);
+}
+
+int qmi8658_cal_set_offset(const struct device *dev, const enum sensor_channel chan,
+                           const struct sensor_value *val) {
+    struct qmi8658_data *data = dev->data;
+    const bool accel = chan == SENSOR_CHAN_ACCEL_XYZ;
+    int16_t offset[3];
+    int ret;
+
+    if (!accel && (chan != SENSOR_CHAN_GYRO_XYZ)) {
+        LOG_ERR("Offsets are set on the XYZ channels");
+        return -ENOTSUP;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        ret = qmi8658_cal_from_micro(accel, sensor_value_to_micro(&val[i]), &offset[i]);
+        if (ret) {
+            LOG_ERR("Offset out of range");
+            return ret;
+        }
+    }
+
+    memcpy(accel ? data->cal.accel_offset : data->cal.gyro_offset, offset, sizeof(offset));
+
+    ret = qmi8658_cal_write_offset(dev, accel ? CTRL_CMD_ACCEL_HOST_DELTA_OFFSET
+                                              : CTRL_CMD_GYRO_HOST_DELTA_OFFSET, offset);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_cal_save(dev);
+}
+
+int qmi8658_cal_get_offset(const struct device *dev, const enum sensor_channel chan,
+                           struct sensor_value *val) {
+    const struct qmi8658_data *data = dev->data;
+    const bool accel = chan == SENSOR_CHAN_ACCEL_XYZ;
+    const int16_t *offset = accel ? data->cal.accel_offset : data->cal.gyro_offset;
+
+    if (!accel && (chan != SENSOR_CHAN_GYRO_XYZ)) {
+        LOG_ERR("Offsets are read from the XYZ channels");
+        return -ENOTSUP;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        sensor_value_from_micro(&val[i], qmi8658_cal_to_micro(accel, offset[i]));
+    }
+
+    return 0;
+}
+
+static int qmi8658_cal_wait_avail(const struct device *dev, const bool avail) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t status;
+    int ret;
+
+    for (int i = 0; i < SELF_TEST_POLL_RETRIES; i++) {
+        ret = qmi8658_reg_read(cfg, REG_STATUS_INT, &status, 1);
+        if (ret) {
+            return ret;
+        }
+        if (!!(status & BIT_AVAIL) == avail) {
+            return 0;
+        }
+        k_msleep(SELF_TEST_POLL_MS);
+    }
+
+    return -ETIMEDOUT;
+}
+
+int qmi8658_self_test(const struct device *dev, const enum sensor_channel chan) {
+    const struct qmi8658_config *cfg = dev->config;
+    const bool accel = chan == SENSOR_CHAN_ACCEL_XYZ;
+    const uint8_t reg = accel ? REG_CTRL2 : REG_CTRL3;
+    const uint8_t bit = accel ? BIT_ACCEL_ST : BIT_GYRO_ST;
+    const int16_t min = accel ? SELF_TEST_ACCEL_MIN : SELF_TEST_GYRO_MIN;
+    int16_t result[3];
+    int ret, ret2;
+
+    if (!accel && (chan != SENSOR_CHAN_GYRO_XYZ)) {
+        LOG_ERR("Unsupported channel");
+        return -ENOTSUP;
+    }
+    if (qmi8658_cal_busy(dev)) {
+        return -EBUSY;
+    }
+
+    // The self-test runs with the sensors disabled
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, 0);
+    if (ret) {
+        return ret;
+    }
+
+    ret = qmi8658_reg_update(cfg, reg, bit, bit);
+    if (!ret) {
+        ret = qmi8658_cal_wait_avail(dev, true);
+    }
+
+    // Always leave self-test mode, then wait for the chip to acknowledge
+    ret2 = qmi8658_reg_update(cfg, reg, bit, 0);
+    if (!ret2) {
+        ret2 = qmi8658_cal_wait_avail(dev, false);
+    }
+    ret = ret ? ret : ret2;
+
+    if (!ret) {
+        ret = qmi8658_read_samples(dev, REG_DVX_L, result);
+    }
+
+    ret2 = qmi8658_power_apply(dev);
+    if (ret) {
+        LOG_ERR("self-test did not complete");
+        return ret;
+    }
+    if (ret2) {
+        return ret2;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (abs(result[i]) < min) {
+            LOG_ERR("%s self-test failed on axis %d: %d", accel ? "accel" : "gyro", i,
+                    result[i]);
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+int qmi8658_calibrate_gyro_gain(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    int16_t gain[3];
+    uint8_t status;
+    int ret;
+
+    if (qmi8658_cal_busy(dev)) {
+        return -EBUSY;
+    }
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, 0);
+    if (ret) {
+        return ret;
+    }
+
+    ret = qmi8658_ctrl9_cmd_slow(dev, CTRL_CMD_ON_DEMAND_CALIBRATION);
+    if (!ret) {
+        ret = qmi8658_reg_read(cfg, REG_COD_STATUS, &status, 1);
+    }
+    if (!ret && status) {
+        LOG_ERR("on-demand calibration failed: 0x%02X", status);
+        ret = -EIO;
+    }
+    // The new gains are reported in dVX..dVZ
+    if (!ret) {
+        ret = qmi8658_read_samples(dev, REG_DVX_L, gain);
+    }
+
+    if (ret) {
+        qmi8658_power_apply(dev);
+        return ret;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        data->cal.gyro_gain[i] = (uint16_t) gain[i];
+    }
+
+    ret = qmi8658_power_apply(dev);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_cal_save(dev);
+}
+
+int qmi8658_calibrate_bias(const struct device *dev, const uint16_t samples) {
+    struct qmi8658_data *data = dev->data;
+    const uint16_t hz = MIN(data->accel_hz, data->gyro_hz);
+    const uint8_t accel_g = 2 << data->accel_range;
+    const uint16_t gyro_dps = 16 << data->gyro_range;
+    int64_t sum[6] = {0};
+    int32_t accel[3], gyro[3];
+    int tries = 0, axis = 0;
+    int ret;
+
+    if (samples == 0) {
+        return -EINVAL;
+    }
+    if ((data->accel_mode != QMI8658_POWER_NORMAL) ||
+        (data->gyro_mode != QMI8658_POWER_NORMAL) || qmi8658_cal_busy(dev)) {
+        LOG_ERR("bias estimation needs both sensors in normal mode");
+        return -EBUSY;
+    }
+
+    for (uint16_t n = 0; n < samples;) {
+        ret = sensor_sample_fetch(dev);
+        if (ret == -EBUSY) {
+            // Not every poll lands on a new sample, give up when none come
+            if (++tries > 4 * samples) {
+                return -ETIMEDOUT;
+            }
+        } else if (ret) {
+            return ret;
+        } else {
+            for (int i = 0; i < 3; i++) {
+                sum[i] += data->accel[i];
+                sum[i + 3] += data->gyro[i];
+            }
+            n++;
+        }
+        k_usleep(USEC_PER_SEC / hz);
+    }
+
+    // Full scale is 32768 LSB, the residual bias is added to the current offset
+    for (int i = 0; i < 3; i++) {
+        accel[i] = (sum[i] * accel_g << CAL_ACCEL_OFFSET_SHIFT) / (32768LL * samples);
+        gyro[i] = (sum[i + 3] * gyro_dps << CAL_GYRO_OFFSET_SHIFT) / (32768LL * samples);
+        if (abs(accel[i]) > abs(accel[axis])) {
+            axis = i;
+        }
+    }
+
+    // At rest, gravity is on the axis with the largest reading
+    accel[axis] -= (accel[axis] > 0 ? 1 : -1) << CAL_ACCEL_OFFSET_SHIFT;
+
+    for (int i = 0; i < 3; i++) {
+        data->cal.accel_offset[i] = CLAMP(data->cal.accel_offset[i] + accel[i], INT16_MIN, INT16_MAX);
+        data->cal.gyro_offset[i] = CLAMP(data->cal.gyro_offset[i] + gyro[i], INT16_MIN, INT16_MAX);
+    }
+
+    ret = qmi8658_cal_apply(dev);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_cal_save(dev);
+}
+
+int qmi8658_cal_init(const struct device *dev) {
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+#ifdef CONFIG_QMI8658_CALIBRATION_SETTINGS
+    char key[QMI8658_SETTINGS_KEY_SIZE];
+
+    ret = settings_subsys_init();
+    if (ret) {
+        LOG_ERR("settings init failed");
+        return ret;
+    }
+
+    qmi8658_cal_key(dev, key);
+    ret = settings_load_subtree_direct(key, qmi8658_cal_load_cb, &data->cal);
+    if (ret) {
+        LOG_ERR("load calibration failed");
+        return ret;
+    }
+#endif
+
+    // Reset dropped whatever was applied before
+    if (data->cal.gyro_gain[0] || data->cal.gyro_gain[1] || data->cal.gyro_gain[2]) {
+        ret = qmi8658_cal_write_gains(dev);
+        if (ret) {
+            LOG_ERR("apply gyro gains failed");
+            return ret;
+        }
+    }
+
+    return qmi8658_cal_apply(dev);
+}
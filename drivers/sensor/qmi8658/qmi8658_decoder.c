@@ -0,0 +1,127 @@
+#define DT_DRV_COMPAT qst_qmi8658
+
+#include "qmi8658.h"
+#include "qmi8658_decoder.h"
+#include <zephyr/sys/byteorder.h>
+
+static int qmi8658_decoder_get_frame_count(const uint8_t *buffer, const struct sensor_chan_spec chan_spec,
+                                           uint16_t *frame_count) {
+    ARG_UNUSED(buffer);
+
+    if (chan_spec.chan_idx != 0) {
+        return -ENOTSUP;
+    }
+
+    switch (chan_spec.chan_type) {
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+        case SENSOR_CHAN_GYRO_XYZ:
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            *frame_count = 1;
+            return 0;
+        default:
+            return -ENOTSUP;
+    }
+}
+
+static int qmi8658_decoder_get_size_info(const struct sensor_chan_spec chan_spec, size_t *base_size,
+                                         size_t *frame_size) {
+    switch (chan_spec.chan_type) {
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_GYRO_XYZ:
+            *base_size = sizeof(struct sensor_three_axis_data);
+            *frame_size = sizeof(struct sensor_three_axis_sample_data);
+            return 0;
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            *base_size = sizeof(struct sensor_q31_data);
+            *frame_size = sizeof(struct sensor_q31_sample_data);
+            return 0;
+        default:
+            return -ENOTSUP;
+    }
+}
+
+static int qmi8658_decoder_decode(const uint8_t *buffer, const struct sensor_chan_spec chan_spec, uint32_t *fit,
+                                  const uint16_t max_count, void *data_out) {
+    const struct qmi8658_encoded_data *edata = (const struct qmi8658_encoded_data *) buffer;
+    enum sensor_channel x_chan;
+    const struct qmi8658_scale *scale;
+    const int16_t *raw;
+
+    if ((*fit != 0) || (max_count == 0) || (chan_spec.chan_idx != 0)) {
+        return 0;
+    }
+
+    switch (chan_spec.chan_type) {
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+            x_chan = SENSOR_CHAN_ACCEL_X;
+            raw = &edata->readings[0];
+            scale = &qmi8658_accel_scales[edata->header.accel_range];
+            break;
+        case SENSOR_CHAN_GYRO_XYZ:
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            x_chan = SENSOR_CHAN_GYRO_X;
+            raw = &edata->readings[3];
+            scale = &qmi8658_gyro_scales[edata->header.gyro_range];
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    switch (chan_spec.chan_type) {
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_GYRO_XYZ: {
+            struct sensor_three_axis_data *out = data_out;
+
+            out->header.base_timestamp_ns = edata->header.timestamp;
+            out->header.reading_count = 1;
+            out->shift = scale->shift;
+            out->readings[0].timestamp_delta = 0;
+            for (int i = 0; i < 3; i++) {
+                out->readings[0].values[i] = (int16_t) sys_le16_to_cpu(raw[i]) * scale->q31;
+            }
+            break;
+        }
+        default: {
+            struct sensor_q31_data *out = data_out;
+            const int axis = chan_spec.chan_type - x_chan;
+
+            out->header.base_timestamp_ns = edata->header.timestamp;
+            out->header.reading_count = 1;
+            out->shift = scale->shift;
+            out->readings[0].timestamp_delta = 0;
+            out->readings[0].value = (int16_t) sys_le16_to_cpu(raw[axis]) * scale->q31;
+            break;
+        }
+    }
+
+    *fit = 1;
+    return 1;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+    .get_frame_count = qmi8658_decoder_get_frame_count,
+    .get_size_info = qmi8658_decoder_get_size_info,
+    .decode = qmi8658_decoder_decode,
+};
+
+int qmi8658_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder) {
+    ARG_UNUSED(dev);
+    *decoder = &SENSOR_DECODER_NAME();
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_DECODER_H_
+#define ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_DECODER_H_
+
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+
+// Raw registers of one async read, decoded later by the sensor decoder
+struct qmi8658_encoded_data {
+    struct {
+        uint64_t timestamp;
+        uint8_t accel_range;
+        uint8_t gyro_range;
+    } header;
+    // AX_L..GZ_H as read from the bus, little-endian
+    int16_t readings[6];
+};
+
+int qmi8658_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder);
+
+void qmi8658_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe);
+
+#endif //ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_DECODER_H_
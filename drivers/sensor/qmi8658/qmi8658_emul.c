@@ -0,0 +1,447 @@
+#define DT_DRV_COMPAT qst_qmi8658
+
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658_emul.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_REGISTER(QMI8658_EMUL, CONFIG_SENSOR_LOG_LEVEL);
+
+#define QMI8658_EMUL_NUM_REGS (REG_SOFT_RESET + 1)
+#define QMI8658_EMUL_FIFO_FRAMES 128
+
+// Fixed q31 shifts used by the sensor backend, wide enough for the largest range
+#define QMI8658_EMUL_ACCEL_SHIFT 8
+#define QMI8658_EMUL_GYRO_SHIFT 6
+
+// Gains reported by the on-demand calibration
+#define QMI8658_EMUL_COD_GAIN 0x4000
+
+struct qmi8658_emul_data {
+    uint8_t regs[QMI8658_EMUL_NUM_REGS];
+    uint8_t fifo[QMI8658_EMUL_FIFO_FRAMES * FIFO_FRAME_SIZE];
+    size_t fifo_len;
+    bool fifo_overflow;
+    // Self-test responses, reported in dVX..dVZ
+    int16_t st_accel[3];
+    int16_t st_gyro[3];
+    struct qmi8658_emul_stats stats;
+};
+
+static void qmi8658_emul_reset(struct qmi8658_emul_data *data) {
+    memset(data->regs, 0, sizeof(data->regs));
+    data->regs[REG_WHO_AM_I] = WHO_AM_I_QMI8658;
+    data->regs[REG_REVERSION_ID] = REVERSION_ID_QMI8658;
+    // The reset completes instantly
+    data->regs[REG_RESET_STATUS] = RESET_STATUS_DONE;
+    data->fifo_len = 0;
+    data->fifo_overflow = false;
+}
+
+static uint16_t qmi8658_emul_fifo_capacity(const struct qmi8658_emul_data *data) {
+    return 16 << FIELD_GET(MASK_FIFO_SIZE, data->regs[REG_FIFO_CTRL]);
+}
+
+static void qmi8658_emul_fifo_update(struct qmi8658_emul_data *data) {
+    const uint16_t words = data->fifo_len / 2;
+    const uint16_t frames = data->fifo_len / FIFO_FRAME_SIZE;
+    const uint8_t wm = data->regs[REG_FIFO_WTM_TH];
+    uint8_t status = FIELD_PREP(MASK_FIFO_SMPL_CNT_MSB, words >> 8);
+
+    if (data->fifo_len) {
+        status |= BIT_FIFO_NOT_EMPTY;
+    }
+    if (wm && (frames >= wm)) {
+        status |= BIT_FIFO_WTM;
+    }
+    if (frames >= qmi8658_emul_fifo_capacity(data)) {
+        status |= BIT_FIFO_FULL;
+    }
+    if (data->fifo_overflow) {
+        status |= BIT_FIFO_OVFLOW;
+    }
+
+    data->regs[REG_FIFO_SMPL_CNT] = words & 0xFF;
+    data->regs[REG_FIFO_STATUS] = status;
+}
+
+static uint8_t qmi8658_emul_fifo_pop(struct qmi8658_emul_data *data) {
+    uint8_t val;
+
+    if (!(data->regs[REG_FIFO_CTRL] & BIT_FIFO_RD_MODE)) {
+        LOG_WRN("fifo data read outside of fifo read mode");
+        return 0;
+    }
+    if (data->fifo_len == 0) {
+        return 0;
+    }
+
+    val = data->fifo[0];
+    data->fifo_len--;
+    memmove(data->fifo, &data->fifo[1], data->fifo_len);
+
+    return val;
+}
+
+static void qmi8658_emul_ctrl9(struct qmi8658_emul_data *data, const uint8_t cmd) {
+    data->regs[REG_CTRL9] = cmd;
+
+    if (cmd == CTRL_CMD_ACK) {
+        data->regs[REG_STATUS_INT] &= ~BIT_CMD_DONE;
+        return;
+    }
+
+    switch (cmd) {
+        case CTRL_CMD_RST_FIFO:
+            data->fifo_len = 0;
+            data->fifo_overflow = false;
+            break;
+        case CTRL_CMD_REQ_FIFO:
+            data->regs[REG_FIFO_CTRL] |= BIT_FIFO_RD_MODE;
+            break;
+        case CTRL_CMD_WRITE_WOM_SETTING:
+        case CTRL_CMD_CONFIGURE_TAP:
+        case CTRL_CMD_CONFIGURE_PEDOMETER:
+        case CTRL_CMD_CONFIGURE_MOTION:
+        case CTRL_CMD_ACCEL_HOST_DELTA_OFFSET:
+        case CTRL_CMD_GYRO_HOST_DELTA_OFFSET:
+        case CTRL_CMD_APPLY_GYRO_GAINS:
+            // Arguments stay in CAL1-CAL4 for the test to inspect
+            break;
+        case CTRL_CMD_RESET_PEDOMETER:
+            data->regs[REG_STEP_CNT_LOW] = 0;
+            data->regs[REG_STEP_CNT_MID] = 0;
+            data->regs[REG_STEP_CNT_HIGH] = 0;
+            break;
+        case CTRL_CMD_ON_DEMAND_CALIBRATION:
+            data->regs[REG_COD_STATUS] = 0;
+            for (int i = 0; i < 3; i++) {
+                sys_put_le16(QMI8658_EMUL_COD_GAIN, &data->regs[REG_DVX_L + i * 2]);
+            }
+            break;
+        default:
+            LOG_WRN("unhandled ctrl9 command 0x%02X", cmd);
+            break;
+    }
+
+    qmi8658_emul_fifo_update(data);
+    data->regs[REG_STATUS_INT] |= BIT_CMD_DONE;
+}
+
+// Setting the self-test bit reports the response, clearing it drops avail
+static void qmi8658_emul_self_test(struct qmi8658_emul_data *data, const uint8_t reg,
+                                   const uint8_t val) {
+    const int16_t *response = (reg == REG_CTRL2) ? data->st_accel : data->st_gyro;
+    const uint8_t bit = (reg == REG_CTRL2) ? BIT_ACCEL_ST : BIT_GYRO_ST;
+
+    if ((val & bit) && !(data->regs[reg] & bit)) {
+        for (int i = 0; i < 3; i++) {
+            sys_put_le16((uint16_t) response[i], &data->regs[REG_DVX_L + i * 2]);
+        }
+        data->regs[REG_STATUS_INT] |= BIT_AVAIL;
+    } else if (!(val & bit) && (data->regs[reg] & bit)) {
+        data->regs[REG_STATUS_INT] &= ~BIT_AVAIL;
+    }
+}
+
+static void qmi8658_emul_write(struct qmi8658_emul_data *data, const uint8_t reg, const uint8_t val) {
+    switch (reg) {
+        case REG_SOFT_RESET:
+            if (val == BIT_SOFT_RESET) {
+                qmi8658_emul_reset(data);
+            }
+            break;
+        case REG_CTRL9:
+            qmi8658_emul_ctrl9(data, val);
+            break;
+        case REG_CTRL2:
+        case REG_CTRL3:
+            qmi8658_emul_self_test(data, reg, val);
+            data->regs[reg] = val;
+            break;
+        case REG_CTRL1:
+        case REG_CTRL4:
+        case REG_CTRL5:
+        case REG_CTRL6:
+        case REG_CTRL7:
+        case REG_CTRL8:
+        case REG_CAL1_L ... REG_CAL4_H:
+        case REG_FIFO_CTRL:
+            data->regs[reg] = val;
+            break;
+        case REG_FIFO_WTM_TH:
+            data->regs[reg] = val;
+            qmi8658_emul_fifo_update(data);
+            break;
+        default:
+            LOG_WRN("write to read-only register 0x%02X", reg);
+            break;
+    }
+}
+
+static uint8_t qmi8658_emul_read(struct qmi8658_emul_data *data, const uint8_t reg) {
+    uint8_t val;
+
+    if (reg == REG_FIFO_DATA) {
+        val = qmi8658_emul_fifo_pop(data);
+        qmi8658_emul_fifo_update(data);
+        return val;
+    }
+
+    // The emulated sensors always have a new sample by the time they are polled
+    if (reg == REG_STATUS0) {
+        val = data->regs[reg];
+        if (data->regs[REG_CTRL7] & BIT_AEN) {
+            val |= BIT_ADA;
+        }
+        if ((data->regs[REG_CTRL7] & (BIT_GEN | BIT_GSN)) == BIT_GEN) {
+            val |= BIT_GDA;
+        }
+        data->regs[reg] = 0;
+        return val;
+    }
+
+    // Event flags clear once reported
+    if (reg == REG_STATUS1) {
+        val = data->regs[reg];
+        data->regs[reg] = 0;
+        return val;
+    }
+
+    return data->regs[reg];
+}
+
+static uint8_t qmi8658_emul_next_reg(const struct qmi8658_emul_data *data, const uint8_t reg) {
+    // FIFO_DATA is a port, the address stays put while draining it
+    if ((reg == REG_FIFO_DATA) || !(data->regs[REG_CTRL1] & BIT_ADDR_AI)) {
+        return reg;
+    }
+    return reg + 1;
+}
+
+static int qmi8658_emul_transfer_i2c(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+                                     int addr) {
+    struct qmi8658_emul_data *data = target->data;
+    uint8_t reg;
+
+    i2c_dump_msgs_rw(target->dev, msgs, num_msgs, addr, false);
+
+    if ((num_msgs < 1) || (msgs[0].flags & I2C_MSG_READ) || (msgs[0].len < 1)) {
+        LOG_ERR("transfer must start with a register address");
+        return -EIO;
+    }
+
+    data->stats.transfers++;
+    reg = msgs[0].buf[0];
+
+    for (int i = 0; i < num_msgs; i++) {
+        // The register address is the first byte of the first write only
+        for (uint32_t j = (i == 0) ? 1 : 0; j < msgs[i].len; j++) {
+            if (reg >= QMI8658_EMUL_NUM_REGS) {
+                LOG_ERR("register 0x%02X out of range", reg);
+                return -EIO;
+            }
+            if (msgs[i].flags & I2C_MSG_READ) {
+                msgs[i].buf[j] = qmi8658_emul_read(data, reg);
+            } else {
+                qmi8658_emul_write(data, reg, msgs[i].buf[j]);
+            }
+            reg = qmi8658_emul_next_reg(data, reg);
+        }
+        data->stats.bytes += msgs[i].len;
+    }
+
+    return 0;
+}
+
+static int64_t qmi8658_emul_q31_to_micro(const q31_t value, const int8_t shift) {
+    const int64_t micro = (int64_t) value * 1000000LL;
+
+    if (shift >= 0) {
+        return (micro * (1LL << shift)) / (1LL << 31);
+    }
+    return micro / (1LL << (31 - shift));
+}
+
+static q31_t qmi8658_emul_micro_to_q31(const int64_t micro, const int8_t shift) {
+    return (q31_t) ((micro * (1LL << 31)) / (1000000LL << shift));
+}
+
+// Full-scale range in micro m/s^2 or micro rad/s, from the emulated CTRL registers
+static int64_t qmi8658_emul_full_scale(const struct qmi8658_emul_data *data, const bool accel) {
+    if (accel) {
+        return (2LL << FIELD_GET(MASK_ACCEL_FS, data->regs[REG_CTRL2])) * SENSOR_G;
+    }
+    return (16LL << FIELD_GET(MASK_GYRO_FS, data->regs[REG_CTRL3])) * SENSOR_PI / 180;
+}
+
+static int qmi8658_emul_backend_set_channel(const struct emul *target, struct sensor_chan_spec ch,
+                                            const q31_t *value, int8_t shift) {
+    struct qmi8658_emul_data *data = target->data;
+    uint8_t reg;
+    bool accel;
+    int64_t raw;
+
+    switch (ch.chan_type) {
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+            reg = REG_AX_L + (ch.chan_type - SENSOR_CHAN_ACCEL_X) * 2;
+            accel = true;
+            break;
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            reg = REG_GX_L + (ch.chan_type - SENSOR_CHAN_GYRO_X) * 2;
+            accel = false;
+            break;
+        default:
+            return -ENOTSUP;
+    }
+
+    // 16-bit two's complement output, full scale maps to 32768 LSB
+    raw = qmi8658_emul_q31_to_micro(*value, shift) * 32768 / qmi8658_emul_full_scale(data, accel);
+    raw = CLAMP(raw, INT16_MIN, INT16_MAX);
+
+    sys_put_le16((uint16_t) raw, &data->regs[reg]);
+    data->regs[REG_STATUS0] |= accel ? BIT_ADA : BIT_GDA;
+    data->regs[REG_STATUS_INT] |= BIT_AVAIL;
+    if (data->regs[REG_CTRL7] & BIT_SYNC_SAMPLE_EN) {
+        data->regs[REG_STATUS_INT] |= BIT_LOCKED;
+    }
+
+    return 0;
+}
+
+static int qmi8658_emul_backend_get_sample_range(const struct emul *target, struct sensor_chan_spec ch,
+                                                 q31_t *lower, q31_t *upper, q31_t *epsilon,
+                                                 int8_t *shift) {
+    const struct qmi8658_emul_data *data = target->data;
+    int64_t fs;
+
+    switch (ch.chan_type) {
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+        case SENSOR_CHAN_ACCEL_XYZ:
+            fs = qmi8658_emul_full_scale(data, true);
+            *shift = QMI8658_EMUL_ACCEL_SHIFT;
+            break;
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+        case SENSOR_CHAN_GYRO_XYZ:
+            fs = qmi8658_emul_full_scale(data, false);
+            *shift = QMI8658_EMUL_GYRO_SHIFT;
+            break;
+        default:
+            return -ENOTSUP;
+    }
+
+    *upper = qmi8658_emul_micro_to_q31(fs, *shift);
+    *lower = -*upper;
+    *epsilon = MAX(qmi8658_emul_micro_to_q31(fs / 32768, *shift), 1);
+
+    return 0;
+}
+
+void qmi8658_emul_set_reg(const struct emul *target, const uint8_t reg, const uint8_t val) {
+    struct qmi8658_emul_data *data = target->data;
+
+    __ASSERT_NO_MSG(reg < QMI8658_EMUL_NUM_REGS);
+    data->regs[reg] = val;
+}
+
+uint8_t qmi8658_emul_get_reg(const struct emul *target, const uint8_t reg) {
+    const struct qmi8658_emul_data *data = target->data;
+
+    __ASSERT_NO_MSG(reg < QMI8658_EMUL_NUM_REGS);
+    return data->regs[reg];
+}
+
+void qmi8658_emul_fifo_push(const struct emul *target, const struct qmi8658_fifo_frame *frames,
+                            const size_t count) {
+    struct qmi8658_emul_data *data = target->data;
+    const size_t capacity = qmi8658_emul_fifo_capacity(data) * FIFO_FRAME_SIZE;
+    uint8_t *dst;
+
+    for (size_t i = 0; i < count; i++) {
+        if (data->fifo_len >= capacity) {
+            // Stream mode, the oldest frame is overwritten
+            data->fifo_len -= FIFO_FRAME_SIZE;
+            memmove(data->fifo, &data->fifo[FIFO_FRAME_SIZE], data->fifo_len);
+            data->fifo_overflow = true;
+        }
+
+        dst = &data->fifo[data->fifo_len];
+        for (size_t j = 0; j < 3; j++) {
+            sys_put_le16((uint16_t) frames[i].accel[j], &dst[j * 2]);
+            sys_put_le16((uint16_t) frames[i].gyro[j], &dst[ACCEL_DATA_SIZE + j * 2]);
+        }
+        data->fifo_len += FIFO_FRAME_SIZE;
+    }
+
+    qmi8658_emul_fifo_update(data);
+}
+
+void qmi8658_emul_set_self_test(const struct emul *target, const enum sensor_channel chan,
+                                const int16_t response[3]) {
+    struct qmi8658_emul_data *data = target->data;
+
+    __ASSERT_NO_MSG((chan == SENSOR_CHAN_ACCEL_XYZ) || (chan == SENSOR_CHAN_GYRO_XYZ));
+    memcpy(chan == SENSOR_CHAN_ACCEL_XYZ ? data->st_accel : data->st_gyro, response,
+           3 * sizeof(int16_t));
+}
+
+void qmi8658_emul_get_stats(const struct emul *target, struct qmi8658_emul_stats *stats) {
+    const struct qmi8658_emul_data *data = target->data;
+
+    *stats = data->stats;
+}
+
+void qmi8658_emul_reset_stats(const struct emul *target) {
+    struct qmi8658_emul_data *data = target->data;
+
+    memset(&data->stats, 0, sizeof(data->stats));
+}
+
+static int qmi8658_emul_init(const struct emul *target, const struct device *parent) {
+    struct qmi8658_emul_data *data = target->data;
+
+    ARG_UNUSED(parent);
+
+    // A healthy chip, well above the pass thresholds
+    for (int i = 0; i < 3; i++) {
+        data->st_accel[i] = 2048;
+        data->st_gyro[i] = 16000;
+    }
+
+    qmi8658_emul_reset(data);
+    return 0;
+}
+
+static const struct i2c_emul_api qmi8658_emul_api_i2c = {
+    .transfer = qmi8658_emul_transfer_i2c,
+};
+
+static const struct emul_sensor_driver_api qmi8658_emul_backend_api = {
+    .set_channel = qmi8658_emul_backend_set_channel,
+    .get_sample_range = qmi8658_emul_backend_get_sample_range,
+};
+
+#define QMI8658_EMUL(inst) \
+    static struct qmi8658_emul_data qmi8658_emul_data_##inst; \
+    EMUL_DT_INST_DEFINE(inst, qmi8658_emul_init, &qmi8658_emul_data_##inst, NULL, \
+        &qmi8658_emul_api_i2c, &qmi8658_emul_backend_api);
+
+// Only the I2C interface is emulated
+#define QMI8658_EMUL_ON_I2C(inst) \
+    COND_CODE_1(DT_INST_ON_BUS(inst, i2c), (QMI8658_EMUL(inst)), ())
+
+DT_INST_FOREACH_STATUS_OKAY(QMI8658_EMUL_ON_I2C)
@@ -0,0 +1,138 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/logging/log.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+BUILD_ASSERT(sizeof(struct qmi8658_fifo_frame) == FIFO_FRAME_SIZE,
+             "fifo frame layout must match the chip");
+
+static uint8_t qmi8658_fifo_size_bits(const uint8_t size) {
+    switch (size) {
+        case 16:
+            return BIT_FIFO_SIZE_16;
+        case 32:
+            return BIT_FIFO_SIZE_32;
+        case 64:
+            return BIT_FIFO_SIZE_64;
+        default:
+            return BIT_FIFO_SIZE_128;
+    }
+}
+
+int qmi8658_fifo_set_watermark(const struct device *dev, const uint16_t wm) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+    if ((wm == 0) || (wm > cfg->fifo_size)) {
+        LOG_ERR("Unsupported fifo watermark %u", wm);
+        return -EINVAL;
+    }
+
+    ret = qmi8658_reg_write(cfg, REG_FIFO_WTM_TH, wm);
+    if (ret) {
+        return ret;
+    }
+    data->fifo_wm = wm;
+
+    return 0;
+}
+
+int qmi8658_fifo_init(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+    ret = qmi8658_fifo_set_watermark(dev, cfg->fifo_wm);
+    if (ret) {
+        LOG_ERR("set fifo watermark failed");
+        return ret;
+    }
+
+    // Stream mode keeps the newest samples when the host falls behind
+    data->fifo_ctrl = FIELD_PREP(MASK_FIFO_SIZE, qmi8658_fifo_size_bits(cfg->fifo_size)) |
+                      FIELD_PREP(MASK_FIFO_MODE, BIT_FIFO_MODE_STREAM);
+    ret = qmi8658_reg_write(cfg, REG_FIFO_CTRL, data->fifo_ctrl);
+    if (ret) {
+        LOG_ERR("fifo_ctrl setup failed");
+        return ret;
+    }
+
+    return qmi8658_ctrl9_cmd(dev, CTRL_CMD_RST_FIFO);
+}
+
+int qmi8658_fifo_status(const struct device *dev, uint8_t *status, uint16_t *frames) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t buffer[2];
+    uint16_t words;
+    int ret;
+
+    // FIFO_SMPL_CNT and FIFO_STATUS are adjacent, read both at once
+    ret = qmi8658_reg_read(cfg, REG_FIFO_SMPL_CNT, buffer, sizeof(buffer));
+    if (ret) {
+        LOG_ERR("read fifo status failed");
+        return ret;
+    }
+
+    // The sample count is expressed in 16-bit words
+    words = (FIELD_GET(MASK_FIFO_SMPL_CNT_MSB, buffer[1]) << 8) | buffer[0];
+    *status = buffer[1];
+    *frames = (words * 2) / FIFO_FRAME_SIZE;
+
+    return 0;
+}
+
+int qmi8658_fifo_read(const struct device *dev, struct qmi8658_fifo_frame *frames,
+                      const size_t max_frames) {
+    const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    uint8_t status;
+    uint16_t count;
+    int ret;
+
+    ret = qmi8658_fifo_status(dev, &status, &count);
+    if (ret) {
+        return ret;
+    }
+
+    if (status & BIT_FIFO_OVFLOW) {
+        LOG_WRN("fifo overflow, oldest samples lost");
+    }
+
+    count = MIN(count, max_frames);
+    if (count == 0) {
+        return 0;
+    }
+
+    ret = qmi8658_ctrl9_cmd(dev, CTRL_CMD_REQ_FIFO);
+    if (ret) {
+        return ret;
+    }
+
+    ret = qmi8658_reg_read(cfg, REG_FIFO_DATA, (uint8_t *) frames, count * FIFO_FRAME_SIZE);
+
+    // Leave FIFO read mode even if the transfer failed
+    if (qmi8658_reg_write(cfg, REG_FIFO_CTRL, data->fifo_ctrl) && !ret) {
+        ret = -EIO;
+    }
+    if (ret) {
+        LOG_ERR("read fifo data failed");
+        return ret;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            frames[i].accel[j] = (int16_t) sys_le16_to_cpu(frames[i].accel[j]);
+            frames[i].gyro[j] = (int16_t) sys_le16_to_cpu(frames[i].gyro[j]);
+        }
+    }
+
+    return count;
+}
+
+int qmi8658_fifo_flush(const struct device *dev) {
+    return qmi8658_ctrl9_cmd(dev, CTRL_CMD_RST_FIFO);
+}
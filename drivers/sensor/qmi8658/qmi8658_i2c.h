@@ -0,0 +1,32 @@
+#ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_I2C_H_
+#define ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_I2C_H_
+
+// Included by qmi8658.h, inlined into the callers when I2C is the only bus
+
+#if QMI8658_BUS_I2C
+static inline int qmi8658_bus_check_i2c(const union qmi8658_bus *bus) {
+    return i2c_is_ready_dt(&bus->i2c) ? 0 : -ENODEV;
+}
+
+static inline int qmi8658_bus_init_i2c(const union qmi8658_bus *bus) {
+    ARG_UNUSED(bus);
+
+    return 0;
+}
+
+static inline int qmi8658_reg_read_i2c(const union qmi8658_bus *bus, const uint16_t reg, uint8_t *data,
+                                       const size_t size) {
+    return i2c_write_read_dt(&bus->i2c, &reg, 1, data, size);
+}
+
+static inline int qmi8658_reg_write_i2c(const union qmi8658_bus *bus, const uint16_t reg, const uint8_t data) {
+    return i2c_reg_write_byte_dt(&bus->i2c, reg, data);
+}
+
+static inline int qmi8658_reg_update_i2c(const union qmi8658_bus *bus, const uint16_t reg, const uint8_t mask,
+                                         const uint8_t val) {
+    return i2c_reg_update_byte_dt(&bus->i2c, reg, mask, val);
+}
+#endif /* QMI8658_BUS_I2C */
+
+#endif /* ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_I2C_H_ */
@@ -0,0 +1,404 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/logging/log.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+#define MOTION_EVENT_BITS (BIT_ANY_MOTION_EN | BIT_NO_MOTION_EN | BIT_SIG_MOTION_EN)
+#define ALL_EVENT_BITS (MOTION_EVENT_BITS | BIT_TAP_EN | BIT_PEDO_EN)
+
+// Tap and pedometer tuning that is not exposed as attributes, from the
+// vendor reference settings
+#define TAP_PEAK_WINDOW 20
+#define TAP_PRIORITY 0x05
+#define TAP_ALPHA 8     // U0.7, 0.0625
+#define TAP_GAMMA 32    // U0.7, 0.25
+#define PED_TIME_UP 200
+#define PED_TIME_LOW 20
+#define PED_TIME_CNT_ENTRY 10
+#define PED_FIX_PRECISION 0
+#define PED_SIG_COUNT 4
+
+static const struct qmi8658_motion_cfg qmi8658_motion_defaults = {
+    .any_motion_th = 8,     // 0.25 g
+    .any_motion_win = 1,
+    .no_motion_th = 4,      // 0.125 g
+    .no_motion_win = 100,
+    .sig_motion_wait = 100,
+    .sig_motion_confirm = 200,
+    .tap_th = 1638,         // 0.8 g^2
+    .tap_win = 200,
+    .dtap_win = 500,
+    .step_th = 204,         // 0.1 g
+    .step_win = 50,
+};
+
+// CTRL8 enable bit of each event
+static const uint8_t qmi8658_event_bits[QMI8658_EVENT_COUNT] = {
+    [QMI8658_EVENT_ANY_MOTION] = BIT_ANY_MOTION_EN,
+    [QMI8658_EVENT_NO_MOTION] = BIT_NO_MOTION_EN,
+    [QMI8658_EVENT_SIG_MOTION] = BIT_SIG_MOTION_EN,
+    [QMI8658_EVENT_TAP] = BIT_TAP_EN,
+    [QMI8658_EVENT_DOUBLE_TAP] = BIT_TAP_EN,
+    [QMI8658_EVENT_STEP] = BIT_PEDO_EN,
+};
+
+static int qmi8658_motion_event(const enum sensor_trigger_type type) {
+    switch ((int) type) {
+        case SENSOR_TRIG_MOTION:
+            return QMI8658_EVENT_ANY_MOTION;
+        case SENSOR_TRIG_STATIONARY:
+            return QMI8658_EVENT_NO_MOTION;
+        case QMI8658_TRIG_SIG_MOTION:
+            return QMI8658_EVENT_SIG_MOTION;
+        case SENSOR_TRIG_TAP:
+            return QMI8658_EVENT_TAP;
+        case SENSOR_TRIG_DOUBLE_TAP:
+            return QMI8658_EVENT_DOUBLE_TAP;
+        case QMI8658_TRIG_STEP:
+            return QMI8658_EVENT_STEP;
+        default:
+            return -ENOTSUP;
+    }
+}
+
+// CTRL8 bits of the detectors sharing one configure command
+static uint8_t qmi8658_motion_group(const uint8_t cmd) {
+    switch (cmd) {
+        case CTRL_CMD_CONFIGURE_MOTION:
+            return MOTION_EVENT_BITS;
+        case CTRL_CMD_CONFIGURE_TAP:
+            return BIT_TAP_EN;
+        default:
+            return BIT_PEDO_EN;
+    }
+}
+
+static uint8_t qmi8658_motion_cmd(const uint8_t bits) {
+    if (bits & MOTION_EVENT_BITS) {
+        return CTRL_CMD_CONFIGURE_MOTION;
+    }
+    if (bits & BIT_TAP_EN) {
+        return CTRL_CMD_CONFIGURE_TAP;
+    }
+    return CTRL_CMD_CONFIGURE_PEDOMETER;
+}
+
+static uint8_t qmi8658_motion_enabled(const struct qmi8658_data *data) {
+    uint8_t bits = 0;
+
+    for (int i = 0; i < QMI8658_EVENT_COUNT; i++) {
+        if (data->events[i].handler != NULL) {
+            bits |= qmi8658_event_bits[i];
+        }
+    }
+
+    return bits;
+}
+
+// Each configure command takes two argument blocks
+static int qmi8658_motion_configure(const struct device *dev, const uint8_t cmd) {
+    const struct qmi8658_data *data = dev->data;
+    const struct qmi8658_motion_cfg *m = &data->motion;
+    uint8_t part1[CTRL9_ARGS_SIZE], part2[CTRL9_ARGS_SIZE];
+    int ret;
+
+    switch (cmd) {
+        case CTRL_CMD_CONFIGURE_MOTION:
+            // Any motion on any axis, no motion only when all axes are still
+            part1[0] = m->any_motion_th;
+            part1[1] = m->any_motion_th;
+            part1[2] = m->any_motion_th;
+            part1[3] = m->no_motion_th;
+            part1[4] = m->no_motion_th;
+            part1[5] = m->no_motion_th;
+            part1[6] = FIELD_PREP(MASK_NO_MOTION_AXES, 0x7) | BIT_NO_MOTION_LOGIC_AND |
+                       FIELD_PREP(MASK_ANY_MOTION_AXES, 0x7);
+            part2[0] = m->any_motion_win;
+            part2[1] = m->no_motion_win;
+            sys_put_le16(m->sig_motion_wait, &part2[2]);
+            sys_put_le16(m->sig_motion_confirm, &part2[4]);
+            part2[6] = 0;
+            break;
+        case CTRL_CMD_CONFIGURE_TAP:
+            part1[0] = TAP_PEAK_WINDOW;
+            part1[1] = TAP_PRIORITY;
+            sys_put_le16(m->tap_win, &part1[2]);
+            sys_put_le16(m->dtap_win, &part1[4]);
+            part1[6] = 0;
+            part2[0] = TAP_ALPHA;
+            part2[1] = TAP_GAMMA;
+            sys_put_le16(m->tap_th, &part2[2]);
+            // Undefined motion rejection at half the peak threshold
+            sys_put_le16(m->tap_th / 2, &part2[4]);
+            part2[6] = 0;
+            break;
+        default:
+            sys_put_le16(m->step_win, &part1[0]);
+            sys_put_le16(m->step_th, &part1[2]);
+            sys_put_le16(m->step_th / 2, &part1[4]);
+            part1[6] = 0;
+            sys_put_le16(PED_TIME_UP, &part2[0]);
+            part2[2] = PED_TIME_LOW;
+            part2[3] = PED_TIME_CNT_ENTRY;
+            part2[4] = PED_FIX_PRECISION;
+            part2[5] = PED_SIG_COUNT;
+            part2[6] = 0;
+            break;
+    }
+    part1[7] = CTRL9_ARGS_PART1;
+    part2[7] = CTRL9_ARGS_PART2;
+
+    ret = qmi8658_ctrl9_cmd_args(dev, cmd, part1);
+    if (ret) {
+        LOG_ERR("ctrl9 command 0x%02X part 1 failed", cmd);
+        return ret;
+    }
+
+    ret = qmi8658_ctrl9_cmd_args(dev, cmd, part2);
+    if (ret) {
+        LOG_ERR("ctrl9 command 0x%02X part 2 failed", cmd);
+    }
+
+    return ret;
+}
+
+// Settings only reach the chip through a configure command, reissue it when
+// the affected detectors are running
+static int qmi8658_motion_reconfigure(const struct device *dev, const uint8_t cmd) {
+    const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    const uint8_t group = qmi8658_motion_group(cmd);
+    const uint8_t enabled = qmi8658_motion_enabled(data) & group;
+    int ret;
+
+    if (!enabled) {
+        return 0;
+    }
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL8, group, 0);
+    if (ret) {
+        return ret;
+    }
+
+    ret = qmi8658_motion_configure(dev, cmd);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_reg_update(cfg, REG_CTRL8, group, enabled);
+}
+
+static int qmi8658_ms2_to_u5_11(const struct sensor_value *val, uint16_t *out) {
+    const int64_t micro = sensor_value_to_micro(val);
+    const int64_t q11 = (micro * 2048 + SENSOR_G / 2) / SENSOR_G;
+
+    if ((micro < 0) || (q11 > UINT16_MAX)) {
+        return -EINVAL;
+    }
+
+    *out = q11;
+    return 0;
+}
+
+static int qmi8658_ms2_to_u3_5(const struct sensor_value *val, uint8_t *out) {
+    const int64_t micro = sensor_value_to_micro(val);
+    const int64_t q5 = (micro * 32 + SENSOR_G / 2) / SENSOR_G;
+
+    if ((micro < 0) || (q5 > UINT8_MAX)) {
+        return -EINVAL;
+    }
+
+    *out = q5;
+    return 0;
+}
+
+static int qmi8658_window(const struct sensor_value *val, const int32_t max, uint16_t *out) {
+    if ((val->val1 < 0) || (val->val1 > max)) {
+        return -EINVAL;
+    }
+
+    *out = val->val1;
+    return 0;
+}
+
+int qmi8658_motion_attr_set(const struct device *dev, const enum sensor_attribute attr,
+                            const struct sensor_value *val) {
+    struct qmi8658_data *data = dev->data;
+    struct qmi8658_motion_cfg *m = &data->motion;
+    uint16_t tmp = 0;
+    uint8_t cmd;
+    int ret;
+
+    switch ((int) attr) {
+        case SENSOR_ATTR_SLOPE_TH:
+            ret = qmi8658_ms2_to_u3_5(val, &m->any_motion_th);
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case SENSOR_ATTR_SLOPE_DUR:
+            ret = qmi8658_window(val, UINT8_MAX, &tmp);
+            m->any_motion_win = ret ? m->any_motion_win : tmp;
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case QMI8658_ATTR_NO_MOTION_TH:
+            ret = qmi8658_ms2_to_u3_5(val, &m->no_motion_th);
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case QMI8658_ATTR_NO_MOTION_DUR:
+            ret = qmi8658_window(val, UINT8_MAX, &tmp);
+            m->no_motion_win = ret ? m->no_motion_win : tmp;
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case QMI8658_ATTR_SIG_MOTION_WAIT:
+            ret = qmi8658_window(val, UINT16_MAX, &m->sig_motion_wait);
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case QMI8658_ATTR_SIG_MOTION_CONFIRM:
+            ret = qmi8658_window(val, UINT16_MAX, &m->sig_motion_confirm);
+            cmd = CTRL_CMD_CONFIGURE_MOTION;
+            break;
+        case QMI8658_ATTR_TAP_TH:
+            // The chip compares the squared magnitude, U5.11 g^2
+            ret = qmi8658_ms2_to_u5_11(val, &tmp);
+            if (!ret && (((uint32_t) tmp * tmp) >> 11) > UINT16_MAX) {
+                ret = -EINVAL;
+            }
+            m->tap_th = ret ? m->tap_th : ((uint32_t) tmp * tmp) >> 11;
+            cmd = CTRL_CMD_CONFIGURE_TAP;
+            break;
+        case QMI8658_ATTR_TAP_WINDOW:
+            ret = qmi8658_window(val, UINT16_MAX, &m->tap_win);
+            cmd = CTRL_CMD_CONFIGURE_TAP;
+            break;
+        case QMI8658_ATTR_DOUBLE_TAP_WINDOW:
+            ret = qmi8658_window(val, UINT16_MAX, &m->dtap_win);
+            cmd = CTRL_CMD_CONFIGURE_TAP;
+            break;
+        case QMI8658_ATTR_STEP_TH:
+            ret = qmi8658_ms2_to_u5_11(val, &m->step_th);
+            cmd = CTRL_CMD_CONFIGURE_PEDOMETER;
+            break;
+        case QMI8658_ATTR_STEP_WINDOW:
+            ret = qmi8658_window(val, UINT16_MAX, &m->step_win);
+            cmd = CTRL_CMD_CONFIGURE_PEDOMETER;
+            break;
+        default:
+            LOG_ERR("Unsupported attribute %d", attr);
+            return -ENOTSUP;
+    }
+
+    if (ret) {
+        LOG_ERR("Invalid value for attribute %d", attr);
+        return ret;
+    }
+
+    return qmi8658_motion_reconfigure(dev, cmd);
+}
+
+int qmi8658_motion_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                               const sensor_trigger_handler_t handler) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    const int event = qmi8658_motion_event(trig->type);
+    sensor_trigger_handler_t old_handler;
+    const struct sensor_trigger *old_trigger;
+    uint8_t before, after, started;
+    int ret;
+
+    if (event < 0) {
+        LOG_ERR("Unsupported trigger %d", trig->type);
+        return -ENOTSUP;
+    }
+
+    before = qmi8658_motion_enabled(data);
+    old_handler = data->events[event].handler;
+    old_trigger = data->events[event].trigger;
+    data->events[event].handler = handler;
+    data->events[event].trigger = trig;
+    after = qmi8658_motion_enabled(data);
+
+    // Configure a detector group when its first detector starts
+    started = after & ~before;
+    if (started && !(before & qmi8658_motion_group(qmi8658_motion_cmd(started)))) {
+        ret = qmi8658_motion_configure(dev, qmi8658_motion_cmd(started));
+        if (ret) {
+            // Keep a previously registered trigger working
+            data->events[event].handler = old_handler;
+            data->events[event].trigger = old_trigger;
+            return ret;
+        }
+    }
+
+    return qmi8658_reg_update(cfg, REG_CTRL8, ALL_EVENT_BITS, after);
+}
+
+static void qmi8658_motion_report(const struct device *dev, const enum qmi8658_event event) {
+    const struct qmi8658_data *data = dev->data;
+
+    if (data->events[event].handler != NULL) {
+        data->events[event].handler(dev, data->events[event].trigger);
+    }
+}
+
+bool qmi8658_motion_is_enabled(const struct device *dev) {
+    return qmi8658_motion_enabled(dev->data) != 0;
+}
+
+void qmi8658_motion_handle_interrupt(const struct device *dev, const uint8_t status) {
+    const struct qmi8658_config *cfg = dev->config;
+    uint8_t tap;
+
+    if (status & BIT_ANY_MOTION) {
+        qmi8658_motion_report(dev, QMI8658_EVENT_ANY_MOTION);
+    }
+    if (status & BIT_NO_MOTION) {
+        qmi8658_motion_report(dev, QMI8658_EVENT_NO_MOTION);
+    }
+    if (status & BIT_SIG_MOTION) {
+        qmi8658_motion_report(dev, QMI8658_EVENT_SIG_MOTION);
+    }
+    if ((status & BIT_TAP) && !qmi8658_reg_read(cfg, REG_TAP_STATUS, &tap, 1)) {
+        if (FIELD_GET(MASK_TAP_TYPE, tap) == BIT_TAP_DOUBLE) {
+            qmi8658_motion_report(dev, QMI8658_EVENT_DOUBLE_TAP);
+        } else {
+            qmi8658_motion_report(dev, QMI8658_EVENT_TAP);
+        }
+    }
+    if (status & BIT_PEDOMETER) {
+        qmi8658_motion_report(dev, QMI8658_EVENT_STEP);
+    }
+}
+
+int qmi8658_motion_fetch_steps(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t buffer[3];
+    int ret;
+
+    ret = qmi8658_reg_read(cfg, REG_STEP_CNT_LOW, buffer, sizeof(buffer));
+    if (ret) {
+        LOG_ERR("read step count failed");
+        return ret;
+    }
+    data->step_count = sys_get_le24(buffer);
+
+    return 0;
+}
+
+int qmi8658_motion_init(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+
+    data->motion = qmi8658_motion_defaults;
+
+    if (cfg->int_gpio.port == NULL) {
+        return 0;
+    }
+
+    // Detectors are configured when their first trigger is installed, only
+    // route their interrupt to the pin int-gpios is wired to
+    return qmi8658_reg_update(cfg, REG_CTRL8, BIT_ACTIVITY_INT_SEL,
+                              cfg->int_pin == 1 ? BIT_ACTIVITY_INT_SEL : 0);
+}
@@ -32,11 +32,21 @@
 #define REG_CAL4_L 0x11     // calibration 4 register, lower bits
 #define REG_CAL4_H 0x12     // calibration 4 register, higher bits
 
+#define REG_FIFO_WTM_TH 0x13    // FIFO watermark level, in ODRs
+#define REG_FIFO_CTRL 0x14      // FIFO control register
+#define REG_FIFO_SMPL_CNT 0x15  // FIFO sample count LSBs
+#define REG_FIFO_STATUS 0x16    // FIFO status indicator
+#define REG_FIFO_DATA 0x17      // FIFO data
+
 #define REG_STATUS_INT 0x2D // status + interrupt register
 #define REG_STATUS0 0x2E     // Output Data Over Run and Data Availability.
 #define REG_STATUS1 0x2F     // Miscellaneous Status: Any Motion, No Motion,
 // Significant Motion, Pedometer, Tap.
 
+#define REG_TIMESTAMP_L 0x30 // sample time stamp, counts samples, 24 bits
+#define REG_TIMESTAMP_M 0x31
+#define REG_TIMESTAMP_H 0x32
+
 #define REG_TEMP_L 0x33     // lower bits of temperature data
 #define REG_TEMP_H 0x34     // upper bits of temperature data
 
@@ -54,15 +64,49 @@
 #define REG_GZ_L 0x3F
 #define REG_GZ_H 0x40
 
+#define REG_COD_STATUS 0x46 // on-demand calibration result, 0 on success
+
+#define REG_DQW_L 0x49      // AttitudeEngine delta quaternion, w/x/y/z
+#define REG_DQW_H 0x4A
+#define REG_DQX_L 0x4B
+#define REG_DQX_H 0x4C
+#define REG_DQY_L 0x4D
+#define REG_RESET_STATUS REG_DQY_L // reads RESET_STATUS_DONE once a reset has completed
+#define REG_DQY_H 0x4E
+#define REG_DQZ_L 0x4F
+#define REG_DQZ_H 0x50
+
+#define REG_DVX_L 0x51      // AttitudeEngine delta velocity, x/y/z
+#define REG_DVX_H 0x52
+#define REG_DVY_L 0x53
+#define REG_DVY_H 0x54
+#define REG_DVZ_L 0x55
+#define REG_DVZ_H 0x56
+
+#define REG_AE_REG1 0x57    // AttitudeEngine clipping flags
+#define REG_AE_REG2 0x58    // AttitudeEngine overflow flags
+
+#define REG_TAP_STATUS 0x59     // axis, polarity and count of the last tap
+#define REG_STEP_CNT_LOW 0x5A   // step count, bits 7:0
+#define REG_STEP_CNT_MID 0x5B   // step count, bits 15:8
+#define REG_STEP_CNT_HIGH 0x5C  // step count, bits 23:16
+
 #define REG_SOFT_RESET 0x60 // soft reset register
 
+// SPI address byte, bit 7 selects a read access
+#define SPI_READ_BIT BIT(7)
+
 // REG_CTRL1
 #define BIT_SIM   BIT(7)    // 0: Enables 4-wire SPI interface, 1: Enables 3-wire SPI interface
 #define BIT_ADDR_AI BIT(6)  // Address auto increment, 0: Disable, 1: Enable
 #define BIT_BE    BIT(5)    // Big/little endian data selection, 0: Little-Endian, 1: Big-Endian
+#define BIT_INT2_EN BIT(4)  // INT2 pin output enable
+#define BIT_INT1_EN BIT(3)  // INT1 pin output enable
+#define BIT_FIFO_INT_SEL BIT(2) // FIFO interrupt mapping, 0: INT2, 1: INT1
 #define BIT_OSC_DIS BIT(0)   // Internal oscillator disable bit
 
 // REG_CTRL2
+#define BIT_ACCEL_ST BIT(7) // Accel self-test, result in dVX..dVZ
 #define MASK_ACCEL_FS GENMASK(6,4)
 #define BIT_ACCEL_FS_2G  0x00
 #define BIT_ACCEL_FS_4G  0x01
@@ -82,7 +126,14 @@
 #define BIT_ACCEL_ODR_50HZ   0x07
 #define BIT_ACCEL_ODR_25HZ   0x08
 
+// Accel-only low power ODRs, only valid while the gyro is disabled
+#define BIT_ACCEL_ODR_LP_128HZ 0x0C
+#define BIT_ACCEL_ODR_LP_21HZ  0x0D
+#define BIT_ACCEL_ODR_LP_11HZ  0x0E
+#define BIT_ACCEL_ODR_LP_3HZ   0x0F
+
 // REG_CTRL3
+#define BIT_GYRO_ST BIT(7) // Gyro self-test, result in dVX..dVZ
 #define MASK_GYRO_FS GENMASK(6,4)
 #define BIT_GYRO_FS_16DPS 0x00
 #define BIT_GYRO_FS_32DPS 0x01
@@ -122,10 +173,23 @@
 #define BIT_ALPF_EN BIT(0) // Acc low pass filter enable bit
 
 
+// REG_CTRL6, AttitudeEngine Settings. Register Address: 7 (0x07)
+#define BIT_SMOD BIT(7) // Motion on demand, requires AttitudeEngine enabled
+#define MASK_AE_ODR GENMASK(2,0)
+#define BIT_AE_ODR_1HZ  0x00
+#define BIT_AE_ODR_2HZ  0x01
+#define BIT_AE_ODR_4HZ  0x02
+#define BIT_AE_ODR_8HZ  0x03
+#define BIT_AE_ODR_16HZ 0x04
+#define BIT_AE_ODR_32HZ 0x05
+#define BIT_AE_ODR_64HZ 0x06
+
 // REG_CTRL7, Sensor Enable Control. Register Address: 8 (0x08)
 #define BIT_GEN BIT(1) // Gyro sensor enable bit
 #define BIT_AEN BIT(0) // Acc sensor enable bit
+#define BIT_SEN BIT(3) // AttitudeEngine orientation and velocity increment enable bit
 #define BIT_SYNC_SAMPLE_EN BIT(7) // Synchronized sample enable bit
+#define BIT_DRDY_DIS BIT(5) // Disable data ready interrupt on INT2
 
 // 0: Gyroscope in Full Mode (Drive and Sense are enabled).
 // 1: Gyroscope in Snooze Mode (only Drive enabled).
@@ -138,16 +202,73 @@
 #define BIT_NO_MOTION_EN BIT(2) // No motion detection function enable bit
 #define BIT_ANY_MOTION_EN BIT(1) // Any motion detection function enable bit
 #define BIT_TAP_EN BIT(0) // Tap detection function enable bit
+#define BIT_CTRL9_HANDSHAKE BIT(7) // CTRL9 handshake, 0: INT1, 1: STATUS_INT.bit7
+
+// REG_CTRL9, host commands
+#define CTRL_CMD_ACK 0x00
+#define CTRL_CMD_RST_FIFO 0x04
+#define CTRL_CMD_REQ_FIFO 0x05
+#define CTRL_CMD_WRITE_WOM_SETTING 0x08
+#define CTRL_CMD_ACCEL_HOST_DELTA_OFFSET 0x09
+#define CTRL_CMD_GYRO_HOST_DELTA_OFFSET 0x0A
+#define CTRL_CMD_CONFIGURE_TAP 0x0C
+#define CTRL_CMD_CONFIGURE_PEDOMETER 0x0D
+#define CTRL_CMD_CONFIGURE_MOTION 0x0E
+#define CTRL_CMD_RESET_PEDOMETER 0x0F
+#define CTRL_CMD_ON_DEMAND_CALIBRATION 0xA2
+#define CTRL_CMD_APPLY_GYRO_GAINS 0xAA
+
+// CTRL9 command arguments are passed in CAL1_L..CAL4_H, CAL4_H selects the
+// part of multi-part configuration commands
+#define CTRL9_ARGS_SIZE 8
+#define CTRL9_ARGS_PART1 0x01
+#define CTRL9_ARGS_PART2 0x02
+
+// CTRL_CMD_CONFIGURE_MOTION, MOTION_MODE_CTRL argument
+#define BIT_NO_MOTION_LOGIC_AND BIT(7)
+#define MASK_NO_MOTION_AXES GENMASK(6,4)
+#define BIT_ANY_MOTION_LOGIC_AND BIT(3)
+#define MASK_ANY_MOTION_AXES GENMASK(2,0)
+
+// CTRL_CMD_WRITE_WOM_SETTING, CAL1_L holds the threshold in mg (0 disables
+// WoM), CAL1_H the output pin, its initial level and the blanking time
+#define BIT_WOM_INT_HIGH BIT(7)
+#define BIT_WOM_INT2 BIT(6)
+#define MASK_WOM_BLANKING GENMASK(5,0)
+
+// REG_FIFO_CTRL
+#define BIT_FIFO_RD_MODE BIT(7) // Set by CTRL_CMD_REQ_FIFO, cleared by host after reading
+#define MASK_FIFO_SIZE GENMASK(3,2)
+#define BIT_FIFO_SIZE_16  0x00
+#define BIT_FIFO_SIZE_32  0x01
+#define BIT_FIFO_SIZE_64  0x02
+#define BIT_FIFO_SIZE_128 0x03
+
+#define MASK_FIFO_MODE GENMASK(1,0)
+#define BIT_FIFO_MODE_BYPASS 0x00
+#define BIT_FIFO_MODE_FIFO   0x01
+#define BIT_FIFO_MODE_STREAM 0x02
+
+// REG_FIFO_STATUS
+#define BIT_FIFO_FULL BIT(7)
+#define BIT_FIFO_WTM BIT(6)
+#define BIT_FIFO_OVFLOW BIT(5)
+#define BIT_FIFO_NOT_EMPTY BIT(4)
+#define MASK_FIFO_SMPL_CNT_MSB GENMASK(1,0)
 
 // REG_STATUS_INT
+#define BIT_CMD_DONE BIT(7) // CTRL9 command done
 // If syncSmpl (CTRL7.bit7) = 1:
 // 0: Sensor Data is not available, 1: Sensor Data is available for reading
 // If syncSmpl = 0, this bit shows the same value of INT2 level
 #define BIT_AVAIL  BIT(0)
+// If syncSmpl = 1: sensor data is locked until the host has read it
+#define BIT_LOCKED BIT(1)
 
 // REG_STATUS0
-#define BIT_GDA BIT(1)  // new accel data available
-#define BIT_ADA BIT(0)  // new gyro data available
+#define BIT_SDA BIT(3)  // new AttitudeEngine data available
+#define BIT_GDA BIT(1)  // new gyro data available
+#define BIT_ADA BIT(0)  // new accel data available
 
 // REG_STATUS1
 #define BIT_SIG_MOTION BIT(7)
@@ -157,6 +278,11 @@
 #define BIT_WOM BIT(2)
 #define BIT_TAP BIT(1)
 
+// REG_TAP_STATUS
+#define MASK_TAP_TYPE GENMASK(1,0)
+#define BIT_TAP_SINGLE 0x01
+#define BIT_TAP_DOUBLE 0x02
+
 // REG_RESET
 #define BIT_SOFT_RESET 0xB0
 
@@ -164,10 +290,41 @@
 #define ACCEL_DATA_SIZE 6
 #define GYRO_DATA_SIZE 6
 #define TEMP_DATA_SZE 2
-
-// Sensitivity shift const value
-#define ACCEL_SENSITIVITY_SHIFT 14
-// Gyro sensitivity shift value
-#define GYRO_SENSITIVITY_SHIFT 11
+// STATUS0..GZ_H, one sample with its data ready flags
+#define FETCH_DATA_SIZE (REG_GZ_H - REG_STATUS0 + 1)
+#define TIMESTAMP_DATA_SIZE 3
+#define MASK_TIMESTAMP GENMASK(23, 0)
+// TIMESTAMP_L..GZ_H, everything latched together in syncSample mode
+#define SYNC_DATA_SIZE (TIMESTAMP_DATA_SIZE + TEMP_DATA_SZE + ACCEL_DATA_SIZE + GYRO_DATA_SIZE)
+#define FIFO_FRAME_SIZE (ACCEL_DATA_SIZE + GYRO_DATA_SIZE)
+#define AE_DATA_SIZE 14 // dQW..dQZ followed by dVX..dVZ
+
+// Delta quaternion components are fixed point, 1.0 = 2^14
+#define AE_DQ_SHIFT 14
+
+// CTRL9 handshake polling
+#define CTRL9_POLL_US 100
+#define CTRL9_POLL_RETRIES 50
+
+// Slow CTRL9 commands, on-demand calibration takes about 1.5 s
+#define CTRL9_SLOW_POLL_MS 10
+#define CTRL9_SLOW_POLL_RETRIES 300
+
+// Host delta offsets: accel in signed 4.12 g, gyro in signed 11.5 dps
+#define CAL_ACCEL_OFFSET_SHIFT 12
+#define CAL_GYRO_OFFSET_SHIFT 5
+
+// Soft reset completion, polled with the bring-up steps. The datasheet
+// allows up to 15 ms, the budget covers power-up as well.
+#define RESET_STATUS_DONE 0x80
+#define INIT_POLL_MS 1
+#define INIT_POLL_RETRIES 50
+
+// Self-test, results in dVX..dVZ pass above 200 mg (U5.11 g) and
+// 300 dps (12.4 dps) on every axis
+#define SELF_TEST_POLL_MS 10
+#define SELF_TEST_POLL_RETRIES 50
+#define SELF_TEST_ACCEL_MIN 410
+#define SELF_TEST_GYRO_MIN 4800
 
 #endif //ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_REG_H_
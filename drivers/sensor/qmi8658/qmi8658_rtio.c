@@ -0,0 +1,101 @@
+#include "qmi8658.h"
+#include "qmi8658_decoder.h"
+#include "qmi8658_reg.h"
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/rtio/work.h>
+#include <zephyr/sys/byteorder.h>
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+static bool qmi8658_is_supported_channel(const struct sensor_chan_spec chan) {
+    switch (chan.chan_type) {
+        case SENSOR_CHAN_ALL:
+        case SENSOR_CHAN_ACCEL_XYZ:
+        case SENSOR_CHAN_ACCEL_X:
+        case SENSOR_CHAN_ACCEL_Y:
+        case SENSOR_CHAN_ACCEL_Z:
+        case SENSOR_CHAN_GYRO_XYZ:
+        case SENSOR_CHAN_GYRO_X:
+        case SENSOR_CHAN_GYRO_Y:
+        case SENSOR_CHAN_GYRO_Z:
+            return chan.chan_idx == 0;
+        default:
+            return false;
+    }
+}
+
+static void qmi8658_submit_sync(struct rtio_iodev_sqe *iodev_sqe) {
+    const struct sensor_read_config *read_cfg = iodev_sqe->sqe.iodev->data;
+    const struct device *dev = read_cfg->sensor;
+    const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    struct qmi8658_encoded_data *edata;
+    uint32_t buf_len;
+    uint8_t *buf;
+    int ret;
+
+    ret = qmi8658_check_ready(dev);
+    if (ret) {
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return;
+    }
+
+    for (size_t i = 0; i < read_cfg->count; i++) {
+        if (!qmi8658_is_supported_channel(read_cfg->channels[i])) {
+            LOG_ERR("Unsupported channel %d", read_cfg->channels[i].chan_type);
+            rtio_iodev_sqe_err(iodev_sqe, -ENOTSUP);
+            return;
+        }
+    }
+
+    ret = rtio_sqe_rx_buf(iodev_sqe, sizeof(*edata), sizeof(*edata), &buf, &buf_len);
+    if (ret) {
+        LOG_ERR("Failed to get a read buffer of size %zu bytes", sizeof(*edata));
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return;
+    }
+
+    edata = (struct qmi8658_encoded_data *) buf;
+    edata->header.accel_range = data->accel_range;
+    edata->header.gyro_range = data->gyro_range;
+
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+    int16_t temp;
+
+    // The sample time is the latch time estimated from the chip counter. The
+    // decoder expects the raw little-endian registers, swap the samples back.
+    ARG_UNUSED(cfg);
+    ret = qmi8658_sync_read(dev, edata->readings, &temp, &edata->header.timestamp);
+    for (int i = 0; i < ARRAY_SIZE(edata->readings); i++) {
+        edata->readings[i] = (int16_t) sys_cpu_to_le16(edata->readings[i]);
+    }
+#else
+    edata->header.timestamp = k_ticks_to_ns_floor64(k_uptime_ticks());
+
+    // Accel and gyro registers are contiguous, fetch both in one transfer
+    ret = qmi8658_reg_read(cfg, REG_AX_L, (uint8_t *) edata->readings,
+                           sizeof(edata->readings));
+#endif
+    if (ret) {
+        LOG_ERR("read sensor data failed");
+        rtio_iodev_sqe_err(iodev_sqe, ret);
+        return;
+    }
+
+    rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+void qmi8658_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe) {
+    struct rtio_work_req *req = rtio_work_req_alloc();
+
+    ARG_UNUSED(dev);
+
+    if (req == NULL) {
+        LOG_ERR("RTIO work item allocation failed, consider increasing "
+                "CONFIG_RTIO_WORKQ_POOL_ITEMS");
+        rtio_iodev_sqe_err(iodev_sqe, -ENOMEM);
+        return;
+    }
+
+    rtio_work_req_submit(req, iodev_sqe, qmi8658_submit_sync);
+}
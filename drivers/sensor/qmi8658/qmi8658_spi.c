@@ -0,0 +1,12 @@
+#include "qmi8658.h"
+
+// Only dispatched through when instances sit on both bus types
+#if QMI8658_BUS_MIXED
+const struct qmi8658_bus_io qmi8658_bus_io_spi = {
+    .check = qmi8658_bus_check_spi,
+    .init = qmi8658_bus_init_spi,
+    .read = qmi8658_reg_read_spi,
+    .write = qmi8658_reg_write_spi,
+    .update = qmi8658_reg_update_spi,
+};
+#endif /* QMI8658_BUS_MIXED */
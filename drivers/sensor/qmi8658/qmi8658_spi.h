@@ -0,0 +1,77 @@
+#ifndef ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_SPI_H_
+#define ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_SPI_H_
+
+// Included by qmi8658.h, inlined into the callers when SPI is the only bus
+
+#include "qmi8658_reg.h"
+
+#if QMI8658_BUS_SPI
+static inline int qmi8658_bus_check_spi(const union qmi8658_bus *bus) {
+    return spi_is_ready_dt(&bus->spi) ? 0 : -ENODEV;
+}
+
+static inline int qmi8658_bus_init_spi(const union qmi8658_bus *bus) {
+    uint8_t ctrl1 = BIT_ADDR_AI;
+
+    // SIM must be set before the first read when SDO is not wired.
+    // This is a plain write as no register can be read back yet.
+    if (bus->spi.config.operation & SPI_HALF_DUPLEX) {
+        ctrl1 |= BIT_SIM;
+    }
+
+    const uint8_t cmd[] = {REG_CTRL1, ctrl1};
+    const struct spi_buf tx_buf = {.buf = (void *) cmd, .len = sizeof(cmd)};
+    const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+
+    return spi_write_dt(&bus->spi, &tx);
+}
+
+static inline int qmi8658_reg_read_spi(const union qmi8658_bus *bus, const uint16_t reg, uint8_t *data,
+                                       const size_t size) {
+    // Address auto increment turns this into a single burst transfer
+    const uint8_t addr = (uint8_t) reg | SPI_READ_BIT;
+    const struct spi_buf tx_buf = {.buf = (void *) &addr, .len = 1};
+    const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+    const struct spi_buf rx_buf[2] = {
+        {.buf = NULL, .len = 1},
+        {.buf = data, .len = size},
+    };
+    // In full duplex the first rx byte is clocked in while the address goes
+    // out and is skipped. In 3-wire mode the rx phase follows the tx phase,
+    // so the data starts with the first rx byte.
+    const struct spi_buf_set rx = (bus->spi.config.operation & SPI_HALF_DUPLEX)
+                                      ? (struct spi_buf_set){.buffers = &rx_buf[1], .count = 1}
+                                      : (struct spi_buf_set){.buffers = rx_buf, .count = 2};
+
+    return spi_transceive_dt(&bus->spi, &tx, &rx);
+}
+
+static inline int qmi8658_reg_write_spi(const union qmi8658_bus *bus, const uint16_t reg, const uint8_t data) {
+    const uint8_t cmd[] = {(uint8_t) reg & ~SPI_READ_BIT, data};
+    const struct spi_buf tx_buf = {.buf = (void *) cmd, .len = sizeof(cmd)};
+    const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+
+    return spi_write_dt(&bus->spi, &tx);
+}
+
+static inline int qmi8658_reg_update_spi(const union qmi8658_bus *bus, const uint16_t reg, const uint8_t mask,
+                                         const uint8_t val) {
+    uint8_t old_val;
+    uint8_t new_val;
+    int ret;
+
+    ret = qmi8658_reg_read_spi(bus, reg, &old_val, 1);
+    if (ret) {
+        return ret;
+    }
+
+    new_val = (old_val & ~mask) | (val & mask);
+    if (new_val == old_val) {
+        return 0;
+    }
+
+    return qmi8658_reg_write_spi(bus, reg, new_val);
+}
+#endif /* QMI8658_BUS_SPI */
+
+#endif /* ZEPHYR_DRIVERS_SENSOR_QMI8658_QMI8658_SPI_H_ */
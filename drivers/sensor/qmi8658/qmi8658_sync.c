@@ -0,0 +1,141 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/logging/log.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zephyr/sys/byteorder.h"
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+// Loop gains of the counter to host clock tracking, as right shifts of the error
+#define QMI8658_SYNC_PHASE_SHIFT 4
+#define QMI8658_SYNC_PERIOD_SHIFT 8
+
+// The counter advances once per sample at the rate of the leading sensor
+static uint16_t qmi8658_sync_rate(const struct qmi8658_data *data) {
+    if (data->gyro_mode == QMI8658_POWER_NORMAL) {
+        return data->gyro_hz;
+    }
+    return data->accel_mode == QMI8658_POWER_LOW ? data->accel_lp_hz : data->accel_hz;
+}
+
+static void qmi8658_sync_restart(struct qmi8658_sync_clock *clk, const uint16_t hz,
+                                 const uint32_t count, const uint64_t now) {
+    clk->hz = hz;
+    clk->period_q8 = ((int64_t) NSEC_PER_SEC << 8) / hz;
+    clk->count = count;
+    clk->sample_ns = now;
+}
+
+// Predict the sample time from the counter and the tracked period, then pull
+// the prediction and the period towards the host clock. A sample is never
+// placed after the moment it was seen.
+static void qmi8658_sync_track(struct qmi8658_data *data, const uint32_t count,
+                               const uint64_t now) {
+    struct qmi8658_sync_clock *clk = &data->sync;
+    const uint16_t hz = qmi8658_sync_rate(data);
+    uint32_t delta;
+    int64_t predicted, err;
+
+    if (clk->hz != hz) {
+        qmi8658_sync_restart(clk, hz, count, now);
+        return;
+    }
+
+    delta = (count - clk->count) & MASK_TIMESTAMP;
+    if (delta == 0) {
+        return;
+    }
+
+    // Beyond half the counter range the wrap count is ambiguous
+    if ((now - clk->sample_ns) > (uint64_t) ((MASK_TIMESTAMP / 2) * clk->period_q8 >> 8)) {
+        qmi8658_sync_restart(clk, hz, count, now);
+        return;
+    }
+
+    predicted = clk->sample_ns + ((delta * clk->period_q8) >> 8);
+    err = (int64_t) now - predicted;
+
+    // Clock drift is a few percent at most, anything larger means the counter
+    // restarted, for instance after a reset or a mode change
+    if (llabs(err) > (((delta * clk->period_q8) >> 9) + (clk->period_q8 >> 8))) {
+        qmi8658_sync_restart(clk, hz, count, now);
+        return;
+    }
+
+    clk->period_q8 += (err << 8) / ((int64_t) delta << QMI8658_SYNC_PERIOD_SHIFT);
+    clk->count = count;
+    clk->sample_ns = MIN(predicted + (err >> QMI8658_SYNC_PHASE_SHIFT), now);
+}
+
+int qmi8658_sync_read(const struct device *dev, int16_t *samples, int16_t *temp,
+                      uint64_t *timestamp) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t buf[SYNC_DATA_SIZE];
+    uint8_t status;
+    uint64_t now;
+    int ret;
+
+    ret = qmi8658_reg_read(cfg, REG_STATUS_INT, &status, 1);
+    if (ret) {
+        LOG_ERR("read status failed");
+        return ret;
+    }
+    if ((status & (BIT_AVAIL | BIT_LOCKED)) != (BIT_AVAIL | BIT_LOCKED)) {
+        return -EBUSY;
+    }
+
+    // Taken as close to the latch as the bus allows
+    now = k_ticks_to_ns_floor64(k_uptime_ticks());
+
+    // One burst, the lock is released once the last byte is read
+    ret = qmi8658_reg_read(cfg, REG_TIMESTAMP_L, buf, sizeof(buf));
+    if (ret) {
+        LOG_ERR("read synchronized sample failed");
+        return ret;
+    }
+
+    qmi8658_sync_track(data, sys_get_le24(buf), now);
+
+    *temp = (int16_t) sys_get_le16(&buf[TIMESTAMP_DATA_SIZE]);
+    for (int i = 0; i < 6; i++) {
+        samples[i] = (int16_t) sys_get_le16(&buf[TIMESTAMP_DATA_SIZE + TEMP_DATA_SZE + i * 2]);
+    }
+    if (timestamp != NULL) {
+        *timestamp = data->sync.sample_ns;
+    }
+
+    return 0;
+}
+
+int qmi8658_sync_fetch(const struct device *dev) {
+    struct qmi8658_data *data = dev->data;
+    int16_t raw[6];
+    int ret;
+
+    ret = qmi8658_sync_read(dev, raw, &data->temp, NULL);
+    if (ret) {
+        return ret;
+    }
+
+    memcpy(data->accel, &raw[0], sizeof(data->accel));
+    memcpy(data->gyro, &raw[3], sizeof(data->gyro));
+
+    return 0;
+}
+
+void qmi8658_sync_channel_get(const struct device *dev, struct sensor_value *val) {
+    const struct qmi8658_data *data = dev->data;
+
+    sensor_value_from_micro(&val[0], data->sync.sample_ns / NSEC_PER_USEC);
+    val[1].val1 = data->sync.count;
+    val[1].val2 = 0;
+}
+
+int qmi8658_sync_init(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+
+    return qmi8658_reg_update(cfg, REG_CTRL7, BIT_SYNC_SAMPLE_EN, BIT_SYNC_SAMPLE_EN);
+}
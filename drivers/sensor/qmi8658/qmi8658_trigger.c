@@ -0,0 +1,216 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+static void qmi8658_gpio_callback(const struct device *port, struct gpio_callback *cb, const uint32_t pins) {
+    struct qmi8658_data *data = CONTAINER_OF(cb, struct qmi8658_data, gpio_cb);
+
+    ARG_UNUSED(port);
+    ARG_UNUSED(pins);
+
+#if defined(CONFIG_QMI8658_TRIGGER_OWN_THREAD)
+    k_sem_give(&data->gpio_sem);
+#elif defined(CONFIG_QMI8658_TRIGGER_GLOBAL_THREAD)
+    k_work_submit(&data->work);
+#endif
+}
+
+static void qmi8658_handle_interrupt(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+
+    if (data->drdy_handler != NULL) {
+        uint8_t status_int;
+
+        // Avail filters out edges that were not caused by new sample data
+        if (!qmi8658_reg_read(cfg, REG_STATUS_INT, &status_int, 1) &&
+            (status_int & BIT_AVAIL)) {
+            data->drdy_handler(dev, data->drdy_trigger);
+        }
+    }
+
+#if defined(CONFIG_QMI8658_MOTION) || defined(CONFIG_QMI8658_WAKE_ON_MOTION)
+    bool events = false;
+    uint8_t status1;
+
+#ifdef CONFIG_QMI8658_MOTION
+    events |= qmi8658_motion_is_enabled(dev);
+#endif
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+    events |= qmi8658_wom_is_armed(dev);
+#endif
+
+    // Reading STATUS1 clears the event flags, read it once for all detectors
+    if (events && !qmi8658_reg_read(cfg, REG_STATUS1, &status1, 1)) {
+        status1 |= data->status1;
+        data->status1 = 0;
+#ifdef CONFIG_QMI8658_MOTION
+        qmi8658_motion_handle_interrupt(dev, status1);
+#endif
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+        qmi8658_wom_handle_interrupt(dev, status1);
+#endif
+    }
+#endif
+
+#ifdef CONFIG_QMI8658_FIFO
+    uint8_t status;
+    uint16_t frames;
+
+    if ((data->fifo_full_handler == NULL) && (data->fifo_wm_handler == NULL)) {
+        return;
+    }
+
+    if (qmi8658_fifo_status(dev, &status, &frames)) {
+        return;
+    }
+
+    // A full FIFO is also above the watermark, report the stronger condition
+    if ((status & BIT_FIFO_FULL) && (data->fifo_full_handler != NULL)) {
+        data->fifo_full_handler(dev, data->fifo_full_trigger);
+    } else if ((status & BIT_FIFO_WTM) && (data->fifo_wm_handler != NULL)) {
+        data->fifo_wm_handler(dev, data->fifo_wm_trigger);
+    }
+#endif
+}
+
+#if defined(CONFIG_QMI8658_TRIGGER_OWN_THREAD)
+static void qmi8658_thread(void *p1, void *p2, void *p3) {
+    struct qmi8658_data *data = p1;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1) {
+        k_sem_take(&data->gpio_sem, K_FOREVER);
+        qmi8658_handle_interrupt(data->dev);
+    }
+}
+#elif defined(CONFIG_QMI8658_TRIGGER_GLOBAL_THREAD)
+static void qmi8658_work_cb(struct k_work *work) {
+    struct qmi8658_data *data = CONTAINER_OF(work, struct qmi8658_data, work);
+
+    qmi8658_handle_interrupt(data->dev);
+}
+#endif
+
+int qmi8658_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                        const sensor_trigger_handler_t handler) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+    ret = qmi8658_check_ready(dev);
+    if (ret) {
+        return ret;
+    }
+
+    if (cfg->int_gpio.port == NULL) {
+        LOG_ERR("int-gpios not defined");
+        return -ENOTSUP;
+    }
+
+    switch (trig->type) {
+        case SENSOR_TRIG_DATA_READY:
+            // Data ready is only signalled on INT2
+            if (cfg->int_pin != 2) {
+                LOG_ERR("data ready requires int-gpios on INT2");
+                return -ENOTSUP;
+            }
+            data->drdy_handler = handler;
+            data->drdy_trigger = trig;
+            // Keep INT2 quiet at the ODR unless somebody listens
+            return qmi8658_reg_update(cfg, REG_CTRL7, BIT_DRDY_DIS,
+                                      handler != NULL ? 0 : BIT_DRDY_DIS);
+#ifdef CONFIG_QMI8658_FIFO
+        case SENSOR_TRIG_FIFO_WATERMARK:
+            data->fifo_wm_handler = handler;
+            data->fifo_wm_trigger = trig;
+            break;
+        case SENSOR_TRIG_FIFO_FULL:
+            data->fifo_full_handler = handler;
+            data->fifo_full_trigger = trig;
+            break;
+#endif
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+        case (enum sensor_trigger_type) QMI8658_TRIG_WAKE_ON_MOTION:
+            return qmi8658_wom_trigger_set(dev, trig, handler);
+#endif
+        default:
+#ifdef CONFIG_QMI8658_MOTION
+            return qmi8658_motion_trigger_set(dev, trig, handler);
+#else
+            LOG_ERR("Unsupported trigger %d", trig->type);
+            return -ENOTSUP;
+#endif
+    }
+
+    return 0;
+}
+
+int qmi8658_trigger_init(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    uint8_t ctrl1;
+    int ret;
+
+    if (cfg->int_gpio.port == NULL) {
+        LOG_DBG("int-gpios not defined, triggers disabled");
+        return 0;
+    }
+
+    if (!gpio_is_ready_dt(&cfg->int_gpio)) {
+        LOG_ERR("int gpio not ready");
+        return -ENODEV;
+    }
+
+    data->dev = dev;
+
+#if defined(CONFIG_QMI8658_TRIGGER_OWN_THREAD)
+    k_sem_init(&data->gpio_sem, 0, K_SEM_MAX_LIMIT);
+
+    k_thread_create(&data->thread, data->thread_stack, CONFIG_QMI8658_THREAD_STACK_SIZE,
+                    qmi8658_thread, data, NULL, NULL,
+                    K_PRIO_COOP(CONFIG_QMI8658_THREAD_PRIORITY), 0, K_NO_WAIT);
+    k_thread_name_set(&data->thread, dev->name);
+#elif defined(CONFIG_QMI8658_TRIGGER_GLOBAL_THREAD)
+    k_work_init(&data->work, qmi8658_work_cb);
+#endif
+
+    ret = gpio_pin_configure_dt(&cfg->int_gpio, GPIO_INPUT);
+    if (ret) {
+        return ret;
+    }
+
+    gpio_init_callback(&data->gpio_cb, qmi8658_gpio_callback, BIT(cfg->int_gpio.pin));
+
+    ret = gpio_add_callback(cfg->int_gpio.port, &data->gpio_cb);
+    if (ret) {
+        LOG_ERR("add gpio callback failed");
+        return ret;
+    }
+
+    // Route the FIFO interrupt to the pin int-gpios is wired to
+    if (cfg->int_pin == 1) {
+        ctrl1 = BIT_INT1_EN | BIT_FIFO_INT_SEL;
+    } else {
+        ctrl1 = BIT_INT2_EN;
+    }
+    ret = qmi8658_reg_update(cfg, REG_CTRL1, BIT_INT1_EN | BIT_INT2_EN | BIT_FIFO_INT_SEL, ctrl1);
+    if (ret) {
+        LOG_ERR("reg_ctrl1 interrupt setup failed");
+        return ret;
+    }
+
+    // Data ready stays disabled until a handler is installed
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_DRDY_DIS, BIT_DRDY_DIS);
+    if (ret) {
+        LOG_ERR("reg_ctrl7 interrupt setup failed");
+        return ret;
+    }
+
+    return gpio_pin_interrupt_configure_dt(&cfg->int_gpio, GPIO_INT_EDGE_TO_ACTIVE);
+}
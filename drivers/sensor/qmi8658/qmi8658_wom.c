@@ -0,0 +1,160 @@
+#include "qmi8658.h"
+#include "qmi8658_reg.h"
+#include <app/drivers/sensor/qmi8658.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(QMI8658, CONFIG_SENSOR_LOG_LEVEL);
+
+bool qmi8658_wom_is_attr(const enum sensor_attribute attr) {
+    return ((int) attr == QMI8658_ATTR_WOM_TH) || ((int) attr == QMI8658_ATTR_WOM_BLANKING);
+}
+
+bool qmi8658_wom_is_armed(const struct device *dev) {
+    const struct qmi8658_data *data = dev->data;
+
+    return data->wom_handler != NULL;
+}
+
+// A threshold of 0 disarms WoM. The sensors must be disabled while the
+// setting is written.
+static int qmi8658_wom_write(const struct device *dev, const uint8_t th) {
+    const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    uint8_t sel;
+    int ret;
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN | BIT_GEN | BIT_GSN, 0);
+    if (ret) {
+        return ret;
+    }
+
+    // The pin starts low and toggles on every event
+    sel = FIELD_PREP(MASK_WOM_BLANKING, data->wom_blanking);
+    if (cfg->int_pin == 2) {
+        sel |= BIT_WOM_INT2;
+    }
+
+    ret = qmi8658_reg_write(cfg, REG_CAL1_L, th);
+    if (ret) {
+        return ret;
+    }
+    ret = qmi8658_reg_write(cfg, REG_CAL1_H, sel);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_ctrl9_cmd(dev, CTRL_CMD_WRITE_WOM_SETTING);
+}
+
+// Only the accel runs while armed, at its low power rate
+static int qmi8658_wom_arm(const struct device *dev) {
+    const struct qmi8658_config *cfg = dev->config;
+    const struct qmi8658_data *data = dev->data;
+    int ret;
+
+    ret = qmi8658_wom_write(dev, data->wom_th);
+    if (ret) {
+        LOG_ERR("write wom setting failed");
+        return ret;
+    }
+
+    ret = qmi8658_reg_update(cfg, REG_CTRL2, (uint8_t) MASK_ACCEL_ODR, data->accel_lp_odr);
+    if (ret) {
+        return ret;
+    }
+
+    return qmi8658_reg_update(cfg, REG_CTRL7, BIT_AEN, BIT_AEN);
+}
+
+static int qmi8658_wom_disarm(const struct device *dev) {
+    int ret;
+
+    ret = qmi8658_wom_write(dev, 0);
+    if (ret) {
+        LOG_ERR("clear wom setting failed");
+        return ret;
+    }
+
+    return qmi8658_power_apply(dev);
+}
+
+static int qmi8658_wom_mg(const struct sensor_value *val, uint8_t *out) {
+    const int64_t mg = (sensor_value_to_micro(val) * 1000 + SENSOR_G / 2) / SENSOR_G;
+
+    if ((mg < 1) || (mg > UINT8_MAX)) {
+        return -EINVAL;
+    }
+
+    *out = mg;
+    return 0;
+}
+
+int qmi8658_wom_attr_set(const struct device *dev, const enum sensor_attribute attr,
+                         const struct sensor_value *val) {
+    struct qmi8658_data *data = dev->data;
+    int ret;
+
+    if ((int) attr == QMI8658_ATTR_WOM_TH) {
+        ret = qmi8658_wom_mg(val, &data->wom_th);
+    } else if ((val->val1 < 0) || (val->val1 > FIELD_GET(MASK_WOM_BLANKING, 0xFF))) {
+        ret = -EINVAL;
+    } else {
+        data->wom_blanking = val->val1;
+        ret = 0;
+    }
+
+    if (ret) {
+        LOG_ERR("Invalid value for attribute %d", attr);
+        return ret;
+    }
+
+    // The setting only reaches the chip with the WoM command
+    return qmi8658_wom_is_armed(dev) ? qmi8658_wom_arm(dev) : 0;
+}
+
+int qmi8658_wom_trigger_set(const struct device *dev, const struct sensor_trigger *trig,
+                            const sensor_trigger_handler_t handler) {
+    const struct qmi8658_config *cfg = dev->config;
+    struct qmi8658_data *data = dev->data;
+    const bool was_armed = qmi8658_wom_is_armed(dev);
+    int ret;
+
+    data->wom_handler = handler;
+    data->wom_trigger = trig;
+
+    if ((handler != NULL) == was_armed) {
+        return 0;
+    }
+
+    if (handler == NULL) {
+        ret = qmi8658_wom_disarm(dev);
+        if (ret) {
+            return ret;
+        }
+        return gpio_pin_interrupt_configure_dt(&cfg->int_gpio, GPIO_INT_EDGE_TO_ACTIVE);
+    }
+
+    // Events toggle the pin instead of pulsing it
+    ret = gpio_pin_interrupt_configure_dt(&cfg->int_gpio, GPIO_INT_EDGE_BOTH);
+    if (ret) {
+        data->wom_handler = NULL;
+        return ret;
+    }
+
+    ret = qmi8658_wom_arm(dev);
+    if (ret) {
+        data->wom_handler = NULL;
+        gpio_pin_interrupt_configure_dt(&cfg->int_gpio, GPIO_INT_EDGE_TO_ACTIVE);
+    }
+
+    return ret;
+}
+
+void qmi8658_wom_handle_interrupt(const struct device *dev, const uint8_t status1) {
+    const struct qmi8658_data *data = dev->data;
+
+    if ((status1 & BIT_WOM) && (data->wom_handler != NULL)) {
+        data->wom_handler(dev, data->wom_trigger);
+    }
+}
+
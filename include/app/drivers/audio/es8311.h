@@ -0,0 +1,152 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_AUDIO_ES8311_H_
+#define APP_DRIVERS_AUDIO_ES8311_H_
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+/**
+ * @defgroup drivers_audio_es8311 ES8311 codec extensions
+ * @ingroup drivers
+ * @{
+ *
+ * @brief Device-specific helpers of the Everest ES8311 audio codec.
+ *
+ * Besides playback the codec captures from one microphone. The
+ * @ref AUDIO_ROUTE_CAPTURE and @ref AUDIO_ROUTE_PLAYBACK_CAPTURE routes start
+ * the ADC on configure, audio_codec_start_input() and
+ * audio_codec_stop_input() switch it afterwards. audio_codec_route_input()
+ * selects one of @ref es8311_input, @ref AUDIO_PROPERTY_INPUT_VOLUME sets the
+ * ADC volume in 0.5 dB steps.
+ *
+ * The codec also carries a capture ALC, a playback DRC, a capture high-pass
+ * filter and an equalizer on each path. Their defaults come from devicetree,
+ * the helpers below change them at runtime.
+ */
+
+/** @brief Microphone inputs, for audio_codec_route_input() */
+enum es8311_input {
+	/** Analog microphone on MIC1P/MIC1N through the PGA */
+	ES8311_INPUT_MIC1,
+	/** PDM microphone on MIC1P */
+	ES8311_INPUT_DMIC,
+};
+
+/** @brief Equalizers, for es8311_set_eq() */
+enum es8311_eq_path {
+	/** Capture equalizer, ADCEQ1..ADCEQ20 */
+	ES8311_EQ_ADC,
+	/** Playback equalizer, DACEQ1..DACEQ12 */
+	ES8311_EQ_DAC,
+};
+
+/**
+ * @brief Settings of the capture ALC or the playback DRC.
+ *
+ * Both loops use the same register layout. Levels are register codes from
+ * 0 to 15, see the ES8311 datasheet for their dBFS values.
+ */
+struct es8311_dynamics {
+	/** Run the gain control loop */
+	bool enable;
+	/** Detection window, 0 to 15 */
+	uint8_t window;
+	/** Upper target level, 0 to 15 */
+	uint8_t max_level;
+	/** Lower target level, 0 to @p max_level */
+	uint8_t min_level;
+};
+
+/**
+ * @brief Wait for the codec to finish initializing.
+ *
+ * With @kconfig{CONFIG_ES8311_DEFERRED_INIT} the codec is brought up from the
+ * system workqueue after device init returns, and the codec API fails with
+ * -EAGAIN until then. Returns immediately otherwise.
+ *
+ * @param dev ES8311 device instance.
+ * @param timeout How long to wait.
+ *
+ * @retval 0 if the codec is ready.
+ * @retval -EAGAIN if initialization is still running after @p timeout.
+ * @retval -errno Negative errno code if initialization failed.
+ */
+int es8311_init_wait(const struct device *dev, k_timeout_t timeout);
+
+/**
+ * @brief Set the gain of the analog microphone amplifier.
+ *
+ * @param dev ES8311 device instance.
+ * @param gain_db Gain from 0 to 30 dB in 3 dB steps.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if the gain is not supported.
+ * @retval -EAGAIN if initialization is still running.
+ * @retval -errno Other negative errno code on failure.
+ */
+int es8311_set_mic_gain(const struct device *dev, uint8_t gain_db);
+
+/**
+ * @brief Configure the automatic level control of the capture path.
+ *
+ * @param dev ES8311 device instance.
+ * @param cfg ALC settings.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if a setting is out of range.
+ * @retval -EAGAIN if initialization is still running.
+ * @retval -errno Other negative errno code on failure.
+ */
+int es8311_set_alc(const struct device *dev, const struct es8311_dynamics *cfg);
+
+/**
+ * @brief Configure the dynamic range control of the playback path.
+ *
+ * @param dev ES8311 device instance.
+ * @param cfg DRC settings.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if a setting is out of range.
+ * @retval -EAGAIN if initialization is still running.
+ * @retval -errno Other negative errno code on failure.
+ */
+int es8311_set_drc(const struct device *dev, const struct es8311_dynamics *cfg);
+
+/**
+ * @brief Switch the DC blocking high-pass filter of the capture path.
+ *
+ * @param dev ES8311 device instance.
+ * @param enable True to run the filter.
+ *
+ * @retval 0 if successful.
+ * @retval -EAGAIN if initialization is still running.
+ * @retval -errno Other negative errno code on failure.
+ */
+int es8311_set_adc_hpf(const struct device *dev, bool enable);
+
+/**
+ * @brief Load and enable an equalizer.
+ *
+ * The coefficients are raw register images, 20 bytes for @ref ES8311_EQ_ADC
+ * and 12 bytes for @ref ES8311_EQ_DAC, written in one burst while the
+ * equalizer is bypassed.
+ *
+ * @param dev ES8311 device instance.
+ * @param path Equalizer to program.
+ * @param coeffs Coefficient registers in address order, or NULL to bypass
+ *               the equalizer.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if @p path is invalid.
+ * @retval -EAGAIN if initialization is still running.
+ * @retval -errno Other negative errno code on failure.
+ */
+int es8311_set_eq(const struct device *dev, enum es8311_eq_path path,
+		  const uint8_t *coeffs);
+
+/** @} */
+
+#endif /* APP_DRIVERS_AUDIO_ES8311_H_ */
@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_AUDIO_ES8311_EMUL_H_
+#define APP_DRIVERS_AUDIO_ES8311_EMUL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/drivers/emul.h>
+
+/**
+ * @defgroup drivers_audio_es8311_emul ES8311 emulator
+ * @ingroup drivers_audio_es8311
+ * @{
+ *
+ * @brief Test helpers of the register-level ES8311 I2C emulator.
+ *
+ * The emulator holds the full register file with its power-on values and
+ * the chip ID, and counts the bus traffic of every driver operation.
+ */
+
+/** @brief Bus traffic seen by the emulator */
+struct es8311_emul_stats {
+	/** Number of I2C transfers, one per i2c_transfer() call */
+	uint32_t transfers;
+	/** Payload bytes moved in both directions, register addresses included */
+	uint32_t bytes;
+};
+
+/**
+ * @brief Restore the power-on register values, as after a power cycle.
+ *
+ * @param target Emulator instance.
+ */
+void es8311_emul_power_on(const struct emul *target);
+
+/**
+ * @brief Set a register as if the chip had updated it.
+ *
+ * @param target Emulator instance.
+ * @param reg Register address.
+ * @param val New register value.
+ */
+void es8311_emul_set_reg(const struct emul *target, uint8_t reg, uint8_t val);
+
+/**
+ * @brief Get the current value of a register.
+ *
+ * @param target Emulator instance.
+ * @param reg Register address.
+ *
+ * @return Register value.
+ */
+uint8_t es8311_emul_get_reg(const struct emul *target, uint8_t reg);
+
+/**
+ * @brief Check whether the codec is held in reset.
+ *
+ * @param target Emulator instance.
+ *
+ * @return True while the state machine is off or a reset bit is set.
+ */
+bool es8311_emul_in_reset(const struct emul *target);
+
+/**
+ * @brief Get how long the codec was held in reset before it last left it.
+ *
+ * Measured in uptime from power-on or the write that entered reset to the
+ * write that left it.
+ *
+ * @param target Emulator instance.
+ *
+ * @return Reset hold time in ms, 0 if the codec never left reset.
+ */
+uint32_t es8311_emul_get_reset_hold(const struct emul *target);
+
+/**
+ * @brief Get the bus traffic accumulated since the last reset.
+ *
+ * @param target Emulator instance.
+ * @param stats Destination for the counters.
+ */
+void es8311_emul_get_stats(const struct emul *target, struct es8311_emul_stats *stats);
+
+/**
+ * @brief Zero the bus traffic counters.
+ *
+ * @param target Emulator instance.
+ */
+void es8311_emul_reset_stats(const struct emul *target);
+
+/** @} */
+
+#endif /* APP_DRIVERS_AUDIO_ES8311_EMUL_H_ */
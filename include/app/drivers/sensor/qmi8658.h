@@ -0,0 +1,362 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_SENSOR_QMI8658_H_
+#define APP_DRIVERS_SENSOR_QMI8658_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+
+/**
+ * @defgroup drivers_sensor_qmi8658 QMI8658 sensor extensions
+ * @ingroup drivers
+ * @{
+ *
+ * @brief Device-specific attributes and helpers of the QST QMI8658 IMU.
+ *
+ * These extend the generic sensor API with features of the chip that have no
+ * standard equivalent.
+ *
+ * sensor_channel_get() accepts @ref SENSOR_CHAN_ALL and then fills six values
+ * in one call: accel x, y, z followed by gyro x, y, z.
+ *
+ * sensor_sample_fetch() reads status, temperature, accel and gyro in a single
+ * transfer and returns -EBUSY when the requested sensors have no sample newer
+ * than the last fetch. @ref SENSOR_CHAN_DIE_TEMP reports the chip temperature.
+ *
+ * With @kconfig{CONFIG_PM_DEVICE}, suspending the device disables both sensors
+ * and the internal oscillator, unless wake on motion is armed. Resuming
+ * restores the configured power modes and rates.
+ *
+ * With @kconfig{CONFIG_QMI8658_CALIBRATION}, @ref SENSOR_ATTR_OFFSET on
+ * @ref SENSOR_CHAN_ACCEL_XYZ or @ref SENSOR_CHAN_GYRO_XYZ takes three values,
+ * x, y, z, that the chip subtracts from its output. They are kept across
+ * resets with @kconfig{CONFIG_QMI8658_CALIBRATION_SETTINGS}.
+ */
+
+/**
+ * @brief Custom sensor channels
+ *
+ * Produced by the on-chip AttitudeEngine, see
+ * @kconfig{CONFIG_QMI8658_ATTITUDE_ENGINE}. The engine is enabled by setting
+ * @ref SENSOR_ATTR_SAMPLING_FREQUENCY on @ref SENSOR_CHAN_GAME_ROTATION_VECTOR
+ * to 1 to 64 Hz, and disabled by setting it to 0. The rotation vector channel
+ * itself reports the orientation accumulated from the increments since the
+ * engine was enabled, as a w, x, y, z unit quaternion.
+ */
+enum qmi8658_sensor_channel {
+	/** Orientation increment of the last engine period, w, x, y, z quaternion */
+	QMI8658_CHAN_DELTA_QUAT = SENSOR_CHAN_PRIV_START,
+	/** Velocity increment of the last engine period, x, y, z in m/s */
+	QMI8658_CHAN_DELTA_VELOCITY,
+	/**
+	 * Steps counted by the pedometer, requires
+	 * @kconfig{CONFIG_QMI8658_MOTION}
+	 */
+	QMI8658_CHAN_STEP_COUNT,
+	/**
+	 * Time of the last sample, requires
+	 * @kconfig{CONFIG_QMI8658_SYNC_SAMPLE}. Two values: the host uptime at
+	 * which the sample was latched, in seconds, estimated from the chip's
+	 * sample counter, followed by the raw 24-bit counter. Fetching any
+	 * accel or gyro channel updates it.
+	 */
+	QMI8658_CHAN_TIMESTAMP,
+};
+
+/**
+ * @brief Custom sensor triggers
+ *
+ * Delivered with @kconfig{CONFIG_QMI8658_MOTION}, next to the generic
+ * @ref SENSOR_TRIG_MOTION (any motion), @ref SENSOR_TRIG_STATIONARY (no
+ * motion), @ref SENSOR_TRIG_TAP and @ref SENSOR_TRIG_DOUBLE_TAP. Installing a
+ * handler enables the matching detector, removing it disables the detector.
+ */
+enum qmi8658_sensor_trigger {
+	/** Sustained motion, confirmed over the significant motion windows */
+	QMI8658_TRIG_SIG_MOTION = SENSOR_TRIG_PRIV_START,
+	/** A step was detected by the pedometer */
+	QMI8658_TRIG_STEP,
+	/**
+	 * Acceleration exceeded the wake on motion threshold, requires
+	 * @kconfig{CONFIG_QMI8658_WAKE_ON_MOTION}. Installing a handler arms
+	 * wake on motion, removing it restores the configured power modes.
+	 */
+	QMI8658_TRIG_WAKE_ON_MOTION,
+};
+
+/**
+ * @brief Sensor power modes
+ *
+ * Set with @ref QMI8658_ATTR_POWER_MODE on the accel or gyro channels.
+ */
+enum qmi8658_power_mode {
+	/** Full performance, the power-on default */
+	QMI8658_POWER_NORMAL,
+	/**
+	 * Accel: low power sampling at 3, 11, 21 or 128 Hz, only while the
+	 * gyro is off. Gyro: snooze, the drive stays on for a fast restart but
+	 * no data is produced.
+	 */
+	QMI8658_POWER_LOW,
+	/** Sensor disabled */
+	QMI8658_POWER_OFF,
+};
+
+/** @brief Custom sensor attributes */
+enum qmi8658_sensor_attribute {
+	/**
+	 * FIFO watermark, in frames, set on @ref SENSOR_CHAN_ALL. A
+	 * @ref SENSOR_TRIG_FIFO_WATERMARK trigger fires when the FIFO holds at
+	 * least this many frames.
+	 */
+	QMI8658_ATTR_FIFO_WATERMARK = SENSOR_ATTR_PRIV_START,
+	/*
+	 * Motion engine settings, set on the accel channels. The any motion
+	 * detector uses the generic @ref SENSOR_ATTR_SLOPE_TH (m/s^2) and
+	 * @ref SENSOR_ATTR_SLOPE_DUR (samples). Windows are counted in samples
+	 * at the accel ODR.
+	 */
+	/** No motion threshold per axis, m/s^2 */
+	QMI8658_ATTR_NO_MOTION_TH,
+	/** Samples below the no motion threshold before reporting */
+	QMI8658_ATTR_NO_MOTION_DUR,
+	/** Samples to wait after any motion before confirming significant motion */
+	QMI8658_ATTR_SIG_MOTION_WAIT,
+	/** Samples of continued motion that confirm significant motion */
+	QMI8658_ATTR_SIG_MOTION_CONFIRM,
+	/** Peak acceleration magnitude of a tap, m/s^2 */
+	QMI8658_ATTR_TAP_TH,
+	/** Samples after a tap peak during which no second peak may occur */
+	QMI8658_ATTR_TAP_WINDOW,
+	/** Samples during which a second tap makes a double tap */
+	QMI8658_ATTR_DOUBLE_TAP_WINDOW,
+	/** Minimum peak-to-peak acceleration of a step, m/s^2 */
+	QMI8658_ATTR_STEP_TH,
+	/** Samples in the pedometer detection window */
+	QMI8658_ATTR_STEP_WINDOW,
+	/**
+	 * Power mode of the sensor, a @ref qmi8658_power_mode, set on the accel
+	 * or gyro channels. In accel low power mode
+	 * @ref SENSOR_ATTR_SAMPLING_FREQUENCY selects among the low power rates,
+	 * the normal mode rate is kept for when the mode is left.
+	 */
+	QMI8658_ATTR_POWER_MODE,
+	/** Wake on motion threshold on any axis, m/s^2, up to 255 mg */
+	QMI8658_ATTR_WOM_TH,
+	/** Accel samples ignored after wake on motion is armed, up to 63 */
+	QMI8658_ATTR_WOM_BLANKING,
+};
+
+/**
+ * @brief One FIFO frame in 6DoF mode.
+ *
+ * Raw, little-endian decoded, register values. Scale them with the full-scale
+ * range currently configured for each sensor.
+ */
+struct qmi8658_fifo_frame {
+	int16_t accel[3];
+	int16_t gyro[3];
+};
+
+/**
+ * @brief Conversion factors of one full-scale range.
+ *
+ * Selected when the range is programmed, so converting a sample costs one
+ * multiply. Use the kernels below with the factors of the range the samples
+ * were taken at, see qmi8658_get_scale().
+ */
+struct qmi8658_scale {
+	/** Full scale in micro SI units, micro m/s^2 or micro rad/s */
+	int32_t micro;
+	/** q31 multiplier, the q31 value of a sample is raw * @p q31 */
+	int32_t q31;
+	/** Shift of the q31 values produced with @p q31 */
+	int8_t shift;
+	/** SI units per LSB */
+	float f;
+};
+
+/**
+ * @brief Convert raw samples to q31.
+ *
+ * Plain 32-bit multiplies with no data dependency between elements, so the
+ * loop vectorizes where the core supports it. The results share
+ * @ref qmi8658_scale.shift.
+ *
+ * @param scale Factors of the range the samples were taken at.
+ * @param raw Raw samples, for example consecutive x, y, z triplets.
+ * @param out Destination, @p n elements.
+ * @param n Number of samples.
+ */
+static inline void qmi8658_convert_q31(const struct qmi8658_scale *scale, const int16_t *raw,
+				       q31_t *out, size_t n)
+{
+	const int32_t k = scale->q31;
+
+	for (size_t i = 0; i < n; i++) {
+		out[i] = (int32_t)raw[i] * k;
+	}
+}
+
+/**
+ * @brief Convert raw samples to floating point SI units.
+ *
+ * @param scale Factors of the range the samples were taken at.
+ * @param raw Raw samples, for example consecutive x, y, z triplets.
+ * @param out Destination, @p n elements.
+ * @param n Number of samples.
+ */
+static inline void qmi8658_convert_float(const struct qmi8658_scale *scale, const int16_t *raw,
+					 float *out, size_t n)
+{
+	const float k = scale->f;
+
+	for (size_t i = 0; i < n; i++) {
+		out[i] = (float)raw[i] * k;
+	}
+}
+
+/**
+ * @brief Convert raw samples to sensor values.
+ *
+ * Full scale is 32768 LSB, so the micro unit value is a multiply and a shift.
+ * It always fits in 32 bits, leaving only 32-bit divisions for the split into
+ * integer and fractional parts.
+ *
+ * @param scale Factors of the range the samples were taken at.
+ * @param raw Raw samples, for example consecutive x, y, z triplets.
+ * @param val Destination, @p n elements.
+ * @param n Number of samples.
+ */
+static inline void qmi8658_convert_sensor_value(const struct qmi8658_scale *scale,
+						const int16_t *raw, struct sensor_value *val,
+						size_t n)
+{
+	const int32_t k = scale->micro;
+
+	for (size_t i = 0; i < n; i++) {
+		const int32_t micro = (int32_t)(((int64_t)raw[i] * k) >> 15);
+
+		val[i].val1 = micro / 1000000;
+		val[i].val2 = micro % 1000000;
+	}
+}
+
+/**
+ * @brief Get the conversion factors of the currently programmed range.
+ *
+ * Meant for raw data obtained outside of the sensor API, such as FIFO frames.
+ *
+ * @param dev QMI8658 device instance.
+ * @param chan @ref SENSOR_CHAN_ACCEL_XYZ or @ref SENSOR_CHAN_GYRO_XYZ.
+ * @param scale Destination for the factors.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOTSUP if @p chan is not supported.
+ */
+int qmi8658_get_scale(const struct device *dev, enum sensor_channel chan,
+		      struct qmi8658_scale *scale);
+
+/**
+ * @brief Drain frames from the on-chip FIFO.
+ *
+ * All available frames, up to @p max_frames, are transferred in one burst
+ * read. Frames that do not fit stay in the FIFO for the next call. Requires
+ * @kconfig{CONFIG_QMI8658_FIFO}.
+ *
+ * @param dev QMI8658 device instance.
+ * @param frames Destination buffer.
+ * @param max_frames Capacity of @p frames.
+ *
+ * @retval >=0 Number of frames read.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658_fifo_read(const struct device *dev, struct qmi8658_fifo_frame *frames,
+		      size_t max_frames);
+
+/**
+ * @brief Discard the contents of the on-chip FIFO.
+ *
+ * @param dev QMI8658 device instance.
+ *
+ * @retval 0 if successful.
+ * @retval -errno Negative errno code on failure.
+ */
+int qmi8658_fifo_flush(const struct device *dev);
+
+/**
+ * @brief Run the built-in self-test of one sensor.
+ *
+ * The chip drives the proof mass and reports the response, which must exceed
+ * 200 mg (accel) or 300 dps (gyro) on every axis. Sampling is stopped during
+ * the test and restored afterwards. Requires
+ * @kconfig{CONFIG_QMI8658_CALIBRATION}.
+ *
+ * @param dev QMI8658 device instance.
+ * @param chan @ref SENSOR_CHAN_ACCEL_XYZ or @ref SENSOR_CHAN_GYRO_XYZ.
+ *
+ * @retval 0 if the sensor passed.
+ * @retval -EIO if the response was too weak on an axis.
+ * @retval -EBUSY if wake on motion is armed.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658_self_test(const struct device *dev, enum sensor_channel chan);
+
+/**
+ * @brief Run the on-chip gyro gain calibration.
+ *
+ * Takes about 1.5 s, the device must be kept still. The resulting gains are
+ * stored and programmed again after every reset. Requires
+ * @kconfig{CONFIG_QMI8658_CALIBRATION}.
+ *
+ * @param dev QMI8658 device instance.
+ *
+ * @retval 0 if successful.
+ * @retval -EIO if the chip reported a failed calibration.
+ * @retval -EBUSY if wake on motion is armed.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658_calibrate_gyro_gain(const struct device *dev);
+
+/**
+ * @brief Estimate and compensate the accel and gyro bias.
+ *
+ * Averages @p samples readings with the device at rest, one axis aligned with
+ * gravity, and adds the remaining bias to the offsets set through
+ * @ref SENSOR_ATTR_OFFSET. Both sensors must be in
+ * @ref QMI8658_POWER_NORMAL. Requires @kconfig{CONFIG_QMI8658_CALIBRATION}.
+ *
+ * @param dev QMI8658 device instance.
+ * @param samples Number of samples to average.
+ *
+ * @retval 0 if successful.
+ * @retval -EBUSY if a sensor is not in normal mode.
+ * @retval -errno Other negative errno code on failure.
+ */
+int qmi8658_calibrate_bias(const struct device *dev, uint16_t samples);
+
+/**
+ * @brief Wait for the device to finish initializing.
+ *
+ * With @kconfig{CONFIG_QMI8658_DEFERRED_INIT} the chip is brought up from the
+ * system workqueue after device init returns, and the sensor API returns
+ * -EAGAIN until then. Returns immediately otherwise.
+ *
+ * @param dev QMI8658 device instance.
+ * @param timeout How long to wait.
+ *
+ * @retval 0 if the device is ready.
+ * @retval -EAGAIN if initialization is still running after @p timeout.
+ * @retval -errno Negative errno code if initialization failed.
+ */
+int qmi8658_init_wait(const struct device *dev, k_timeout_t timeout);
+
+/** @} */
+
+#endif /* APP_DRIVERS_SENSOR_QMI8658_H_ */
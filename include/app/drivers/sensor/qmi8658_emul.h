@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_DRIVERS_SENSOR_QMI8658_EMUL_H_
+#define APP_DRIVERS_SENSOR_QMI8658_EMUL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/drivers/emul.h>
+
+#include <app/drivers/sensor/qmi8658.h>
+
+/**
+ * @defgroup drivers_sensor_qmi8658_emul QMI8658 emulator
+ * @ingroup drivers_sensor_qmi8658
+ * @{
+ *
+ * @brief Test helpers of the register-level QMI8658 I2C emulator.
+ *
+ * Sample values are normally injected through the generic sensor emulator
+ * backend, emul_sensor_backend_set_channel(). The helpers below cover what the
+ * backend cannot express: raw register access, the FIFO and bus statistics.
+ */
+
+/** @brief Bus traffic seen by the emulator */
+struct qmi8658_emul_stats {
+	/** Number of I2C transfers, one per i2c_transfer() call */
+	uint32_t transfers;
+	/** Payload bytes moved in both directions, register addresses included */
+	uint32_t bytes;
+};
+
+/**
+ * @brief Set a register as if the chip had updated it.
+ *
+ * @param target Emulator instance.
+ * @param reg Register address.
+ * @param val New register value.
+ */
+void qmi8658_emul_set_reg(const struct emul *target, uint8_t reg, uint8_t val);
+
+/**
+ * @brief Get the current value of a register.
+ *
+ * @param target Emulator instance.
+ * @param reg Register address.
+ *
+ * @return Register value.
+ */
+uint8_t qmi8658_emul_get_reg(const struct emul *target, uint8_t reg);
+
+/**
+ * @brief Append frames to the emulated FIFO.
+ *
+ * Frames that do not fit evict the oldest ones, as the chip does in stream
+ * mode, and set the overflow flag.
+ *
+ * @param target Emulator instance.
+ * @param frames Raw frames to append.
+ * @param count Number of frames.
+ */
+void qmi8658_emul_fifo_push(const struct emul *target, const struct qmi8658_fifo_frame *frames,
+			    size_t count);
+
+/**
+ * @brief Set the response reported by the self-test of one sensor.
+ *
+ * Survives soft resets. The default passes the driver's checks.
+ *
+ * @param target Emulator instance.
+ * @param chan @ref SENSOR_CHAN_ACCEL_XYZ or @ref SENSOR_CHAN_GYRO_XYZ.
+ * @param response Raw x, y, z values placed in dVX..dVZ.
+ */
+void qmi8658_emul_set_self_test(const struct emul *target, enum sensor_channel chan,
+				const int16_t response[3]);
+
+/**
+ * @brief Get the bus traffic accumulated since the last reset.
+ *
+ * @param target Emulator instance.
+ * @param stats Destination for the counters.
+ */
+void qmi8658_emul_get_stats(const struct emul *target, struct qmi8658_emul_stats *stats);
+
+/**
+ * @brief Zero the bus traffic counters.
+ *
+ * @param target Emulator instance.
+ */
+void qmi8658_emul_reset_stats(const struct emul *target);
+
+/** @} */
+
+#endif /* APP_DRIVERS_SENSOR_QMI8658_EMUL_H_ */
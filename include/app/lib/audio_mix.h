@@ -0,0 +1,315 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_AUDIO_MIX_H_
+#define APP_LIB_AUDIO_MIX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @defgroup lib_audio_mix Audio mixer
+ * @ingroup lib
+ * @{
+ *
+ * @brief Multi-voice PCM mixer with a RAM cache of sound effects.
+ *
+ * Voices are summed straight into the output block with saturating Q15
+ * adds, so the mixer can be the producer of an audio_out engine without an
+ * intermediate buffer. Each voice has a gain, a constant-power pan and a
+ * linear fade ramp.
+ *
+ * A voice plays either a sound from the cache or a stream rendered by a
+ * callback. Sounds are decoded into the cache once, so triggering one only
+ * claims a voice. The voice pool is fixed at build time, which bounds the
+ * mixing cost of a block: a trigger finding no free voice is refused
+ * rather than raising the load.
+ *
+ * Voices are mono. On a mono output the pan is ignored.
+ */
+
+/** @brief Sound held in a mixer cache, mono 16-bit at the mixer rate */
+struct audio_mix_sound {
+	/** Samples */
+	const int16_t *pcm;
+	/** Number of samples */
+	uint32_t frames;
+};
+
+/**
+ * @brief Decoder callback, writes the samples of a sound into the cache.
+ *
+ * @param dst Destination in the cache.
+ * @param frames Samples to write.
+ * @param user_data Pointer passed to audio_mix_cache_add().
+ *
+ * @retval 0 if successful.
+ * @retval -errno to drop the sound.
+ */
+typedef int (*audio_mix_decode_t)(int16_t *dst, size_t frames, void *user_data);
+
+/**
+ * @brief Stream callback, renders the next samples of a stream voice.
+ *
+ * Runs on the thread that mixes.
+ *
+ * @param dst Destination.
+ * @param frames Samples requested.
+ * @param user_data Pointer passed to audio_mix_play_stream().
+ *
+ * @return Samples rendered. Fewer than requested ends the voice.
+ */
+typedef size_t (*audio_mix_render_t)(int16_t *dst, size_t frames, void *user_data);
+
+/** @brief Voice parameters */
+struct audio_mix_voice_cfg {
+	/** Q15 gain, 32767 for unity */
+	int16_t gain;
+	/** Pan, -32767 is hard left, 0 centre, 32767 hard right */
+	int16_t pan;
+	/** Fade-in time in milliseconds, 0 to start at full gain */
+	uint16_t fade_ms;
+	/** Restart a sound when it ends */
+	bool loop;
+};
+
+/** @brief Mixer statistics, accumulated since the last reset */
+struct audio_mix_stats {
+	/** Blocks mixed */
+	uint32_t blocks;
+	/** Most cycles spent mixing one block */
+	uint32_t max_cycles;
+	/** Most voices playing in one block */
+	uint8_t max_voices;
+	/** Triggers refused because every voice was busy */
+	uint32_t refused;
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct audio_mix_cache {
+	int16_t *arena;
+	size_t size;
+	size_t used;
+	struct audio_mix_sound *sounds;
+	uint8_t max_sounds;
+	uint8_t num_sounds;
+};
+
+struct audio_mix_voice {
+	const int16_t *pcm;
+	uint32_t frames;
+	uint32_t pos;
+	audio_mix_render_t render;
+	void *user_data;
+	/* Q31 gain of each output channel, ramped by step for ramp frames */
+	int32_t gain[2];
+	int32_t step[2];
+	uint32_t ramp;
+	bool loop;
+	bool stopping;
+	bool active;
+	uint8_t gen;
+	/* Gain change posted by the control side, applied by the mixer */
+	int32_t req_gain[2];
+	uint32_t req_ramp;
+	bool req_stop;
+	bool req;
+};
+
+struct audio_mix {
+	struct audio_mix_voice *voices;
+	uint8_t num_voices;
+	uint8_t channels;
+	uint32_t rate;
+	int16_t *scratch;
+	size_t scratch_frames;
+	struct k_spinlock lock;
+	struct audio_mix_stats stats;
+};
+/** @endcond */
+
+/**
+ * @brief Statically define a sound cache.
+ *
+ * @param _name Name of the cache object.
+ * @param _frames Total samples of all sounds.
+ * @param _sounds Most sounds held.
+ */
+#define AUDIO_MIX_CACHE_DEFINE(_name, _frames, _sounds)				\
+	static int16_t _name##_arena[_frames];					\
+	static struct audio_mix_sound _name##_sounds[_sounds];			\
+	struct audio_mix_cache _name = {					\
+		.arena = _name##_arena,						\
+		.size = (_frames),						\
+		.sounds = _name##_sounds,					\
+		.max_sounds = (_sounds),					\
+	}
+
+/**
+ * @brief Statically define a mixer.
+ *
+ * @param _name Name of the mixer object.
+ * @param _voices Voices that can play at once, up to 255.
+ * @param _channels Output channels, 1 or 2.
+ * @param _max_frames Most frames in one output block, sizes the buffer
+ *        stream voices render into.
+ */
+#define AUDIO_MIX_DEFINE(_name, _voices, _channels, _max_frames)			\
+	BUILD_ASSERT(((_voices) > 0) && ((_voices) <= UINT8_MAX),			\
+		     "audio_mix needs 1 to 255 voices");				\
+	BUILD_ASSERT(((_channels) == 1) || ((_channels) == 2),				\
+		     "audio_mix outputs mono or stereo");				\
+	static struct audio_mix_voice _name##_voices[_voices];				\
+	static int16_t _name##_scratch[_max_frames];					\
+	struct audio_mix _name = {							\
+		.voices = _name##_voices,						\
+		.num_voices = (_voices),						\
+		.channels = (_channels),						\
+		.scratch = _name##_scratch,						\
+		.scratch_frames = (_max_frames),					\
+	}
+
+/**
+ * @brief Decode a sound into the cache.
+ *
+ * @param cache Cache defined with AUDIO_MIX_CACHE_DEFINE().
+ * @param frames Samples of the sound.
+ * @param decode Decoder writing the samples.
+ * @param user_data Pointer passed to @p decode.
+ *
+ * @return The cached sound, or NULL if the cache is full or @p decode failed.
+ */
+const struct audio_mix_sound *audio_mix_cache_add(struct audio_mix_cache *cache, size_t frames,
+						  audio_mix_decode_t decode, void *user_data);
+
+/**
+ * @brief Copy PCM samples into the cache, for sounds stored in flash.
+ *
+ * @param cache Cache instance.
+ * @param pcm Samples.
+ * @param frames Number of samples.
+ *
+ * @return The cached sound, or NULL if the cache is full.
+ */
+const struct audio_mix_sound *audio_mix_cache_copy(struct audio_mix_cache *cache,
+						   const int16_t *pcm, size_t frames);
+
+/**
+ * @brief Drop every sound of the cache.
+ *
+ * No voice may still play one of them.
+ *
+ * @param cache Cache instance.
+ */
+void audio_mix_cache_clear(struct audio_mix_cache *cache);
+
+/**
+ * @brief Set the output rate and silence every voice.
+ *
+ * @param mix Mixer defined with AUDIO_MIX_DEFINE().
+ * @param rate Output rate in Hz, used for the fade times.
+ */
+void audio_mix_init(struct audio_mix *mix, uint32_t rate);
+
+/**
+ * @brief Start playing a cached sound.
+ *
+ * @param mix Mixer instance.
+ * @param sound Sound from a cache.
+ * @param cfg Voice parameters.
+ *
+ * @return Voice handle on success.
+ * @retval -EBUSY if every voice is playing.
+ */
+int audio_mix_play(struct audio_mix *mix, const struct audio_mix_sound *sound,
+		   const struct audio_mix_voice_cfg *cfg);
+
+/**
+ * @brief Start a voice rendered by a callback.
+ *
+ * @param mix Mixer instance.
+ * @param render Stream callback.
+ * @param user_data Pointer passed to @p render.
+ * @param cfg Voice parameters, loop is ignored.
+ *
+ * @return Voice handle on success.
+ * @retval -EBUSY if every voice is playing.
+ */
+int audio_mix_play_stream(struct audio_mix *mix, audio_mix_render_t render, void *user_data,
+			  const struct audio_mix_voice_cfg *cfg);
+
+/**
+ * @brief Ramp a voice to a new gain and pan.
+ *
+ * @param mix Mixer instance.
+ * @param voice Voice handle.
+ * @param gain Q15 gain.
+ * @param pan Pan, -32767 to 32767.
+ * @param fade_ms Ramp time in milliseconds.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOENT if the voice has ended.
+ */
+int audio_mix_set_gain(struct audio_mix *mix, int voice, int16_t gain, int16_t pan,
+		       uint16_t fade_ms);
+
+/**
+ * @brief Fade a voice out and end it.
+ *
+ * @param mix Mixer instance.
+ * @param voice Voice handle.
+ * @param fade_ms Fade-out time in milliseconds, 0 to cut at the next block.
+ *
+ * @retval 0 if successful.
+ * @retval -ENOENT if the voice has ended.
+ */
+int audio_mix_stop(struct audio_mix *mix, int voice, uint16_t fade_ms);
+
+/**
+ * @brief Check whether a voice is still playing.
+ *
+ * @param mix Mixer instance.
+ * @param voice Voice handle.
+ *
+ * @retval true if the voice plays.
+ * @retval false if it has ended.
+ */
+bool audio_mix_is_playing(struct audio_mix *mix, int voice);
+
+/**
+ * @brief Mix one block of interleaved 16-bit samples.
+ *
+ * Has the signature of an audio_out producer, pass the mixer as its user
+ * data.
+ *
+ * @param block Output block.
+ * @param size Block size in bytes.
+ * @param user_data Mixer instance.
+ *
+ * @retval 0 always, the mixer plays silence when no voice is active.
+ */
+int audio_mix_fill(void *block, size_t size, void *user_data);
+
+/**
+ * @brief Get the mixer statistics.
+ *
+ * @param mix Mixer instance.
+ * @param stats Destination for the counters.
+ */
+void audio_mix_get_stats(struct audio_mix *mix, struct audio_mix_stats *stats);
+
+/**
+ * @brief Zero the mixer statistics.
+ *
+ * @param mix Mixer instance.
+ */
+void audio_mix_reset_stats(struct audio_mix *mix);
+
+/** @} */
+
+#endif /* APP_LIB_AUDIO_MIX_H_ */
@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_AUDIO_OSC_H_
+#define APP_LIB_AUDIO_OSC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @defgroup lib_audio_osc Audio oscillator
+ * @ingroup lib
+ * @{
+ *
+ * @brief Fixed-point direct digital synthesis of test and UI tones.
+ *
+ * A 32-bit phase accumulator advances by a per-sample step derived from the
+ * frequency, so the frequency resolution is @c rate / 2^32 and the phase
+ * wraps for free. The sine comes from a 256 entry Q15 table with linear
+ * interpolation on the next 16 phase bits, about 80 dB below full scale.
+ *
+ * Changing the frequency keeps the phase, so tones switch without a click.
+ * Square and saw waves are generated naively and alias above a few kHz.
+ */
+
+/** @brief Waveform of an oscillator */
+enum audio_osc_wave {
+	/** Interpolated sine */
+	AUDIO_OSC_SINE,
+	/** 50% duty square */
+	AUDIO_OSC_SQUARE,
+	/** Rising saw */
+	AUDIO_OSC_SAW,
+	/** White noise, the frequency is ignored */
+	AUDIO_OSC_NOISE,
+};
+
+/** @brief Oscillator state */
+struct audio_osc {
+	/** Phase, a full turn is 2^32 */
+	uint32_t phase;
+	/** Phase increment per sample */
+	uint32_t step;
+	/** Noise generator state, never 0 */
+	uint32_t seed;
+	/** Q15 output gain */
+	int16_t amplitude;
+	/** Waveform */
+	enum audio_osc_wave wave;
+};
+
+/**
+ * @brief Initialize an oscillator at phase 0.
+ *
+ * @param osc Oscillator.
+ * @param wave Waveform.
+ * @param freq_hz Frequency in Hz, below half of @p rate_hz.
+ * @param rate_hz Sample rate in Hz.
+ * @param amplitude Q15 gain, 32767 for full scale.
+ */
+void audio_osc_init(struct audio_osc *osc, enum audio_osc_wave wave, uint32_t freq_hz,
+		    uint32_t rate_hz, int16_t amplitude);
+
+/**
+ * @brief Change the frequency, keeping the phase.
+ *
+ * @param osc Oscillator.
+ * @param freq_hz Frequency in Hz, below half of @p rate_hz.
+ * @param rate_hz Sample rate in Hz.
+ */
+void audio_osc_set_freq(struct audio_osc *osc, uint32_t freq_hz, uint32_t rate_hz);
+
+/**
+ * @brief Q15 sine of a phase.
+ *
+ * @param phase Phase, a full turn is 2^32.
+ *
+ * @return sin(2 * pi * @p phase / 2^32) in Q15.
+ */
+int16_t audio_osc_sin(uint32_t phase);
+
+/**
+ * @brief Generate a block of interleaved 16-bit samples.
+ *
+ * Each frame gets the same sample on every channel.
+ *
+ * @param osc Oscillator.
+ * @param buf Destination, @p frames * @p channels samples.
+ * @param frames Number of frames.
+ * @param channels Samples per frame, at least 1.
+ */
+void audio_osc_fill(struct audio_osc *osc, int16_t *buf, size_t frames, size_t channels);
+
+/** @} */
+
+#endif /* APP_LIB_AUDIO_OSC_H_ */
@@ -0,0 +1,167 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_AUDIO_OUT_H_
+#define APP_LIB_AUDIO_OUT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2s.h>
+#include <zephyr/kernel.h>
+
+/**
+ * @defgroup lib_audio_out Audio output engine
+ * @ingroup lib
+ * @{
+ *
+ * @brief Block-queued I2S playback driven by a producer callback.
+ *
+ * The engine owns a thread and a memory slab of @p depth + 1 blocks. It keeps
+ * up to @p depth blocks queued on the I2S TX stream and calls the producer to
+ * fill the next block as soon as the DMA releases one. Underruns are
+ * recovered by restarting the stream from a freshly filled queue.
+ *
+ * Latency is set by the block size times the depth. Small blocks with a
+ * depth of 2 or 3 give a low latency path, large blocks with a depth of 2
+ * wake the CPU least often.
+ *
+ * A mono stream (@c channels = 1) halves the block memory and the DMA
+ * traffic of a mono codec. When the I2S controller has no mono mode, 16-bit
+ * mono is sent on two slots instead: the producer fills the first half of
+ * each block and the engine duplicates every frame in place. Blocks then
+ * hold half the playing time.
+ */
+
+/**
+ * @brief Producer callback, fills one block of interleaved samples.
+ *
+ * Runs on the engine thread. A non-zero return ends the stream: the block is
+ * dropped and the queued blocks are played out.
+ *
+ * @param block Block to fill.
+ * @param size Bytes to fill, half the block size when mono is expanded.
+ * @param user_data Pointer passed to audio_out_start().
+ *
+ * @retval 0 to queue the block.
+ * @retval non-zero to end the stream.
+ */
+typedef int (*audio_out_fill_t)(void *block, size_t size, void *user_data);
+
+/** @brief Playback statistics, accumulated since start or the last reset */
+struct audio_out_stats {
+	/** Blocks handed to the I2S driver */
+	uint32_t blocks;
+	/** Times the I2S queue ran dry and the stream was restarted */
+	uint32_t underruns;
+	/** Fills that took longer than the audio still queued */
+	uint32_t late_fills;
+	/** Fewest blocks queued when a fill started */
+	uint8_t min_depth;
+	/** Longest fill in microseconds */
+	uint32_t max_fill_us;
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct audio_out {
+	struct k_mem_slab *slab;
+	k_thread_stack_t *stack;
+	size_t stack_size;
+	size_t block_size;
+	uint8_t depth;
+
+	const struct device *i2s;
+	audio_out_fill_t fill;
+	void *user_data;
+	uint32_t block_us;
+	bool expand;
+
+	struct k_thread thread;
+	atomic_t stopping;
+	bool running;
+	struct audio_out_stats stats;
+};
+/** @endcond */
+
+/**
+ * @brief Statically define an audio output engine.
+ *
+ * @param _name Name of the engine object.
+ * @param _block_size Block size in bytes, a multiple of one frame.
+ * @param _depth Blocks kept queued on the I2S stream, at least 2.
+ */
+#define AUDIO_OUT_DEFINE(_name, _block_size, _depth)					\
+	BUILD_ASSERT((_depth) >= 2, "audio_out needs at least two queued blocks");	\
+	K_MEM_SLAB_DEFINE_STATIC(_name##_slab, _block_size, (_depth) + 1, 4);		\
+	K_THREAD_STACK_DEFINE(_name##_stack, CONFIG_AUDIO_OUT_STACK_SIZE);		\
+	struct audio_out _name = {							\
+		.slab = &_name##_slab,							\
+		.stack = _name##_stack,							\
+		.stack_size = K_THREAD_STACK_SIZEOF(_name##_stack),			\
+		.block_size = (_block_size),						\
+		.depth = (_depth),							\
+	}
+
+/**
+ * @brief Configure the I2S TX stream and start playback.
+ *
+ * The queue is filled before the stream starts, so the producer is called
+ * @p depth times before this function returns.
+ *
+ * @param out Engine defined with AUDIO_OUT_DEFINE().
+ * @param i2s I2S device.
+ * @param cfg Stream format. The memory slab and block size are the engine's.
+ * @param fill Producer callback.
+ * @param user_data Pointer passed to @p fill.
+ *
+ * @retval 0 if playback started.
+ * @retval -EBUSY if the engine is already running.
+ * @retval -EINVAL if the block size is not a multiple of one frame, or the
+ *         I2S controller rejects the format.
+ * @retval -errno Other negative errno code on failure.
+ */
+int audio_out_start(struct audio_out *out, const struct device *i2s,
+		    const struct i2s_config *cfg, audio_out_fill_t fill, void *user_data);
+
+/**
+ * @brief Stop playback after the queued blocks are played out.
+ *
+ * Also waits for a stream that the producer has ended.
+ *
+ * @param out Engine instance.
+ *
+ * @retval 0 if successful.
+ * @retval -EALREADY if the engine is not running.
+ */
+int audio_out_stop(struct audio_out *out);
+
+/**
+ * @brief Check whether mono frames are expanded to two I2S slots.
+ *
+ * @param out Engine instance.
+ *
+ * @retval true if the controller had no mono mode for the running stream.
+ * @retval false otherwise.
+ */
+bool audio_out_is_expanding(const struct audio_out *out);
+
+/**
+ * @brief Get the playback statistics.
+ *
+ * @param out Engine instance.
+ * @param stats Destination for the counters.
+ */
+void audio_out_get_stats(struct audio_out *out, struct audio_out_stats *stats);
+
+/**
+ * @brief Zero the playback statistics.
+ *
+ * @param out Engine instance.
+ */
+void audio_out_reset_stats(struct audio_out *out);
+
+/** @} */
+
+#endif /* APP_LIB_AUDIO_OUT_H_ */
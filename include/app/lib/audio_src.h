@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LIB_AUDIO_SRC_H_
+#define APP_LIB_AUDIO_SRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+/**
+ * @defgroup lib_audio_src Sample rate converter
+ * @ingroup lib
+ * @{
+ *
+ * @brief Fixed-point polyphase resampler for mono 16-bit streams.
+ *
+ * Content at any rate can play on a link whose rate is fixed by the codec
+ * clock tree. The converter runs a windowed-sinc low-pass split into
+ * @p phases sub-filters of @p taps each. Every output picks the sub-filter
+ * closest to its fractional position, tracked in Q32, so any ratio works
+ * and the output rate does not drift.
+ *
+ * More taps give a steeper filter, more phases a finer time grid. Taps span
+ * input samples, so a larger downsampling ratio needs more of them: 16 taps
+ * and 64 phases for 22.05 kHz to 16 kHz, 32 taps and 128 phases for
+ * 44.1 kHz to 16 kHz keep aliases 40 dB down. The filter is generated in
+ * integer arithmetic when the rates are set and the per-sample path is a Q14
+ * multiply-accumulate.
+ *
+ * Blocks are converted in place, the block must hold the larger of the
+ * input and the output.
+ */
+
+/** @cond INTERNAL_HIDDEN */
+struct audio_src {
+	int16_t *coeffs;
+	int16_t *hist;
+	uint16_t taps;
+	uint16_t phases;
+	uint8_t phase_shift;
+
+	uint32_t step_int;
+	uint32_t step_frac;
+	uint32_t frac;
+	uint32_t wait;
+	uint16_t head;
+};
+/** @endcond */
+
+/**
+ * @brief Statically define a sample rate converter.
+ *
+ * The coefficient table takes @p _taps * (@p _phases + 1) 16-bit words, the
+ * extra sub-filter serves positions that round up to the next input sample.
+ *
+ * @param _name Name of the converter object.
+ * @param _taps Taps of each sub-filter, even, 4 to 64.
+ * @param _phases Sub-filters, a power of two from 2 to 1024.
+ */
+#define AUDIO_SRC_DEFINE(_name, _taps, _phases)						\
+	BUILD_ASSERT(((_taps) % 2 == 0) && ((_taps) >= 4) && ((_taps) <= 64),		\
+		     "audio_src taps must be even, 4 to 64");				\
+	BUILD_ASSERT(IS_POWER_OF_TWO(_phases) && ((_phases) >= 2) && ((_phases) <= 1024),	\
+		     "audio_src phases must be a power of two, 2 to 1024");		\
+	static int16_t _name##_coeffs[((_phases) + 1) * (_taps)];				\
+	static int16_t _name##_hist[2 * (_taps)];					\
+	struct audio_src _name = {							\
+		.coeffs = _name##_coeffs,						\
+		.hist = _name##_hist,							\
+		.taps = (_taps),							\
+		.phases = (_phases),							\
+	}
+
+/**
+ * @brief Set the conversion ratio and clear the filter history.
+ *
+ * Generates the filter, with the cut-off below the lower of the two
+ * Nyquist frequencies. Both rates must be within a factor of 8.
+ *
+ * @param src Converter defined with AUDIO_SRC_DEFINE().
+ * @param in_rate Input rate in Hz.
+ * @param out_rate Output rate in Hz.
+ *
+ * @retval 0 if successful.
+ * @retval -EINVAL if a rate is 0 or the ratio is out of range.
+ */
+int audio_src_set_rates(struct audio_src *src, uint32_t in_rate, uint32_t out_rate);
+
+/**
+ * @brief Clear the filter history, as at the start of a stream.
+ *
+ * @param src Converter instance.
+ */
+void audio_src_reset(struct audio_src *src);
+
+/**
+ * @brief Most output frames that a number of input frames can produce.
+ *
+ * @param src Converter instance.
+ * @param in_frames Input frames.
+ *
+ * @return Output frame bound, the block capacity to pass to
+ *         audio_src_process().
+ */
+size_t audio_src_out_max(const struct audio_src *src, size_t in_frames);
+
+/**
+ * @brief Convert a block of mono samples in place.
+ *
+ * The filter history carries over from the previous block, so a stream can
+ * be split into blocks of any size. The output lags the input by half the
+ * taps plus one input sample.
+ *
+ * @param src Converter instance.
+ * @param block Block holding @p in_frames input samples at its start.
+ * @param in_frames Input frames.
+ * @param capacity Block size in frames, at least audio_src_out_max().
+ *
+ * @return Output frames written to the start of @p block.
+ */
+size_t audio_src_process(struct audio_src *src, int16_t *block, size_t in_frames,
+			 size_t capacity);
+
+/** @} */
+
+#endif /* APP_LIB_AUDIO_SRC_H_ */
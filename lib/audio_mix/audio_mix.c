@@ -0,0 +1,389 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/audio_mix.h>
+#include <app/lib/audio_osc.h>
+
+/* Voice handles carry a generation so a stale handle cannot reach a reused voice */
+#define AUDIO_MIX_HANDLE(_idx, _gen) (((int)(_gen) << 8) | (_idx))
+#define AUDIO_MIX_HANDLE_IDX(_h) ((_h) & 0xFF)
+#define AUDIO_MIX_HANDLE_GEN(_h) (((_h) >> 8) & 0xFF)
+
+const struct audio_mix_sound *audio_mix_cache_add(struct audio_mix_cache *cache, size_t frames,
+						  audio_mix_decode_t decode, void *user_data)
+{
+	struct audio_mix_sound *sound;
+	int16_t *dst;
+
+	if ((cache->num_sounds == cache->max_sounds) || (frames > cache->size - cache->used)) {
+		return NULL;
+	}
+
+	dst = &cache->arena[cache->used];
+	if (decode(dst, frames, user_data)) {
+		return NULL;
+	}
+
+	cache->used += frames;
+	sound = &cache->sounds[cache->num_sounds++];
+	sound->pcm = dst;
+	sound->frames = frames;
+
+	return sound;
+}
+
+static int audio_mix_copy(int16_t *dst, size_t frames, void *user_data)
+{
+	memcpy(dst, user_data, frames * sizeof(dst[0]));
+	return 0;
+}
+
+const struct audio_mix_sound *audio_mix_cache_copy(struct audio_mix_cache *cache,
+						   const int16_t *pcm, size_t frames)
+{
+	return audio_mix_cache_add(cache, frames, audio_mix_copy, (void *)pcm);
+}
+
+void audio_mix_cache_clear(struct audio_mix_cache *cache)
+{
+	cache->used = 0;
+	cache->num_sounds = 0;
+}
+
+void audio_mix_init(struct audio_mix *mix, uint32_t rate)
+{
+	k_spinlock_key_t key = k_spin_lock(&mix->lock);
+
+	for (uint8_t i = 0; i < mix->num_voices; i++) {
+		mix->voices[i].active = false;
+	}
+	mix->rate = rate;
+	mix->stats = (struct audio_mix_stats){0};
+
+	k_spin_unlock(&mix->lock, key);
+}
+
+static uint32_t audio_mix_ms_to_frames(const struct audio_mix *mix, uint16_t ms)
+{
+	return (uint32_t)(((uint64_t)ms * mix->rate) / MSEC_PER_SEC);
+}
+
+/* Q31 channel gains, constant-power pan: cos and sin over a quarter turn */
+static void audio_mix_pan(const struct audio_mix *mix, int16_t gain, int16_t pan,
+			  int32_t out[2])
+{
+	uint32_t turn;
+
+	if (mix->channels == 1) {
+		out[0] = (int32_t)gain << 16;
+		out[1] = 0;
+		return;
+	}
+
+	pan = MAX(pan, -INT16_MAX);
+	turn = (uint32_t)(((int64_t)(pan + INT16_MAX) << 30) / (2 * INT16_MAX));
+	out[0] = (int32_t)gain * audio_osc_sin(turn + BIT(30)) * 2;
+	out[1] = (int32_t)gain * audio_osc_sin(turn) * 2;
+}
+
+/* Post a ramp to new channel gains, the mixer picks it up at the next block */
+static void audio_mix_request(struct audio_mix *mix, struct audio_mix_voice *v,
+			      const int32_t gain[2], uint16_t fade_ms, bool stop)
+{
+	v->req_gain[0] = gain[0];
+	v->req_gain[1] = gain[1];
+	v->req_ramp = audio_mix_ms_to_frames(mix, fade_ms);
+	v->req_stop = stop;
+	v->req = true;
+}
+
+static int audio_mix_start(struct audio_mix *mix, const int16_t *pcm, uint32_t frames,
+			   audio_mix_render_t render, void *user_data,
+			   const struct audio_mix_voice_cfg *cfg)
+{
+	k_spinlock_key_t key = k_spin_lock(&mix->lock);
+	struct audio_mix_voice *v = NULL;
+	int32_t gain[2];
+	uint8_t i;
+
+	for (i = 0; i < mix->num_voices; i++) {
+		if (!mix->voices[i].active) {
+			v = &mix->voices[i];
+			break;
+		}
+	}
+	if (v == NULL) {
+		mix->stats.refused++;
+		k_spin_unlock(&mix->lock, key);
+		return -EBUSY;
+	}
+
+	v->pcm = pcm;
+	v->frames = frames;
+	v->pos = 0;
+	v->render = render;
+	v->user_data = user_data;
+	v->loop = cfg->loop && (render == NULL);
+	v->stopping = false;
+	v->gain[0] = 0;
+	v->gain[1] = 0;
+	v->ramp = 0;
+
+	/* A fade-in is a ramp from silence, no fade jumps there at the first block */
+	audio_mix_pan(mix, cfg->gain, cfg->pan, gain);
+	audio_mix_request(mix, v, gain, cfg->fade_ms, false);
+
+	v->gen++;
+	v->active = true;
+	k_spin_unlock(&mix->lock, key);
+
+	return AUDIO_MIX_HANDLE(i, v->gen);
+}
+
+int audio_mix_play(struct audio_mix *mix, const struct audio_mix_sound *sound,
+		   const struct audio_mix_voice_cfg *cfg)
+{
+	return audio_mix_start(mix, sound->pcm, sound->frames, NULL, NULL, cfg);
+}
+
+int audio_mix_play_stream(struct audio_mix *mix, audio_mix_render_t render, void *user_data,
+			  const struct audio_mix_voice_cfg *cfg)
+{
+	return audio_mix_start(mix, NULL, 0, render, user_data, cfg);
+}
+
+/* Voice of a handle, with the lock held, NULL once it has ended */
+static struct audio_mix_voice *audio_mix_voice_get(struct audio_mix *mix, int voice)
+{
+	struct audio_mix_voice *v;
+
+	if ((voice < 0) || (AUDIO_MIX_HANDLE_IDX(voice) >= mix->num_voices)) {
+		return NULL;
+	}
+
+	v = &mix->voices[AUDIO_MIX_HANDLE_IDX(voice)];
+	if (!v->active || (v->gen != AUDIO_MIX_HANDLE_GEN(voice)) || v->stopping ||
+	    (v->req && v->req_stop)) {
+		return NULL;
+	}
+
+	return v;
+}
+
+int audio_mix_set_gain(struct audio_mix *mix, int voice, int16_t gain, int16_t pan,
+		       uint16_t fade_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&mix->lock);
+	struct audio_mix_voice *v = audio_mix_voice_get(mix, voice);
+	int32_t gains[2];
+
+	if (v == NULL) {
+		k_spin_unlock(&mix->lock, key);
+		return -ENOENT;
+	}
+
+	audio_mix_pan(mix, gain, pan, gains);
+	audio_mix_request(mix, v, gains, fade_ms, false);
+	k_spin_unlock(&mix->lock, key);
+
+	return 0;
+}
+
+int audio_mix_stop(struct audio_mix *mix, int voice, uint16_t fade_ms)
+{
+	static const int32_t silence[2];
+	k_spinlock_key_t key = k_spin_lock(&mix->lock);
+	struct audio_mix_voice *v = audio_mix_voice_get(mix, voice);
+
+	if (v == NULL) {
+		k_spin_unlock(&mix->lock, key);
+		return -ENOENT;
+	}
+
+	audio_mix_request(mix, v, silence, fade_ms, true);
+	k_spin_unlock(&mix->lock, key);
+
+	return 0;
+}
+
+bool audio_mix_is_playing(struct audio_mix *mix, int voice)
+{
+	const struct audio_mix_voice *v;
+	k_spinlock_key_t key;
+	bool playing;
+
+	if ((voice < 0) || (AUDIO_MIX_HANDLE_IDX(voice) >= mix->num_voices)) {
+		return false;
+	}
+
+	v = &mix->voices[AUDIO_MIX_HANDLE_IDX(voice)];
+	key = k_spin_lock(&mix->lock);
+	playing = v->active && (v->gen == AUDIO_MIX_HANDLE_GEN(voice));
+	k_spin_unlock(&mix->lock, key);
+
+	return playing;
+}
+
+static inline int16_t audio_mix_sat(int32_t sample)
+{
+	return (int16_t)CLAMP(sample, INT16_MIN, INT16_MAX);
+}
+
+/*
+ * Add n samples of a voice to the output. Ramping frames update the gains
+ * per frame, the rest of the block runs with fixed Q15 gains.
+ */
+static void audio_mix_add(struct audio_mix_voice *v, int16_t *out, const int16_t *src,
+			  size_t n, uint8_t channels)
+{
+	int32_t g0, g1;
+	size_t i = 0;
+
+	for (; (i < n) && (v->ramp > 0); i++, v->ramp--) {
+		for (uint8_t ch = 0; ch < channels; ch++) {
+			v->gain[ch] += v->step[ch];
+			out[ch] = audio_mix_sat(out[ch] + ((src[i] * (v->gain[ch] >> 16)) >> 15));
+		}
+		out += channels;
+	}
+
+	g0 = v->gain[0] >> 16;
+	g1 = v->gain[1] >> 16;
+
+	if (channels == 1) {
+		for (; i < n; i++) {
+			*out = audio_mix_sat(*out + ((src[i] * g0) >> 15));
+			out++;
+		}
+	} else {
+		for (; i < n; i++) {
+			out[0] = audio_mix_sat(out[0] + ((src[i] * g0) >> 15));
+			out[1] = audio_mix_sat(out[1] + ((src[i] * g1) >> 15));
+			out += 2;
+		}
+	}
+}
+
+/* Take over a posted gain change, with the lock held */
+static void audio_mix_apply_request(struct audio_mix_voice *v)
+{
+	for (uint8_t ch = 0; ch < 2; ch++) {
+		if (v->req_ramp == 0) {
+			v->gain[ch] = v->req_gain[ch];
+			v->step[ch] = 0;
+		} else {
+			v->step[ch] = (int32_t)(((int64_t)v->req_gain[ch] - v->gain[ch]) /
+						(int32_t)v->req_ramp);
+		}
+	}
+	v->ramp = v->req_ramp;
+	v->stopping = v->req_stop;
+	v->req = false;
+}
+
+/*
+ * Mix one voice into frames of output. Returns false once the voice has
+ * ended: its sound ran out, its stream stopped or its fade-out completed.
+ */
+static bool audio_mix_render_voice(struct audio_mix *mix, struct audio_mix_voice *v,
+				   int16_t *out, size_t frames)
+{
+	const uint8_t channels = mix->channels;
+	size_t done = 0;
+
+	if (v->stopping && (v->ramp == 0)) {
+		return false;
+	}
+
+	while (done < frames) {
+		const int16_t *src;
+		bool ended;
+		size_t n;
+
+		if (v->render != NULL) {
+			const size_t want = MIN(frames - done, mix->scratch_frames);
+
+			n = v->render(mix->scratch, want, v->user_data);
+			src = mix->scratch;
+			ended = (n < want);
+		} else {
+			n = MIN(frames - done, v->frames - v->pos);
+			src = &v->pcm[v->pos];
+			v->pos += n;
+			ended = (v->pos == v->frames) && (!v->loop || (v->frames == 0));
+			if (v->pos == v->frames) {
+				v->pos = 0;
+			}
+		}
+
+		audio_mix_add(v, &out[done * channels], src, n, channels);
+		done += n;
+
+		if (ended || (v->stopping && (v->ramp == 0))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int audio_mix_fill(void *block, size_t size, void *user_data)
+{
+	struct audio_mix *mix = user_data;
+	const size_t frames = size / (mix->channels * sizeof(int16_t));
+	const uint32_t start = k_cycle_get_32();
+	uint8_t playing = 0;
+	k_spinlock_key_t key;
+	uint32_t cycles;
+
+	memset(block, 0, size);
+
+	for (uint8_t i = 0; i < mix->num_voices; i++) {
+		struct audio_mix_voice *v = &mix->voices[i];
+
+		/*
+		 * Control calls only post requests to an active voice, so the
+		 * mixer owns its state outside of these two short sections.
+		 */
+		key = k_spin_lock(&mix->lock);
+		if (!v->active) {
+			k_spin_unlock(&mix->lock, key);
+			continue;
+		}
+		if (v->req) {
+			audio_mix_apply_request(v);
+		}
+		k_spin_unlock(&mix->lock, key);
+
+		playing++;
+		if (!audio_mix_render_voice(mix, v, block, frames)) {
+			key = k_spin_lock(&mix->lock);
+			v->active = false;
+			k_spin_unlock(&mix->lock, key);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+	mix->stats.blocks++;
+	mix->stats.max_cycles = MAX(mix->stats.max_cycles, cycles);
+	mix->stats.max_voices = MAX(mix->stats.max_voices, playing);
+
+	return 0;
+}
+
+void audio_mix_get_stats(struct audio_mix *mix, struct audio_mix_stats *stats)
+{
+	*stats = mix->stats;
+}
+
+void audio_mix_reset_stats(struct audio_mix *mix)
+{
+	mix->stats = (struct audio_mix_stats){0};
+}
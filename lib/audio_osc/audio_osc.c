@@ -0,0 +1,151 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/audio_osc.h>
+
+#define AUDIO_OSC_LUT_BITS 8
+#define AUDIO_OSC_FRAC_BITS 16
+#define AUDIO_OSC_FRAC_SHIFT (32 - AUDIO_OSC_LUT_BITS - AUDIO_OSC_FRAC_BITS)
+
+/* One turn of sin() in Q15, the last entry repeats the first for interpolation */
+static const int16_t audio_osc_lut[BIT(AUDIO_OSC_LUT_BITS) + 1] = {
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+	6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+	18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+	27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+	32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+	32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+	30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+	27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+	23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+	18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+	12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+	6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+	0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+	-6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+	-12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+	-18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+	-23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+	-27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+	-30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+	-32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+	-32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+	-32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+	-30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+	-27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+	-23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+	-18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+	-12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179,
+	-6393, -5602, -4808, -4011, -3212, -2410, -1608, -804,
+	0,
+};
+
+static inline int16_t audio_osc_gain(int32_t sample, int16_t amplitude)
+{
+	return (int16_t)((sample * amplitude) >> 15);
+}
+
+int16_t audio_osc_sin(uint32_t phase)
+{
+	const uint32_t idx = phase >> (32 - AUDIO_OSC_LUT_BITS);
+	const int32_t frac = (phase >> AUDIO_OSC_FRAC_SHIFT) & BIT_MASK(AUDIO_OSC_FRAC_BITS);
+	const int32_t a = audio_osc_lut[idx];
+	const int32_t b = audio_osc_lut[idx + 1];
+
+	return (int16_t)(a + (((b - a) * frac) >> AUDIO_OSC_FRAC_BITS));
+}
+
+void audio_osc_set_freq(struct audio_osc *osc, uint32_t freq_hz, uint32_t rate_hz)
+{
+	__ASSERT((rate_hz > 0) && (freq_hz <= rate_hz / 2), "%u Hz at %u Hz", freq_hz, rate_hz);
+
+	osc->step = (uint32_t)(((uint64_t)freq_hz << 32) / rate_hz);
+}
+
+void audio_osc_init(struct audio_osc *osc, enum audio_osc_wave wave, uint32_t freq_hz,
+		    uint32_t rate_hz, int16_t amplitude)
+{
+	osc->phase = 0;
+	osc->seed = 0x2545F491;
+	osc->amplitude = amplitude;
+	osc->wave = wave;
+	audio_osc_set_freq(osc, freq_hz, rate_hz);
+}
+
+/* xorshift32, full period over the non-zero states */
+static inline uint32_t audio_osc_noise(uint32_t *seed)
+{
+	uint32_t x = *seed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*seed = x;
+
+	return x;
+}
+
+/*
+ * One loop per waveform keeps the branch out of the per-sample path. The
+ * channel loop only stores, the sample is computed once per frame.
+ */
+void audio_osc_fill(struct audio_osc *osc, int16_t *buf, size_t frames, size_t channels)
+{
+	const int16_t amplitude = osc->amplitude;
+	const uint32_t step = osc->step;
+	uint32_t phase = osc->phase;
+	int16_t sample;
+
+	switch (osc->wave) {
+	case AUDIO_OSC_SINE:
+		for (size_t i = 0; i < frames; i++) {
+			sample = audio_osc_gain(audio_osc_sin(phase), amplitude);
+			for (size_t ch = 0; ch < channels; ch++) {
+				*buf++ = sample;
+			}
+			phase += step;
+		}
+		break;
+	case AUDIO_OSC_SQUARE:
+		for (size_t i = 0; i < frames; i++) {
+			sample = (phase & BIT(31)) ? -amplitude : amplitude;
+			for (size_t ch = 0; ch < channels; ch++) {
+				*buf++ = sample;
+			}
+			phase += step;
+		}
+		break;
+	case AUDIO_OSC_SAW:
+		for (size_t i = 0; i < frames; i++) {
+			/* Half a turn ahead so the ramp starts at the bottom */
+			sample = audio_osc_gain((int16_t)((phase ^ BIT(31)) >> 16), amplitude);
+			for (size_t ch = 0; ch < channels; ch++) {
+				*buf++ = sample;
+			}
+			phase += step;
+		}
+		break;
+	case AUDIO_OSC_NOISE:
+		for (size_t i = 0; i < frames; i++) {
+			sample = audio_osc_gain((int16_t)(audio_osc_noise(&osc->seed) >> 16),
+						amplitude);
+			for (size_t ch = 0; ch < channels; ch++) {
+				*buf++ = sample;
+			}
+		}
+		break;
+	default:
+		__ASSERT(false, "unknown waveform %d", osc->wave);
+		break;
+	}
+
+	osc->phase = phase;
+}
@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/audio_out.h>
+
+LOG_MODULE_REGISTER(audio_out, CONFIG_AUDIO_OUT_LOG_LEVEL);
+
+/* Outcome of audio_out_queue() besides 0 and -errno */
+#define AUDIO_OUT_END 1
+
+static size_t audio_out_frame_size(const struct i2s_config *cfg)
+{
+	/* Samples wider than 16 bits take a full word in memory */
+	const size_t sample = (cfg->word_size <= 8) ? 1 : (cfg->word_size <= 16) ? 2 : 4;
+
+	return sample * cfg->channels;
+}
+
+/*
+ * Duplicate the mono frames at the start of a block into both slots. Back to
+ * front so it works in place, one 32-bit store per frame.
+ */
+static void audio_out_expand(void *block, size_t frames)
+{
+	const uint16_t *src = block;
+	uint32_t *dst = block;
+
+	for (size_t i = frames; i > 0; i--) {
+		dst[i - 1] = src[i - 1] * 0x00010001U;
+	}
+}
+
+/*
+ * Take a free block, have the producer fill it and queue it. Late fills and
+ * the queue depth are only meaningful while the stream runs.
+ */
+static int audio_out_queue(struct audio_out *out, k_timeout_t timeout, bool streaming)
+{
+	uint32_t queued, start, fill_us;
+	void *block;
+	int ret;
+
+	ret = k_mem_slab_alloc(out->slab, &block, timeout);
+	if (ret) {
+		return ret;
+	}
+
+	/* Every other used block is owned by the driver */
+	queued = k_mem_slab_num_used_get(out->slab) - 1;
+
+	start = k_cycle_get_32();
+	if (out->expand) {
+		/* Half the block holds the mono frames of a stereo block */
+		ret = out->fill(block, out->block_size / 2, out->user_data);
+		if (ret == 0) {
+			audio_out_expand(block, out->block_size / sizeof(uint32_t));
+		}
+	} else {
+		ret = out->fill(block, out->block_size, out->user_data);
+	}
+	fill_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	out->stats.max_fill_us = MAX(out->stats.max_fill_us, fill_us);
+	if (streaming) {
+		out->stats.min_depth = MIN(out->stats.min_depth, queued);
+		if (fill_us > queued * out->block_us) {
+			out->stats.late_fills++;
+		}
+	}
+
+	if (ret) {
+		k_mem_slab_free(out->slab, block);
+		return AUDIO_OUT_END;
+	}
+
+	ret = i2s_write(out->i2s, block, out->block_size);
+	if (ret) {
+		k_mem_slab_free(out->slab, block);
+		return ret;
+	}
+
+	out->stats.blocks++;
+	return 0;
+}
+
+/* Fill the whole queue, then start the stream */
+static int audio_out_prime(struct audio_out *out)
+{
+	int ret;
+
+	for (uint8_t i = 0; i < out->depth; i++) {
+		ret = audio_out_queue(out, K_NO_WAIT, false);
+		if (ret == AUDIO_OUT_END) {
+			break;
+		}
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return i2s_trigger(out->i2s, I2S_DIR_TX, I2S_TRIGGER_START);
+}
+
+/* Played out blocks return to the slab, the last one ends the drain */
+static void audio_out_drain(struct audio_out *out)
+{
+	if (i2s_trigger(out->i2s, I2S_DIR_TX, I2S_TRIGGER_DRAIN)) {
+		(void)i2s_trigger(out->i2s, I2S_DIR_TX, I2S_TRIGGER_DROP);
+		return;
+	}
+
+	while (k_mem_slab_num_used_get(out->slab) > 0) {
+		k_sleep(K_USEC(out->block_us));
+	}
+}
+
+static void audio_out_thread(void *p1, void *p2, void *p3)
+{
+	struct audio_out *out = p1;
+	/* A block is released at least once per period while the stream runs */
+	const k_timeout_t timeout = K_USEC(out->block_us * (out->depth + 1));
+	int ret;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!atomic_get(&out->stopping)) {
+		ret = audio_out_queue(out, timeout, true);
+		if (ret == 0) {
+			continue;
+		}
+		if (ret == AUDIO_OUT_END) {
+			break;
+		}
+
+		/* The driver rejects writes once the queue ran dry */
+		if (ret == -EIO) {
+			out->stats.underruns++;
+			LOG_WRN("underrun, restarting stream");
+		} else {
+			LOG_ERR("stream stalled: %d, restarting", ret);
+		}
+
+		(void)i2s_trigger(out->i2s, I2S_DIR_TX, I2S_TRIGGER_DROP);
+		ret = audio_out_prime(out);
+		if (ret) {
+			LOG_ERR("restart failed: %d", ret);
+			(void)i2s_trigger(out->i2s, I2S_DIR_TX, I2S_TRIGGER_DROP);
+			return;
+		}
+	}
+
+	audio_out_drain(out);
+}
+
+int audio_out_start(struct audio_out *out, const struct device *i2s,
+		    const struct i2s_config *cfg, audio_out_fill_t fill, void *user_data)
+{
+	struct i2s_config i2s_cfg = *cfg;
+	size_t frame;
+	int ret;
+
+	if (out->running) {
+		return -EBUSY;
+	}
+
+	frame = audio_out_frame_size(cfg);
+	if ((cfg->frame_clk_freq == 0) || (frame == 0) || (out->block_size % frame)) {
+		LOG_ERR("block size %zu does not hold whole frames", out->block_size);
+		return -EINVAL;
+	}
+
+	i2s_cfg.mem_slab = out->slab;
+	i2s_cfg.block_size = out->block_size;
+	ret = i2s_configure(i2s, I2S_DIR_TX, &i2s_cfg);
+
+	/* Controllers without a mono mode get 16-bit mono expanded to two slots */
+	out->expand = false;
+	if (((ret == -EINVAL) || (ret == -ENOTSUP)) && (cfg->channels == 1) &&
+	    (cfg->word_size == 16) && (out->block_size % sizeof(uint32_t) == 0)) {
+		LOG_DBG("no mono TX, expanding to two slots");
+		i2s_cfg.channels = 2;
+		frame = audio_out_frame_size(&i2s_cfg);
+		out->expand = true;
+		ret = i2s_configure(i2s, I2S_DIR_TX, &i2s_cfg);
+	}
+	if (ret) {
+		LOG_ERR("configure I2S TX failed: %d", ret);
+		return ret;
+	}
+
+	out->i2s = i2s;
+	out->fill = fill;
+	out->user_data = user_data;
+	out->block_us = (uint64_t)(out->block_size / frame) * USEC_PER_SEC / cfg->frame_clk_freq;
+	atomic_set(&out->stopping, 0);
+	audio_out_reset_stats(out);
+
+	ret = audio_out_prime(out);
+	if (ret) {
+		LOG_ERR("start failed: %d", ret);
+		(void)i2s_trigger(i2s, I2S_DIR_TX, I2S_TRIGGER_DROP);
+		return ret;
+	}
+
+	out->running = true;
+	k_thread_create(&out->thread, out->stack, out->stack_size, audio_out_thread, out, NULL,
+			NULL, CONFIG_AUDIO_OUT_THREAD_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&out->thread, "audio_out");
+
+	return 0;
+}
+
+int audio_out_stop(struct audio_out *out)
+{
+	if (!out->running) {
+		return -EALREADY;
+	}
+
+	atomic_set(&out->stopping, 1);
+	(void)k_thread_join(&out->thread, K_FOREVER);
+	out->running = false;
+
+	return 0;
+}
+
+bool audio_out_is_expanding(const struct audio_out *out)
+{
+	return out->expand;
+}
+
+void audio_out_get_stats(struct audio_out *out, struct audio_out_stats *stats)
+{
+	*stats = out->stats;
+}
+
+void audio_out_reset_stats(struct audio_out *out)
+{
+	out->stats = (struct audio_out_stats){
+		.min_depth = out->depth,
+	};
+}
@@ -0,0 +1,190 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/math_extras.h>
+#include <zephyr/sys/util.h>
+
+#include <app/lib/audio_osc.h>
+#include <app/lib/audio_src.h>
+
+/*
+ * Q14 coefficients keep the sum of products in 32 bits: a windowed sinc has
+ * an absolute sum below 2, so 64 taps of full scale input stay below 2^31.
+ */
+#define AUDIO_SRC_COEFF_BITS 14
+#define AUDIO_SRC_MAX_RATIO 8
+
+/* pi in Q16 */
+#define AUDIO_SRC_PI_Q16 205887
+/* Cut-off as a fraction of the lower Nyquist frequency, Q16 */
+#define AUDIO_SRC_ROLLOFF_Q16 58982
+
+/*
+ * Blackman window at t, in Q15. t is in Q16 input samples from the centre
+ * of a window spanning @p taps samples.
+ */
+static int32_t audio_src_window(int32_t t, uint16_t taps)
+{
+	/* t / taps turns, cos() is sin() a quarter turn ahead */
+	const uint32_t turn = (uint32_t)(((int64_t)t << 16) / taps);
+	const int32_t cos1 = audio_osc_sin(turn + BIT(30));
+	const int32_t cos2 = audio_osc_sin(2 * turn + BIT(30));
+
+	/* 0.42 + 0.5 cos(2 pi x) + 0.08 cos(4 pi x) */
+	return 13763 + cos1 / 2 + ((2621 * cos2) >> 15);
+}
+
+/*
+ * Low-pass impulse response at t, in Q16. t is in Q16 input samples and
+ * cutoff in Q16 cycles per input sample: sin(2 pi fc t) / (pi t).
+ */
+static int32_t audio_src_sinc(int32_t t, uint32_t cutoff)
+{
+	int32_t s;
+
+	if (t == 0) {
+		return 2 * cutoff;
+	}
+
+	s = audio_osc_sin((uint32_t)((int64_t)cutoff * t));
+
+	return (int32_t)(((int64_t)s << 33) / ((int64_t)AUDIO_SRC_PI_Q16 * t));
+}
+
+/*
+ * Sub-filter p holds the response at offsets (k - taps / 2 + p / phases)
+ * from the output position, oldest sample first. Sub-filter p = phases is
+ * the one a whole sample later, for positions rounding up to it. Every
+ * sub-filter is scaled to a DC gain of exactly 1 so no phase adds a tone at
+ * the phase rate.
+ */
+static void audio_src_gen(struct audio_src *src, uint32_t cutoff)
+{
+	const uint16_t taps = src->taps;
+	int32_t h[64];
+
+	for (uint16_t p = 0; p <= src->phases; p++) {
+		int16_t *c = &src->coeffs[p * taps];
+		const int32_t frac = (int32_t)(((uint32_t)p << 16) >> src->phase_shift);
+		int64_t sum = 0;
+		int32_t total = 0;
+		uint16_t peak = 0;
+
+		for (uint16_t k = 0; k < taps; k++) {
+			/* k = 0 is the oldest sample of the window */
+			const int32_t t = ((int32_t)(taps - 1 - k - taps / 2) << 16) + frac;
+
+			h[k] = (int32_t)(((int64_t)audio_src_sinc(t, cutoff) *
+					  audio_src_window(t, taps)) >> 15);
+			sum += h[k];
+		}
+
+		for (uint16_t k = 0; k < taps; k++) {
+			c[k] = (int16_t)(((int64_t)h[k] << AUDIO_SRC_COEFF_BITS) / sum);
+			total += c[k];
+			if (c[k] > c[peak]) {
+				peak = k;
+			}
+		}
+		/* Rounding leftovers go to the largest tap */
+		c[peak] += (1 << AUDIO_SRC_COEFF_BITS) - total;
+	}
+}
+
+void audio_src_reset(struct audio_src *src)
+{
+	memset(src->hist, 0, 2 * src->taps * sizeof(src->hist[0]));
+	src->head = 0;
+	src->frac = 0;
+	src->wait = 0;
+}
+
+int audio_src_set_rates(struct audio_src *src, uint32_t in_rate, uint32_t out_rate)
+{
+	uint64_t step;
+
+	if ((in_rate == 0) || (out_rate == 0) ||
+	    (in_rate > AUDIO_SRC_MAX_RATIO * out_rate) ||
+	    (out_rate > AUDIO_SRC_MAX_RATIO * in_rate)) {
+		return -EINVAL;
+	}
+
+	/* Input samples per output sample, Q32 */
+	step = ((uint64_t)in_rate << 32) / out_rate;
+	src->step_int = (uint32_t)(step >> 32);
+	src->step_frac = (uint32_t)step;
+	src->phase_shift = (uint8_t)u32_count_trailing_zeros(src->phases);
+
+	/* Half a cycle per sample at the lower rate, with some room for the roll-off */
+	audio_src_gen(src, (uint32_t)(((uint64_t)MIN(in_rate, out_rate) *
+				       AUDIO_SRC_ROLLOFF_Q16 / 2) / in_rate));
+	audio_src_reset(src);
+
+	return 0;
+}
+
+size_t audio_src_out_max(const struct audio_src *src, size_t in_frames)
+{
+	const uint64_t step = ((uint64_t)src->step_int << 32) | src->step_frac;
+
+	return (size_t)(((uint64_t)in_frames << 32) / step) + 2;
+}
+
+static inline int16_t audio_src_dot(const int16_t *win, const int16_t *c, uint16_t taps)
+{
+	int32_t acc = BIT(AUDIO_SRC_COEFF_BITS - 1);
+
+	for (uint16_t k = 0; k < taps; k++) {
+		acc += win[k] * c[k];
+	}
+	acc >>= AUDIO_SRC_COEFF_BITS;
+
+	return (int16_t)CLAMP(acc, INT16_MIN, INT16_MAX);
+}
+
+/*
+ * The history is written twice, taps apart, so the window of the newest
+ * taps samples is always contiguous at hist[head]. Each output is due once
+ * "wait" more inputs have been pushed, outputs never run ahead of inputs
+ * when downsampling, so they can overwrite the block in place. Upsampling
+ * moves the input to the end of the block first.
+ */
+size_t audio_src_process(struct audio_src *src, int16_t *block, size_t in_frames,
+			 size_t capacity)
+{
+	const uint16_t taps = src->taps;
+	const int16_t *in = block;
+	int16_t *hist = src->hist;
+	size_t out = 0;
+
+	__ASSERT(capacity >= audio_src_out_max(src, in_frames), "block too small");
+
+	if (src->step_int == 0) {
+		in = memmove(&block[capacity - in_frames], block, in_frames * sizeof(block[0]));
+	}
+
+	for (size_t i = 0; i < in_frames; i++) {
+		hist[src->head] = in[i];
+		hist[src->head + taps] = in[i];
+		src->head = (src->head + 1 == taps) ? 0 : src->head + 1;
+
+		while (src->wait == 0) {
+			/* Nearest sub-filter, one bit more than the phase index rounds */
+			const uint32_t phase = ((src->frac >> (31 - src->phase_shift)) + 1) >> 1;
+			const uint32_t frac = src->frac;
+
+			block[out++] = audio_src_dot(&hist[src->head], &src->coeffs[phase * taps],
+						     taps);
+			src->frac += src->step_frac;
+			src->wait = src->step_int + ((src->frac < frac) ? 1 : 0);
+		}
+		src->wait--;
+	}
+
+	return out;
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_TESTS_COMMON_BENCH_H_
+#define APP_TESTS_COMMON_BENCH_H_
+
+#include <stdint.h>
+
+#include <zephyr/sys/time_units.h>
+#include <zephyr/sys/util.h>
+
+#include <native_rtc.h>
+
+/*
+ * Benchmarks in the test suites time themselves with the host clock. The
+ * cycle counter of native_sim is simulated time, which does not move while
+ * the code under test runs. Host time includes preemption by other host
+ * processes, so each kernel is run BENCH_RUNS times and the fastest run is
+ * reported.
+ */
+
+/** Runs of each benchmarked kernel */
+#define BENCH_RUNS 16
+
+/** Start timing a run, returns the host time in ns */
+static inline uint64_t bench_start(void)
+{
+	uint32_t nsec;
+	uint64_t sec;
+
+	native_rtc_gettime(RTC_CLOCK_PSEUDOHOSTREALTIME, &nsec, &sec);
+
+	return sec * NSEC_PER_SEC + nsec;
+}
+
+/** Stop timing a run started at @p start, keeping the fastest run in @p best */
+static inline void bench_stop(uint64_t *best, uint64_t start)
+{
+	*best = MIN(*best, bench_start() - start);
+}
+
+#endif /* APP_TESTS_COMMON_BENCH_H_ */
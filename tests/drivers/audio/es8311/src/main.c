@@ -0,0 +1,574 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test es8311 driver
+ *
+ * This suite runs the ES8311 driver against the register-level I2C
+ * emulator. Besides the functional checks it reports the bus traffic of
+ * each codec operation, so extra transfers show up before they reach
+ * hardware.
+ */
+
+#include <zephyr/audio/codec.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/audio/es8311.h>
+#include <app/drivers/audio/es8311_emul.h>
+
+/* Register map, kept local so the suite does not depend on driver internals */
+#define REG_RESET 0x00
+#define REG_CLKMGR1 0x01
+#define REG_CLKMGR2 0x02
+#define REG_CLKMGR5 0x05
+#define REG_CLKMGR6 0x06
+#define REG_CLKMGR7 0x07
+#define REG_CLKMGR8 0x08
+#define REG_SDP_IN 0x09
+#define REG_SDP_OUT 0x0A
+#define REG_SYS4 0x0E
+#define REG_SYS10 0x14
+#define REG_ADC3 0x17
+#define REG_ADC4 0x18
+#define REG_ADC5 0x19
+#define REG_ADC8 0x1C
+#define REG_ADCEQ1 0x1D
+#define REG_DAC1 0x31
+#define REG_DAC2 0x32
+#define REG_DAC4 0x34
+#define REG_DAC5 0x35
+#define REG_DAC6 0x37
+#define REG_DACEQ1 0x38
+
+#define RESET_MSC BIT(6)
+#define CLKMGR1_MCLK_SEL BIT(7)
+#define CLKMGR1_ADC_ON (BIT(3) | BIT(1))
+#define CLKMGR6_DIV_BCLK_MASK GENMASK(4, 0)
+#define SDP_IN_SEL BIT(7)
+#define SDP_MUTE BIT(6)
+#define SDP_LRP BIT(5)
+#define SDP_WL_MASK GENMASK(4, 2)
+#define SDP_FMT_MASK GENMASK(1, 0)
+#define SYS4_PDN_ADC (BIT(6) | BIT(5))
+#define SYS10_DMIC_ON BIT(6)
+#define SYS10_LINESEL_MASK GENMASK(5, 4)
+#define DAC1_MUTE (BIT(6) | BIT(5))
+#define ADC8_EQBYPASS BIT(6)
+#define ADC8_HPF BIT(5)
+#define DAC6_EQBYPASS BIT(3)
+
+/* Minimum time the codec has to stay in reset during init */
+#define RESET_HOLD_MS 5
+
+/* MCLK of the first instance, see boards/native_sim.overlay */
+#define MCLK_FREQ 12288000
+
+struct es8311_fixture {
+	const struct device *dev;
+	const struct emul *target;
+	/* Instance without MCLK */
+	const struct device *dev_b;
+	const struct emul *target_b;
+	/* Reset hold time of the init of each instance */
+	uint32_t reset_hold;
+	uint32_t reset_hold_b;
+};
+
+/* Every rate of the driver's MCLK coefficient table */
+static const uint32_t rates[] = {
+	8000, 11025, 16000, 22050, 32000, 44100, 48000, 64000, 88200, 96000,
+};
+
+static int configure_route(const struct device *dev, audio_route_t route,
+			   audio_dai_type_t type, uint32_t rate, uint8_t word_size,
+			   uint8_t channels, bool provider)
+{
+	struct audio_codec_cfg cfg = {
+		.dai_type = type,
+		.dai_route = route,
+		.dai_cfg.i2s = {
+			.word_size = word_size,
+			.channels = channels,
+			.format = I2S_FMT_DATA_FORMAT_I2S,
+			.options = provider ?
+				(I2S_OPT_FRAME_CLK_MASTER | I2S_OPT_BIT_CLK_MASTER) :
+				(I2S_OPT_FRAME_CLK_SLAVE | I2S_OPT_BIT_CLK_SLAVE),
+			.frame_clk_freq = rate,
+		},
+	};
+
+	return audio_codec_configure(dev, &cfg);
+}
+
+static int configure_channels(const struct device *dev, audio_dai_type_t type,
+			      uint32_t rate, uint8_t word_size, uint8_t channels, bool provider)
+{
+	return configure_route(dev, AUDIO_ROUTE_PLAYBACK, type, rate, word_size, channels,
+			       provider);
+}
+
+static int configure(const struct device *dev, audio_dai_type_t type, uint32_t rate,
+		     uint8_t word_size, bool provider)
+{
+	return configure_channels(dev, type, rate, word_size, 2, provider);
+}
+
+static void set_volume(const struct device *dev, uint8_t vol)
+{
+	audio_property_value_t val = {.vol = vol};
+
+	zassert_ok(audio_codec_set_property(dev, AUDIO_PROPERTY_OUTPUT_VOLUME,
+		AUDIO_CHANNEL_ALL, val));
+}
+
+static void report(const struct emul *target, const char *op, struct es8311_emul_stats *stats)
+{
+	es8311_emul_get_stats(target, stats);
+	TC_PRINT("%s: %u transfers, %u bytes\n", op, stats->transfers, stats->bytes);
+	es8311_emul_reset_stats(target);
+}
+
+static void *es8311_setup(void)
+{
+	static struct es8311_fixture fixture = {
+		.dev = DEVICE_DT_GET(DT_NODELABEL(es8311)),
+		.target = EMUL_DT_GET(DT_NODELABEL(es8311)),
+		.dev_b = DEVICE_DT_GET(DT_NODELABEL(es8311_b)),
+		.target_b = EMUL_DT_GET(DT_NODELABEL(es8311_b)),
+	};
+	struct es8311_emul_stats stats;
+
+	zassert_true(device_is_ready(fixture.dev), "es8311 not ready");
+	zassert_true(device_is_ready(fixture.dev_b), "es8311_b not ready");
+	zassert_ok(es8311_init_wait(fixture.dev, K_SECONDS(1)), "es8311 init failed");
+	zassert_ok(es8311_init_wait(fixture.dev_b, K_SECONDS(1)), "es8311_b init failed");
+
+	/* Later tests power-cycle the emulator, keep what init did */
+	fixture.reset_hold = es8311_emul_get_reset_hold(fixture.target);
+	fixture.reset_hold_b = es8311_emul_get_reset_hold(fixture.target_b);
+
+	/* Everything the emulator has seen so far is the init sequence */
+	report(fixture.target, "init", &stats);
+	es8311_emul_reset_stats(fixture.target_b);
+
+	return &fixture;
+}
+
+static void es8311_before(void *f)
+{
+	struct es8311_fixture *fixture = f;
+
+	es8311_emul_reset_stats(fixture->target);
+	es8311_emul_reset_stats(fixture->target_b);
+}
+
+ZTEST_F(es8311, test_init)
+{
+	zassert_false(es8311_emul_in_reset(fixture->target), "codec still in reset");
+	zassert_false(es8311_emul_in_reset(fixture->target_b), "codec still in reset");
+	zassert_true(fixture->reset_hold >= RESET_HOLD_MS, "reset held %u ms",
+		     fixture->reset_hold);
+	zassert_true(fixture->reset_hold_b >= RESET_HOLD_MS, "reset held %u ms",
+		     fixture->reset_hold_b);
+
+	/* Default volume and the devicetree microphone settings */
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC2), 240);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SYS10), (1 << 4) | 4);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC8) & ADC8_HPF, ADC8_HPF);
+	zassert_equal(es8311_emul_get_reg(fixture->target_b, REG_ADC8) & ADC8_HPF, 0);
+}
+
+ZTEST_F(es8311, test_dai_types)
+{
+	static const struct {
+		audio_dai_type_t type;
+		uint8_t sdp;
+	} types[] = {
+		{AUDIO_DAI_TYPE_I2S, 0x00},
+		{AUDIO_DAI_TYPE_LEFT_JUSTIFIED, 0x01},
+		{AUDIO_DAI_TYPE_PCMA, 0x03},
+		{AUDIO_DAI_TYPE_PCMB, SDP_LRP | 0x03},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(types); i++) {
+		zassert_ok(configure(fixture->dev, types[i].type, 48000, 16, false));
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_IN) &
+			(SDP_FMT_MASK | SDP_LRP), types[i].sdp, "type %d", types[i].type);
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) &
+			(SDP_FMT_MASK | SDP_LRP), types[i].sdp, "type %d", types[i].type);
+	}
+
+	zassert_equal(configure(fixture->dev, AUDIO_DAI_TYPE_RIGHT_JUSTIFIED, 48000, 16, false),
+		-ENOTSUP);
+}
+
+ZTEST_F(es8311, test_word_sizes)
+{
+	static const struct {
+		uint8_t word_size;
+		uint8_t wl;
+	} sizes[] = {
+		{16, 0x03}, {18, 0x02}, {20, 0x01}, {24, 0x00}, {32, 0x04},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, sizes[i].word_size,
+			false));
+		zassert_equal(FIELD_GET(SDP_WL_MASK,
+			es8311_emul_get_reg(fixture->target, REG_SDP_IN)), sizes[i].wl,
+			"%u bit", sizes[i].word_size);
+	}
+
+	zassert_equal(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 8, false), -EINVAL);
+}
+
+ZTEST_F(es8311, test_rates_bclk)
+{
+	/* 16 bit stereo BCLK is 32 fs, every rate is multiplied by 8 up to 256 fs */
+	for (size_t i = 0; i < ARRAY_SIZE(rates); i++) {
+		zassert_ok(configure(fixture->dev_b, AUDIO_DAI_TYPE_I2S, rates[i], 16, false),
+			"%u Hz", rates[i]);
+		zassert_true(es8311_emul_get_reg(fixture->target_b, REG_CLKMGR1) &
+			CLKMGR1_MCLK_SEL, "%u Hz", rates[i]);
+		zassert_equal(es8311_emul_get_reg(fixture->target_b, REG_CLKMGR2), 0x18,
+			"%u Hz", rates[i]);
+		zassert_equal(es8311_emul_get_reg(fixture->target_b, REG_CLKMGR5), 0x00,
+			"%u Hz", rates[i]);
+	}
+
+	/* No MCLK to derive the frame clock from */
+	zassert_equal(configure(fixture->dev_b, AUDIO_DAI_TYPE_I2S, 48000, 16, true), -EINVAL);
+	zassert_equal(configure(fixture->dev_b, AUDIO_DAI_TYPE_I2S, 12000, 16, false), -EINVAL);
+}
+
+ZTEST_F(es8311, test_rates_provider)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(rates); i++) {
+		const uint32_t div = MCLK_FREQ / rates[i] - 1;
+		int ret = configure(fixture->dev, AUDIO_DAI_TYPE_I2S, rates[i], 16, true);
+
+		/* The 44.1 kHz family needs another MCLK */
+		if (MCLK_FREQ % rates[i]) {
+			zassert_equal(ret, -EINVAL, "%u Hz", rates[i]);
+			continue;
+		}
+
+		zassert_ok(ret, "%u Hz", rates[i]);
+		zassert_true(es8311_emul_get_reg(fixture->target, REG_RESET) & RESET_MSC);
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_CLKMGR7) & 0x0F, div >> 8,
+			"%u Hz", rates[i]);
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_CLKMGR8), div & 0xFF,
+			"%u Hz", rates[i]);
+	}
+
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 16, false));
+	zassert_false(es8311_emul_get_reg(fixture->target, REG_RESET) & RESET_MSC);
+}
+
+ZTEST_F(es8311, test_mono)
+{
+	/* Two-slot formats carry mono in the left slot at the stereo BCLK */
+	zassert_ok(configure_channels(fixture->dev, AUDIO_DAI_TYPE_I2S, 16000, 16, 1, true));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_IN) & SDP_IN_SEL, 0);
+	/* 768 fs / 32 bits is a BCLK divider of 24, index 21 */
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_CLKMGR6) &
+		CLKMGR6_DIV_BCLK_MASK, 21);
+	zassert_equal(configure_channels(fixture->dev, AUDIO_DAI_TYPE_I2S, 16000, 16, 3, true),
+		-EINVAL);
+
+	/* A one-slot DSP frame halves BCLK, 768 fs / 16 bits is divider 48, index 29 */
+	zassert_ok(configure_channels(fixture->dev, AUDIO_DAI_TYPE_PCMA, 16000, 16, 1, true));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_CLKMGR6) &
+		CLKMGR6_DIV_BCLK_MASK, 29);
+	zassert_equal(configure_channels(fixture->dev, AUDIO_DAI_TYPE_PCMA, 16000, 16, 0, true),
+		-EINVAL);
+
+	/* Without MCLK the one-slot BCLK is the internal clock */
+	zassert_ok(configure_channels(fixture->dev_b, AUDIO_DAI_TYPE_PCMA, 16000, 32, 1, false));
+	zassert_true(es8311_emul_get_reg(fixture->target_b, REG_CLKMGR1) & CLKMGR1_MCLK_SEL);
+	/* 16 fs is too slow to multiply up to the 256 fs the codec needs */
+	zassert_equal(configure_channels(fixture->dev_b, AUDIO_DAI_TYPE_PCMA, 16000, 16, 1,
+		false), -EINVAL);
+
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 16, false));
+}
+
+ZTEST_F(es8311, test_properties)
+{
+	audio_property_value_t val;
+
+	set_volume(fixture->dev, 100);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC2), 100);
+
+	val.vol = 200;
+	zassert_ok(audio_codec_set_property(fixture->dev, AUDIO_PROPERTY_INPUT_VOLUME,
+		AUDIO_CHANNEL_ALL, val));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC3), 200);
+
+	val.mute = true;
+	zassert_ok(audio_codec_set_property(fixture->dev, AUDIO_PROPERTY_OUTPUT_MUTE,
+		AUDIO_CHANNEL_ALL, val));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC1) & DAC1_MUTE, DAC1_MUTE);
+	zassert_ok(audio_codec_set_property(fixture->dev, AUDIO_PROPERTY_INPUT_MUTE,
+		AUDIO_CHANNEL_ALL, val));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, SDP_MUTE);
+
+	val.mute = false;
+	zassert_ok(audio_codec_set_property(fixture->dev, AUDIO_PROPERTY_OUTPUT_MUTE,
+		AUDIO_CHANNEL_ALL, val));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC1) & DAC1_MUTE, 0);
+	zassert_ok(audio_codec_set_property(fixture->dev, AUDIO_PROPERTY_INPUT_MUTE,
+		AUDIO_CHANNEL_ALL, val));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, 0);
+
+	zassert_ok(audio_codec_apply_properties(fixture->dev));
+}
+
+static void set_input_mute(const struct device *dev, bool mute)
+{
+	audio_property_value_t val = {.mute = mute};
+
+	zassert_ok(audio_codec_set_property(dev, AUDIO_PROPERTY_INPUT_MUTE,
+		AUDIO_CHANNEL_ALL, val));
+}
+
+static bool adc_running(const struct emul *target)
+{
+	return ((es8311_emul_get_reg(target, REG_CLKMGR1) & CLKMGR1_ADC_ON) == CLKMGR1_ADC_ON) &&
+	       ((es8311_emul_get_reg(target, REG_SYS4) & SYS4_PDN_ADC) == 0);
+}
+
+static bool adc_stopped(const struct emul *target)
+{
+	return ((es8311_emul_get_reg(target, REG_CLKMGR1) & CLKMGR1_ADC_ON) == 0) &&
+	       ((es8311_emul_get_reg(target, REG_SYS4) & SYS4_PDN_ADC) == SYS4_PDN_ADC) &&
+	       (es8311_emul_get_reg(target, REG_SDP_OUT) & SDP_MUTE);
+}
+
+ZTEST_F(es8311, test_capture)
+{
+	static const audio_route_t routes[] = {
+		AUDIO_ROUTE_CAPTURE,
+		AUDIO_ROUTE_PLAYBACK_CAPTURE,
+	};
+
+	set_input_mute(fixture->dev, false);
+
+	for (size_t i = 0; i < ARRAY_SIZE(routes); i++) {
+		/* Both capture routes clock and power up the ADC */
+		zassert_ok(configure_route(fixture->dev, routes[i], AUDIO_DAI_TYPE_I2S, 48000,
+			16, 2, false));
+		zassert_true(adc_running(fixture->target), "route %d", routes[i]);
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, 0);
+
+		/* Stopping mutes the ADC output, then powers it down and gates its clocks */
+		audio_codec_stop_input(fixture->dev);
+		zassert_true(adc_stopped(fixture->target), "route %d", routes[i]);
+	}
+
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 16, false));
+}
+
+ZTEST_F(es8311, test_input_mute)
+{
+	/* A muted input stays muted across a restart */
+	set_input_mute(fixture->dev, true);
+	audio_codec_start_input(fixture->dev);
+	zassert_true(adc_running(fixture->target));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, SDP_MUTE);
+	audio_codec_stop_input(fixture->dev);
+	audio_codec_start_input(fixture->dev);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, SDP_MUTE);
+
+	/* An unmuted one comes back unmuted after the stop muted it */
+	set_input_mute(fixture->dev, false);
+	audio_codec_stop_input(fixture->dev);
+	zassert_true(adc_stopped(fixture->target));
+	audio_codec_start_input(fixture->dev);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SDP_OUT) & SDP_MUTE, 0);
+
+	audio_codec_stop_input(fixture->dev);
+}
+
+ZTEST_F(es8311, test_route_input)
+{
+	zassert_ok(audio_codec_route_input(fixture->dev, AUDIO_CHANNEL_ALL, ES8311_INPUT_DMIC));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SYS10) &
+		(SYS10_DMIC_ON | SYS10_LINESEL_MASK), SYS10_DMIC_ON);
+
+	zassert_ok(audio_codec_route_input(fixture->dev, AUDIO_CHANNEL_FRONT_LEFT,
+		ES8311_INPUT_MIC1));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SYS10) &
+		(SYS10_DMIC_ON | SYS10_LINESEL_MASK), 1 << 4);
+
+	/* The ADC is mono */
+	zassert_equal(audio_codec_route_input(fixture->dev, AUDIO_CHANNEL_FRONT_RIGHT,
+		ES8311_INPUT_DMIC), -EINVAL);
+	zassert_equal(audio_codec_route_input(fixture->dev, AUDIO_CHANNEL_ALL,
+		ES8311_INPUT_DMIC + 1), -EINVAL);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SYS10) &
+		(SYS10_DMIC_ON | SYS10_LINESEL_MASK), 1 << 4);
+}
+
+ZTEST_F(es8311, test_mic_gain)
+{
+	zassert_ok(es8311_set_mic_gain(fixture->dev, 30));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_SYS10) & 0x0F, 10);
+	zassert_equal(es8311_set_mic_gain(fixture->dev, 31), -EINVAL);
+	zassert_equal(es8311_set_mic_gain(fixture->dev, 4), -EINVAL);
+	zassert_ok(es8311_set_mic_gain(fixture->dev, 12));
+}
+
+ZTEST_F(es8311, test_dynamics)
+{
+	struct es8311_dynamics alc = {.enable = true, .window = 2, .max_level = 12,
+				      .min_level = 9};
+	struct es8311_dynamics drc = {.enable = true, .window = 5, .max_level = 15,
+				      .min_level = 0};
+	struct es8311_dynamics bad = {.max_level = 3, .min_level = 4};
+
+	zassert_ok(es8311_set_alc(fixture->dev, &alc));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC4) & 0x8F, 0x82);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC5), 0xC9);
+
+	zassert_ok(es8311_set_drc(fixture->dev, &drc));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC4) & 0x8F, 0x85);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC5), 0xF0);
+
+	zassert_equal(es8311_set_alc(fixture->dev, &bad), -EINVAL);
+	zassert_equal(es8311_set_drc(fixture->dev, &bad), -EINVAL);
+
+	alc.enable = false;
+	drc.enable = false;
+	zassert_ok(es8311_set_alc(fixture->dev, &alc));
+	zassert_ok(es8311_set_drc(fixture->dev, &drc));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC4) & 0x80, 0);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC4) & 0x80, 0);
+
+	zassert_ok(es8311_set_adc_hpf(fixture->dev, false));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC8) & ADC8_HPF, 0);
+	zassert_ok(es8311_set_adc_hpf(fixture->dev, true));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC8) & ADC8_HPF, ADC8_HPF);
+}
+
+ZTEST_F(es8311, test_eq)
+{
+	uint8_t coeffs[20];
+
+	for (size_t i = 0; i < ARRAY_SIZE(coeffs); i++) {
+		coeffs[i] = 0x10 + i;
+	}
+
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_ADC, coeffs));
+	for (size_t i = 0; i < 20; i++) {
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADCEQ1 + i), coeffs[i]);
+	}
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC8) & ADC8_EQBYPASS, 0);
+
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_DAC, coeffs));
+	for (size_t i = 0; i < 12; i++) {
+		zassert_equal(es8311_emul_get_reg(fixture->target, REG_DACEQ1 + i), coeffs[i]);
+	}
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC6) & DAC6_EQBYPASS, 0);
+
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_ADC, NULL));
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_DAC, NULL));
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_ADC8) & ADC8_EQBYPASS,
+		ADC8_EQBYPASS);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC6) & DAC6_EQBYPASS,
+		DAC6_EQBYPASS);
+	zassert_equal(es8311_set_eq(fixture->dev, (enum es8311_eq_path)2, NULL), -EINVAL);
+}
+
+ZTEST_F(es8311, test_bus_traffic)
+{
+	struct es8311_emul_stats stats;
+	uint8_t coeffs[20] = {0};
+
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 16000, 16, true));
+	report(fixture->target, "configure(16 kHz)", &stats);
+
+	/* An unchanged configuration does not touch the bus */
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 16000, 16, true));
+	report(fixture->target, "configure(16 kHz) again", &stats);
+	zassert_equal(stats.transfers, 0, "%u transfers", stats.transfers);
+
+	/* Only the changed clock fields, in one transfer */
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 16, true));
+	report(fixture->target, "configure(16 -> 48 kHz)", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+
+	set_volume(fixture->dev, 180);
+	report(fixture->target, "set_property(OUTPUT_VOLUME)", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_equal(stats.bytes, 2, "%u bytes", stats.bytes);
+
+	set_volume(fixture->dev, 180);
+	report(fixture->target, "set_property(OUTPUT_VOLUME) again", &stats);
+
+	/* Output stop and restart only toggle the DAC mute */
+	audio_codec_stop_output(fixture->dev);
+	report(fixture->target, "stop_output", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_equal(stats.bytes, 2, "%u bytes", stats.bytes);
+	audio_codec_start_output(fixture->dev);
+	report(fixture->target, "start_output", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_equal(stats.bytes, 2, "%u bytes", stats.bytes);
+
+	/* Clocks and power in one transfer, the mute update at most one more */
+	audio_codec_start_input(fixture->dev);
+	report(fixture->target, "start_input", &stats);
+	zassert_between_inclusive(stats.transfers, 1, 2, "%u transfers", stats.transfers);
+	zassert_true(stats.bytes <= 6, "%u bytes", stats.bytes);
+	audio_codec_stop_input(fixture->dev);
+	report(fixture->target, "stop_input", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_true(stats.bytes <= 6, "%u bytes", stats.bytes);
+
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_ADC, coeffs));
+	report(fixture->target, "set_eq(ADC)", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_ok(es8311_set_eq(fixture->dev, ES8311_EQ_ADC, NULL));
+	report(fixture->target, "set_eq(ADC, bypass)", &stats);
+	zassert_equal(stats.transfers, 1, "%u transfers", stats.transfers);
+	zassert_equal(stats.bytes, 2, "%u bytes", stats.bytes);
+}
+
+#ifdef CONFIG_PM_DEVICE
+ZTEST_F(es8311, test_power_cycle)
+{
+	struct es8311_emul_stats stats;
+
+	zassert_ok(configure(fixture->dev, AUDIO_DAI_TYPE_I2S, 48000, 16, true));
+	set_volume(fixture->dev, 150);
+
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_SUSPEND));
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_TURN_OFF));
+	es8311_emul_power_on(fixture->target);
+	es8311_emul_reset_stats(fixture->target);
+
+	/* Without power updates only reach the cache */
+	set_volume(fixture->dev, 160);
+	report(fixture->target, "set_property(OUTPUT_VOLUME) while off", &stats);
+	zassert_equal(stats.transfers, 0, "%u transfers", stats.transfers);
+
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_TURN_ON));
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_RESUME));
+	report(fixture->target, "resume", &stats);
+	/* All 0x45 cached registers go out as bursts, with one address byte per burst */
+	zassert_true(stats.transfers <= 3, "%u transfers", stats.transfers);
+	zassert_true(stats.bytes < 0x45 + 8, "%u bytes", stats.bytes);
+
+	zassert_false(es8311_emul_in_reset(fixture->target), "codec left in reset");
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_DAC2), 160);
+	zassert_true(es8311_emul_get_reg(fixture->target, REG_RESET) & RESET_MSC);
+	zassert_equal(es8311_emul_get_reg(fixture->target, REG_CLKMGR8), MCLK_FREQ / 48000 - 1);
+}
+#endif /* CONFIG_PM_DEVICE */
+
+ZTEST_SUITE(es8311, NULL, es8311_setup, es8311_before, NULL, NULL);
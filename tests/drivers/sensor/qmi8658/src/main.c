@@ -0,0 +1,1059 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test qmi8658 driver
+ *
+ * This suite runs the QMI8658 driver against the register-level I2C
+ * emulator. Besides the functional checks it reports the bus traffic of
+ * each sampling path, so extra transfers show up before they reach hardware.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_sensor.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/ztest.h>
+
+#include <app/drivers/sensor/qmi8658.h>
+#include <app/drivers/sensor/qmi8658_emul.h>
+
+#include <bench.h>
+
+/* Register map, kept local so the suite does not depend on driver internals */
+#define REG_CTRL1 0x02
+#define REG_CTRL2 0x03
+#define REG_CTRL3 0x04
+#define REG_CTRL7 0x08
+#define REG_CTRL8 0x09
+#define REG_FIFO_WTM_TH 0x13
+#define REG_STATUS_INT 0x2D
+#define REG_TEMP_L 0x33
+#define REG_TEMP_H 0x34
+
+#define FS_MASK GENMASK(6, 4)
+#define ODR_MASK GENMASK(3, 0)
+
+/* Upper bounds of bus transfers per polled sample, syncSample checks the lock first */
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+#define FETCH_ALL_MAX_TRANSFERS 2
+#define FETCH_ACCEL_MAX_TRANSFERS 2
+#else
+#define FETCH_ALL_MAX_TRANSFERS 1
+#define FETCH_ACCEL_MAX_TRANSFERS 1
+#endif
+
+/* q31 shift used to inject samples, large enough for 16 g */
+#define SAMPLE_SHIFT 8
+
+struct qmi8658_fixture {
+	const struct device *dev;
+	const struct emul *target;
+};
+
+static q31_t micro_to_q31(int64_t micro)
+{
+	return (q31_t)((micro * (1LL << 31)) / (1000000LL << SAMPLE_SHIFT));
+}
+
+static void set_odr(const struct device *dev, enum sensor_channel chan, int32_t hz)
+{
+	struct sensor_value val = {.val1 = hz};
+
+	zassert_ok(sensor_attr_set(dev, chan, SENSOR_ATTR_SAMPLING_FREQUENCY, &val));
+}
+
+static void set_accel_fs(const struct device *dev, int32_t g)
+{
+	struct sensor_value val;
+
+	sensor_g_to_ms2(g, &val);
+	zassert_ok(sensor_attr_set(dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &val));
+}
+
+static void set_gyro_fs(const struct device *dev, int32_t dps)
+{
+	struct sensor_value val = {.val1 = dps};
+
+	zassert_ok(sensor_attr_set(dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &val));
+}
+
+static void set_power_mode(const struct device *dev, enum sensor_channel chan,
+			   enum qmi8658_power_mode mode)
+{
+	struct sensor_value val = {.val1 = mode};
+
+	zassert_ok(sensor_attr_set(dev, chan, (enum sensor_attribute)QMI8658_ATTR_POWER_MODE,
+		&val));
+}
+
+static void *qmi8658_setup(void)
+{
+	static struct qmi8658_fixture fixture = {
+		.dev = DEVICE_DT_GET(DT_NODELABEL(qmi8658)),
+		.target = EMUL_DT_GET(DT_NODELABEL(qmi8658)),
+	};
+
+	zassert_true(device_is_ready(fixture.dev), "qmi8658 not ready");
+	zassert_ok(qmi8658_init_wait(fixture.dev, K_SECONDS(1)), "qmi8658 init failed");
+	return &fixture;
+}
+
+static void qmi8658_before(void *f)
+{
+	struct qmi8658_fixture *fixture = f;
+
+	/* Restore the devicetree configuration */
+	set_power_mode(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, QMI8658_POWER_NORMAL);
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_NORMAL);
+	set_odr(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, 1000);
+	set_odr(fixture->dev, SENSOR_CHAN_GYRO_XYZ, 1000);
+	set_accel_fs(fixture->dev, 2);
+	set_gyro_fs(fixture->dev, 256);
+#ifdef CONFIG_QMI8658_FIFO
+	zassert_ok(qmi8658_fifo_flush(fixture->dev));
+#endif
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+	set_odr(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, 0);
+#endif
+#ifdef CONFIG_QMI8658_CALIBRATION
+	struct sensor_value zero[3] = {0};
+
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OFFSET, zero));
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_OFFSET, zero));
+#endif
+	qmi8658_emul_reset_stats(fixture->target);
+}
+
+ZTEST_F(qmi8658, test_init)
+{
+	const struct emul *target = fixture->target;
+
+	zassert_true(qmi8658_emul_get_reg(target, REG_CTRL1) & BIT(6),
+		"address auto increment not enabled");
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)),
+		BIT(1) | BIT(0), "accel and gyro not enabled");
+	zassert_true(qmi8658_emul_get_reg(target, REG_CTRL8) & BIT(7),
+		"ctrl9 handshake not routed to status_int");
+	zassert_ok(qmi8658_init_wait(fixture->dev, K_NO_WAIT));
+}
+
+ZTEST_F(qmi8658, test_second_instance)
+{
+	const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(qmi8658_b));
+	const struct emul *target = EMUL_DT_GET(DT_NODELABEL(qmi8658_b));
+	struct sensor_value val;
+
+	zassert_true(device_is_ready(dev), "second qmi8658 not ready");
+	zassert_ok(qmi8658_init_wait(dev, K_SECONDS(1)));
+
+	/* Devicetree defaults reach the chip without runtime setters */
+	zassert_equal(FIELD_GET(FS_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x02);
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x06);
+	zassert_equal(FIELD_GET(FS_MASK, qmi8658_emul_get_reg(target, REG_CTRL3)), 0x07);
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL3)), 0x05);
+
+	zassert_ok(sensor_attr_get(dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &val));
+	zassert_equal(val.val1, 78);
+	zassert_ok(sensor_attr_get(dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &val));
+	zassert_equal(val.val1, 35);
+	zassert_ok(sensor_attr_get(dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &val));
+	zassert_equal(val.val1, 200);
+
+	/* Settings of one instance leave the other alone */
+	set_accel_fs(fixture->dev, 16);
+	zassert_equal(FIELD_GET(FS_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x02);
+	zassert_ok(sensor_attr_get(dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &val));
+	zassert_equal(val.val1, 78);
+}
+
+ZTEST_F(qmi8658, test_odr_rounding)
+{
+	static const struct {
+		int32_t hz;
+		int32_t rounded;
+		uint8_t bits;
+	} cases[] = {
+		{25, 50, 0x07},   {60, 100, 0x06},   {200, 200, 0x05},
+		{300, 500, 0x04}, {1000, 1000, 0x03}, {1500, 2000, 0x02},
+		{4000, 4000, 0x01}, {5000, 8000, 0x00},
+	};
+	static const struct {
+		enum sensor_channel chan;
+		uint8_t reg;
+	} sensors[] = {
+		{SENSOR_CHAN_ACCEL_XYZ, REG_CTRL2},
+		{SENSOR_CHAN_GYRO_XYZ, REG_CTRL3},
+	};
+	struct sensor_value val;
+
+	for (size_t s = 0; s < ARRAY_SIZE(sensors); s++) {
+		for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+			set_odr(fixture->dev, sensors[s].chan, cases[i].hz);
+			zassert_ok(sensor_attr_get(fixture->dev, sensors[s].chan,
+				SENSOR_ATTR_SAMPLING_FREQUENCY, &val));
+			zassert_equal(val.val1, cases[i].rounded,
+				"%d Hz rounded to %d Hz", cases[i].hz, val.val1);
+			zassert_equal(FIELD_GET(ODR_MASK,
+				qmi8658_emul_get_reg(fixture->target, sensors[s].reg)),
+				cases[i].bits, "wrong odr field for %d Hz", cases[i].hz);
+		}
+
+		val.val1 = 10;
+		zassert_equal(sensor_attr_set(fixture->dev, sensors[s].chan,
+			SENSOR_ATTR_SAMPLING_FREQUENCY, &val), -ENOTSUP);
+		val.val1 = 9000;
+		zassert_equal(sensor_attr_set(fixture->dev, sensors[s].chan,
+			SENSOR_ATTR_SAMPLING_FREQUENCY, &val), -ENOTSUP);
+	}
+}
+
+ZTEST_F(qmi8658, test_accel_fs_rounding)
+{
+	static const struct {
+		int32_t g;
+		int32_t rounded;
+		uint8_t bits;
+	} cases[] = {
+		{2, 2, 0x00}, {3, 4, 0x01}, {4, 4, 0x01}, {5, 8, 0x02}, {16, 16, 0x03},
+	};
+	struct sensor_value val, expected;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		set_accel_fs(fixture->dev, cases[i].g);
+		zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+			SENSOR_ATTR_FULL_SCALE, &val));
+		sensor_g_to_ms2(cases[i].rounded, &expected);
+		zassert_equal(val.val1, expected.val1, "%d g rounded to %d m/s^2",
+			cases[i].g, val.val1);
+		zassert_equal(FIELD_GET(FS_MASK, qmi8658_emul_get_reg(fixture->target, REG_CTRL2)),
+			cases[i].bits, "wrong fs field for %d g", cases[i].g);
+	}
+
+	sensor_g_to_ms2(32, &val);
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		SENSOR_ATTR_FULL_SCALE, &val), -ENOTSUP);
+}
+
+ZTEST_F(qmi8658, test_gyro_fs_rounding)
+{
+	static const struct {
+		int32_t dps;
+		int32_t rounded;
+		uint8_t bits;
+	} cases[] = {
+		{16, 16, 0x00},     {20, 32, 0x01},     {64, 64, 0x02},
+		{100, 128, 0x03},   {250, 256, 0x04},   {500, 512, 0x05},
+		{1000, 1024, 0x06}, {2000, 2048, 0x07},
+	};
+	struct sensor_value val, expected;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		set_gyro_fs(fixture->dev, cases[i].dps);
+		zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_GYRO_XYZ,
+			SENSOR_ATTR_FULL_SCALE, &val));
+		sensor_degrees_to_rad(cases[i].rounded, &expected);
+		zassert_equal(val.val1, expected.val1, "%d dps rounded to %d rad/s",
+			cases[i].dps, val.val1);
+		zassert_equal(FIELD_GET(FS_MASK, qmi8658_emul_get_reg(fixture->target, REG_CTRL3)),
+			cases[i].bits, "wrong fs field for %d dps", cases[i].dps);
+	}
+
+	val.val1 = 4000;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_GYRO_XYZ,
+		SENSOR_ATTR_FULL_SCALE, &val), -ENOTSUP);
+}
+
+ZTEST_F(qmi8658, test_fetch_accel)
+{
+	static const int64_t expected[3] = {-4903325, 1000000, 9806650};
+	struct sensor_chan_spec spec = {0};
+	struct sensor_value val[3];
+	q31_t q;
+
+	for (size_t i = 0; i < ARRAY_SIZE(expected); i++) {
+		spec.chan_type = SENSOR_CHAN_ACCEL_X + i;
+		q = micro_to_q31(expected[i]);
+		zassert_ok(emul_sensor_backend_set_channel(fixture->target, spec, &q,
+			SAMPLE_SHIFT));
+	}
+
+	zassert_ok(sensor_sample_fetch_chan(fixture->dev, SENSOR_CHAN_ACCEL_XYZ));
+	zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, val));
+
+	/* One LSB at 2 g is about 600 um/s^2 */
+	for (size_t i = 0; i < ARRAY_SIZE(expected); i++) {
+		zassert_within(sensor_value_to_micro(&val[i]), expected[i], 1200,
+			"axis %zu: got %lld", i, (long long)sensor_value_to_micro(&val[i]));
+	}
+}
+
+static void inject(const struct emul *target, enum sensor_channel x_chan, const int64_t *micro)
+{
+	struct sensor_chan_spec spec = {0};
+	q31_t q;
+
+	for (int i = 0; i < 3; i++) {
+		spec.chan_type = x_chan + i;
+		q = micro_to_q31(micro[i]);
+		zassert_ok(emul_sensor_backend_set_channel(target, spec, &q, SAMPLE_SHIFT));
+	}
+}
+
+ZTEST_F(qmi8658, test_fetch_all_ranges)
+{
+	static const int32_t accel_g[] = {2, 4, 8, 16};
+	static const int32_t gyro_dps[] = {16, 32, 64, 128, 256, 512, 1024, 2048};
+	struct sensor_value val[6], fs;
+
+	for (size_t r = 0; r < ARRAY_SIZE(gyro_dps); r++) {
+		int64_t accel_fs, gyro_fs, micro[6];
+
+		set_accel_fs(fixture->dev, accel_g[r % ARRAY_SIZE(accel_g)]);
+		set_gyro_fs(fixture->dev, gyro_dps[r]);
+
+		accel_fs = (int64_t)accel_g[r % ARRAY_SIZE(accel_g)] * 9806650LL;
+		sensor_degrees_to_rad(gyro_dps[r], &fs);
+		gyro_fs = sensor_value_to_micro(&fs);
+
+		micro[0] = accel_fs / 2;
+		micro[1] = -accel_fs / 4;
+		micro[2] = accel_fs / 8;
+		micro[3] = -gyro_fs / 2;
+		micro[4] = gyro_fs / 4;
+		micro[5] = -gyro_fs / 8;
+		inject(fixture->target, SENSOR_CHAN_ACCEL_X, &micro[0]);
+		inject(fixture->target, SENSOR_CHAN_GYRO_X, &micro[3]);
+
+		zassert_ok(sensor_sample_fetch(fixture->dev));
+		zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_ALL, val));
+
+		/* Two LSB of the programmed range */
+		for (int i = 0; i < 6; i++) {
+			int64_t lsb = ((i < 3) ? accel_fs : gyro_fs) / 32768 + 1;
+
+			zassert_within(sensor_value_to_micro(&val[i]), micro[i], 2 * lsb,
+				"range %zu value %d: got %lld expected %lld", r, i,
+				(long long)sensor_value_to_micro(&val[i]), (long long)micro[i]);
+		}
+	}
+}
+
+ZTEST_F(qmi8658, test_convert_kernels)
+{
+	static const int16_t raw[3] = {16384, -16384, 0};
+	struct qmi8658_scale scale;
+	q31_t q[3];
+	float f[3];
+
+	set_accel_fs(fixture->dev, 8);
+	zassert_ok(qmi8658_get_scale(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, &scale));
+	zassert_equal(scale.micro, 8 * 9806650);
+	zassert_equal(qmi8658_get_scale(fixture->dev, SENSOR_CHAN_ALL, &scale), -ENOTSUP);
+	zassert_ok(qmi8658_get_scale(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, &scale));
+
+	qmi8658_convert_q31(&scale, raw, q, ARRAY_SIZE(raw));
+	qmi8658_convert_float(&scale, raw, f, ARRAY_SIZE(raw));
+
+	/* Half of full scale, 4 g */
+	zassert_within(((int64_t)q[0] * 1000000 * (1LL << scale.shift)) >> 31, 4 * 9806650,
+		1000);
+	zassert_equal(q[1], -q[0]);
+	zassert_equal(q[2], 0);
+	zassert_within(f[0], 4 * 9.80665f, 0.001f);
+	zassert_within(f[1], -4 * 9.80665f, 0.001f);
+}
+
+ZTEST_F(qmi8658, test_convert_benchmark)
+{
+	static int16_t raw[256 * 6];
+	static struct sensor_value val[ARRAY_SIZE(raw)];
+	static q31_t q[ARRAY_SIZE(raw)];
+	static float f[ARRAY_SIZE(raw)];
+	const uint32_t frames = ARRAY_SIZE(raw) / 6;
+	uint64_t best[3] = {UINT64_MAX, UINT64_MAX, UINT64_MAX};
+	struct qmi8658_scale scale;
+	uint64_t start;
+
+	for (size_t i = 0; i < ARRAY_SIZE(raw); i++) {
+		raw[i] = (int16_t)(i * 97);
+	}
+	zassert_ok(qmi8658_get_scale(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, &scale));
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		start = bench_start();
+		qmi8658_convert_sensor_value(&scale, raw, val, ARRAY_SIZE(raw));
+		bench_stop(&best[0], start);
+
+		start = bench_start();
+		qmi8658_convert_q31(&scale, raw, q, ARRAY_SIZE(raw));
+		bench_stop(&best[1], start);
+
+		start = bench_start();
+		qmi8658_convert_float(&scale, raw, f, ARRAY_SIZE(raw));
+		bench_stop(&best[2], start);
+	}
+
+	TC_PRINT("sensor_value: %u ns per 6-axis frame\n", (uint32_t)(best[0] / frames));
+	TC_PRINT("q31: %u ns per 6-axis frame\n", (uint32_t)(best[1] / frames));
+	TC_PRINT("float: %u ns per 6-axis frame\n", (uint32_t)(best[2] / frames));
+	zassert_true(best[0] > 0, "host clock did not advance");
+}
+
+ZTEST_F(qmi8658, test_fetch_no_data)
+{
+	/* Nothing is sampling, and nothing is latched */
+	set_power_mode(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, QMI8658_POWER_OFF);
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_OFF);
+	(void)sensor_sample_fetch(fixture->dev);
+	qmi8658_emul_set_reg(fixture->target, REG_STATUS_INT, 0);
+
+	zassert_equal(sensor_sample_fetch(fixture->dev), -EBUSY);
+	zassert_equal(sensor_sample_fetch_chan(fixture->dev, SENSOR_CHAN_GYRO_XYZ), -EBUSY);
+}
+
+ZTEST_F(qmi8658, test_die_temp)
+{
+	struct sensor_value val;
+
+	/* Signed 8.8 degrees Celsius, marked latched for syncSample mode */
+	qmi8658_emul_set_reg(fixture->target, REG_STATUS_INT, BIT(1) | BIT(0));
+	qmi8658_emul_set_reg(fixture->target, REG_TEMP_L, 0x80);
+	qmi8658_emul_set_reg(fixture->target, REG_TEMP_H, 0x19);
+	zassert_ok(sensor_sample_fetch_chan(fixture->dev, SENSOR_CHAN_DIE_TEMP));
+	zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_DIE_TEMP, &val));
+	zassert_equal(val.val1, 25);
+	zassert_equal(val.val2, 500000);
+
+	qmi8658_emul_set_reg(fixture->target, REG_TEMP_L, 0x00);
+	qmi8658_emul_set_reg(fixture->target, REG_TEMP_H, 0xF6);
+	zassert_ok(sensor_sample_fetch(fixture->dev));
+	zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_DIE_TEMP, &val));
+	zassert_equal(val.val1, -10);
+}
+
+ZTEST_F(qmi8658, test_power_modes)
+{
+	const struct emul *target = fixture->target;
+	struct sensor_value val = {.val1 = QMI8658_POWER_LOW};
+
+	/* Snooze keeps the gyro drive running */
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_LOW);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(4) | BIT(1) | BIT(0)),
+		BIT(4) | BIT(1) | BIT(0), "gyro not in snooze");
+
+	/* Accel low power needs the gyro off */
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_POWER_MODE, &val), -EBUSY);
+
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_OFF);
+	set_power_mode(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, QMI8658_POWER_LOW);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)), BIT(0),
+		"only the accel should run");
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_GYRO_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_POWER_MODE, &val), -EBUSY);
+
+	/* Low power rates round up to 3, 11, 21 or 128 Hz, devicetree sets 21 Hz */
+	zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		SENSOR_ATTR_SAMPLING_FREQUENCY, &val));
+	zassert_equal(val.val1, 21);
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x0D);
+	set_odr(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, 5);
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x0E);
+	val.val1 = 200;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		SENSOR_ATTR_SAMPLING_FREQUENCY, &val), -ENOTSUP);
+
+	/* Leaving low power mode restores the 6DoF rate */
+	set_power_mode(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, QMI8658_POWER_OFF);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)), 0,
+		"sensors not disabled");
+	set_power_mode(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, QMI8658_POWER_NORMAL);
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x03);
+}
+
+ZTEST_F(qmi8658, test_bus_transfers_per_sample)
+{
+	struct sensor_chan_spec spec = {.chan_type = SENSOR_CHAN_ACCEL_X};
+	struct qmi8658_emul_stats stats;
+	q31_t q = 0;
+
+	zassert_ok(emul_sensor_backend_set_channel(fixture->target, spec, &q, SAMPLE_SHIFT));
+	qmi8658_emul_reset_stats(fixture->target);
+
+	zassert_ok(sensor_sample_fetch(fixture->dev));
+	qmi8658_emul_get_stats(fixture->target, &stats);
+	TC_PRINT("sample_fetch(ALL): %u transfers, %u bytes\n", stats.transfers, stats.bytes);
+	zassert_true(stats.transfers <= FETCH_ALL_MAX_TRANSFERS,
+		"%u transfers per sample", stats.transfers);
+
+	qmi8658_emul_reset_stats(fixture->target);
+	zassert_ok(sensor_sample_fetch_chan(fixture->dev, SENSOR_CHAN_ACCEL_XYZ));
+	qmi8658_emul_get_stats(fixture->target, &stats);
+	TC_PRINT("sample_fetch(ACCEL_XYZ): %u transfers, %u bytes\n", stats.transfers,
+		stats.bytes);
+	zassert_true(stats.transfers <= FETCH_ACCEL_MAX_TRANSFERS,
+		"%u transfers per sample", stats.transfers);
+}
+
+#ifdef CONFIG_QMI8658_FIFO
+ZTEST_F(qmi8658, test_fifo_watermark)
+{
+	struct sensor_value val = {.val1 = 4};
+
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ALL,
+		(enum sensor_attribute)QMI8658_ATTR_FIFO_WATERMARK, &val));
+	zassert_equal(qmi8658_emul_get_reg(fixture->target, REG_FIFO_WTM_TH), 4);
+
+	val.val1 = 0;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ALL,
+		(enum sensor_attribute)QMI8658_ATTR_FIFO_WATERMARK, &val), -EINVAL);
+	val.val1 = 17;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ALL,
+		(enum sensor_attribute)QMI8658_ATTR_FIFO_WATERMARK, &val), -EINVAL);
+}
+
+ZTEST_F(qmi8658, test_fifo_read)
+{
+	struct qmi8658_fifo_frame in[10], out[16];
+	struct qmi8658_emul_stats stats;
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(in); i++) {
+		for (size_t j = 0; j < 3; j++) {
+			in[i].accel[j] = (int16_t)(i * 100 + j);
+			in[i].gyro[j] = (int16_t)-(i * 100 + j);
+		}
+	}
+	qmi8658_emul_fifo_push(fixture->target, in, ARRAY_SIZE(in));
+	qmi8658_emul_reset_stats(fixture->target);
+
+	ret = qmi8658_fifo_read(fixture->dev, out, ARRAY_SIZE(out));
+	zassert_equal(ret, ARRAY_SIZE(in), "read %d frames", ret);
+	zassert_mem_equal(out, in, sizeof(in));
+
+	qmi8658_emul_get_stats(fixture->target, &stats);
+	TC_PRINT("fifo_read(%d frames): %u transfers, %u bytes\n", ret, stats.transfers,
+		stats.bytes);
+
+	zassert_equal(qmi8658_fifo_read(fixture->dev, out, ARRAY_SIZE(out)), 0);
+}
+
+ZTEST_F(qmi8658, test_fifo_overflow)
+{
+	struct qmi8658_fifo_frame in[20] = {0}, out[16];
+	int ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(in); i++) {
+		in[i].accel[0] = (int16_t)i;
+	}
+	qmi8658_emul_fifo_push(fixture->target, in, ARRAY_SIZE(in));
+
+	/* A 16 frame FIFO in stream mode keeps the newest frames */
+	ret = qmi8658_fifo_read(fixture->dev, out, ARRAY_SIZE(out));
+	zassert_equal(ret, 16, "read %d frames", ret);
+	zassert_equal(out[0].accel[0], 4);
+	zassert_equal(out[15].accel[0], 19);
+}
+#endif /* CONFIG_QMI8658_FIFO */
+
+#ifdef CONFIG_QMI8658_ATTITUDE_ENGINE
+#define REG_CTRL6 0x07
+#define REG_STATUS0 0x2E
+#define REG_DQW_L 0x49
+#define REG_DVX_L 0x51
+
+static void set_reg16(const struct emul *target, uint8_t reg, int16_t val)
+{
+	qmi8658_emul_set_reg(target, reg, (uint16_t)val & 0xFF);
+	qmi8658_emul_set_reg(target, reg + 1, (uint16_t)val >> 8);
+}
+
+ZTEST_F(qmi8658, test_ae_odr)
+{
+	struct sensor_value val;
+
+	set_odr(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, 10);
+	zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR,
+		SENSOR_ATTR_SAMPLING_FREQUENCY, &val));
+	zassert_equal(val.val1, 16);
+	zassert_equal(qmi8658_emul_get_reg(fixture->target, REG_CTRL6) & GENMASK(2, 0), 0x04);
+	zassert_true(qmi8658_emul_get_reg(fixture->target, REG_CTRL7) & BIT(3),
+		"attitude engine not enabled");
+
+	val.val1 = 100;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR,
+		SENSOR_ATTR_SAMPLING_FREQUENCY, &val), -ENOTSUP);
+
+	set_odr(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, 0);
+	zassert_false(qmi8658_emul_get_reg(fixture->target, REG_CTRL7) & BIT(3),
+		"attitude engine not disabled");
+	zassert_equal(sensor_channel_get(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR,
+		&val), -ENODATA);
+}
+
+ZTEST_F(qmi8658, test_ae_orientation)
+{
+	/* 10 degrees about z per period: cos(5 deg), sin(5 deg) in Q14 */
+	static const int16_t dq[4] = {16322, 0, 0, 1428};
+	struct sensor_value val[4];
+
+	set_odr(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, 64);
+
+	qmi8658_emul_set_reg(fixture->target, REG_STATUS0, 0);
+	zassert_equal(sensor_sample_fetch_chan(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR),
+		-EBUSY);
+
+	for (int i = 0; i < 4; i++) {
+		set_reg16(fixture->target, REG_DQW_L + 2 * i, dq[i]);
+	}
+	set_reg16(fixture->target, REG_DVX_L, 100);
+	set_reg16(fixture->target, REG_DVX_L + 2, -100);
+	set_reg16(fixture->target, REG_DVX_L + 4, 0);
+
+	for (int i = 0; i < 9; i++) {
+		qmi8658_emul_set_reg(fixture->target, REG_STATUS0, BIT(3));
+		zassert_ok(sensor_sample_fetch_chan(fixture->dev,
+			SENSOR_CHAN_GAME_ROTATION_VECTOR));
+	}
+
+	/* Nine increments make 90 degrees about z */
+	zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, val));
+	zassert_within(sensor_value_to_micro(&val[0]), 707107, 5000);
+	zassert_within(sensor_value_to_micro(&val[1]), 0, 5000);
+	zassert_within(sensor_value_to_micro(&val[2]), 0, 5000);
+	zassert_within(sensor_value_to_micro(&val[3]), 707107, 5000);
+
+	zassert_ok(sensor_channel_get(fixture->dev,
+		(enum sensor_channel)QMI8658_CHAN_DELTA_QUAT, val));
+	zassert_within(sensor_value_to_micro(&val[0]), 996216, 100);
+	zassert_within(sensor_value_to_micro(&val[3]), 87158, 100);
+
+	/* Velocity increments use the accel sensitivity, 2 g here */
+	zassert_ok(sensor_channel_get(fixture->dev,
+		(enum sensor_channel)QMI8658_CHAN_DELTA_VELOCITY, val));
+	zassert_within(sensor_value_to_micro(&val[0]), 59854, 10);
+	zassert_within(sensor_value_to_micro(&val[1]), -59854, 10);
+	zassert_equal(sensor_value_to_micro(&val[2]), 0);
+}
+
+ZTEST_F(qmi8658, test_ae_fetch_all)
+{
+	static const int16_t dq[4] = {16322, 0, 0, 1428};
+	struct sensor_value val[4];
+	int64_t z = 0;
+
+	set_odr(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, 64);
+	for (int i = 0; i < 4; i++) {
+		set_reg16(fixture->target, REG_DQW_L + 2 * i, dq[i]);
+	}
+
+	/* The sample burst clears STATUS0, the engine output it saw is still integrated */
+	for (int i = 0; i < 3; i++) {
+		qmi8658_emul_set_reg(fixture->target, REG_STATUS0, BIT(3));
+		zassert_ok(sensor_sample_fetch(fixture->dev));
+		zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR,
+			val));
+		zassert_true(sensor_value_to_micro(&val[3]) > z,
+			"orientation did not advance at fetch %d", i);
+		z = sensor_value_to_micro(&val[3]);
+	}
+	zassert_within(z, 258819, 5000);
+
+	/* No new engine output, the orientation holds */
+	zassert_ok(sensor_sample_fetch(fixture->dev));
+	zassert_ok(sensor_channel_get(fixture->dev, SENSOR_CHAN_GAME_ROTATION_VECTOR, val));
+	zassert_equal(sensor_value_to_micro(&val[3]), z);
+}
+#endif /* CONFIG_QMI8658_ATTITUDE_ENGINE */
+
+#if defined(CONFIG_QMI8658_MOTION) || defined(CONFIG_QMI8658_WAKE_ON_MOTION)
+#include <zephyr/drivers/gpio/gpio_emul.h>
+
+#define REG_CAL1_L 0x0B
+#define REG_STATUS1 0x2F
+#define REG_TAP_STATUS 0x59
+#define REG_STEP_CNT_LOW 0x5A
+
+static const struct gpio_dt_spec int_gpio = GPIO_DT_SPEC_GET(DT_NODELABEL(qmi8658), int_gpios);
+
+static K_SEM_DEFINE(event_sem, 0, 1);
+static enum sensor_trigger_type event_type;
+
+static void event_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+	ARG_UNUSED(dev);
+
+	event_type = trig->type;
+	k_sem_give(&event_sem);
+}
+
+/* Latch STATUS1 and pulse the interrupt line */
+static void raise_event(const struct emul *target, uint8_t status1)
+{
+	qmi8658_emul_set_reg(target, REG_STATUS1, status1);
+	zassert_ok(gpio_emul_input_set(int_gpio.port, int_gpio.pin, 0));
+	zassert_ok(gpio_emul_input_set(int_gpio.port, int_gpio.pin, 1));
+}
+#endif
+
+#ifdef CONFIG_QMI8658_MOTION
+ZTEST_F(qmi8658, test_motion_trigger_enable)
+{
+	static const struct {
+		int type;
+		uint8_t bit;
+	} cases[] = {
+		{SENSOR_TRIG_MOTION, BIT(1)},
+		{SENSOR_TRIG_STATIONARY, BIT(2)},
+		{QMI8658_TRIG_SIG_MOTION, BIT(3)},
+		{SENSOR_TRIG_TAP, BIT(0)},
+		{QMI8658_TRIG_STEP, BIT(4)},
+	};
+	struct sensor_trigger trig = {.chan = SENSOR_CHAN_ACCEL_XYZ};
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		trig.type = cases[i].type;
+		zassert_ok(sensor_trigger_set(fixture->dev, &trig, event_handler));
+		zassert_true(qmi8658_emul_get_reg(fixture->target, REG_CTRL8) & cases[i].bit,
+			"detector %d not enabled", cases[i].type);
+		zassert_ok(sensor_trigger_set(fixture->dev, &trig, NULL));
+		zassert_false(qmi8658_emul_get_reg(fixture->target, REG_CTRL8) & cases[i].bit,
+			"detector %d not disabled", cases[i].type);
+	}
+
+	trig.type = SENSOR_TRIG_DELTA;
+	zassert_equal(sensor_trigger_set(fixture->dev, &trig, event_handler), -ENOTSUP);
+}
+
+ZTEST_F(qmi8658, test_motion_attr)
+{
+	struct sensor_trigger trig = {
+		.type = SENSOR_TRIG_MOTION,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+	struct sensor_value val;
+
+	zassert_ok(sensor_trigger_set(fixture->dev, &trig, event_handler));
+
+	/* 0.5 g */
+	val.val1 = 4;
+	val.val2 = 903325;
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SLOPE_TH,
+		&val));
+
+	val.val1 = 20;
+	val.val2 = 0;
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SLOPE_DUR,
+		&val));
+	/* The second argument block, with the windows, is written last */
+	zassert_equal(qmi8658_emul_get_reg(fixture->target, REG_CAL1_L), 20,
+		"any motion window not configured");
+	zassert_true(qmi8658_emul_get_reg(fixture->target, REG_CTRL8) & BIT(1),
+		"any motion not re-enabled");
+
+	val.val1 = 256;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		SENSOR_ATTR_SLOPE_DUR, &val), -EINVAL);
+	val.val1 = -1;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_STEP_TH, &val), -EINVAL);
+
+	zassert_ok(sensor_trigger_set(fixture->dev, &trig, NULL));
+}
+
+ZTEST_F(qmi8658, test_motion_events)
+{
+	static const struct {
+		int type;
+		uint8_t status1;
+		uint8_t tap;
+	} cases[] = {
+		{SENSOR_TRIG_MOTION, BIT(5), 0},
+		{SENSOR_TRIG_STATIONARY, BIT(6), 0},
+		{QMI8658_TRIG_SIG_MOTION, BIT(7), 0},
+		{SENSOR_TRIG_TAP, BIT(1), 0x01},
+		{SENSOR_TRIG_DOUBLE_TAP, BIT(1), 0x02},
+		{QMI8658_TRIG_STEP, BIT(4), 0},
+	};
+	struct sensor_trigger trig = {.chan = SENSOR_CHAN_ACCEL_XYZ};
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		trig.type = cases[i].type;
+		zassert_ok(sensor_trigger_set(fixture->dev, &trig, event_handler));
+
+		k_sem_reset(&event_sem);
+		qmi8658_emul_set_reg(fixture->target, REG_TAP_STATUS, cases[i].tap);
+		raise_event(fixture->target, cases[i].status1);
+		zassert_ok(k_sem_take(&event_sem, K_MSEC(100)), "event %d not delivered",
+			cases[i].type);
+		zassert_equal(event_type, cases[i].type);
+
+		zassert_ok(sensor_trigger_set(fixture->dev, &trig, NULL));
+	}
+}
+
+ZTEST_F(qmi8658, test_motion_step_count)
+{
+	struct sensor_value val;
+
+	qmi8658_emul_set_reg(fixture->target, REG_STEP_CNT_LOW, 0x34);
+	qmi8658_emul_set_reg(fixture->target, REG_STEP_CNT_LOW + 1, 0x12);
+	qmi8658_emul_set_reg(fixture->target, REG_STEP_CNT_LOW + 2, 0x01);
+
+	zassert_ok(sensor_sample_fetch_chan(fixture->dev,
+		(enum sensor_channel)QMI8658_CHAN_STEP_COUNT));
+	zassert_ok(sensor_channel_get(fixture->dev,
+		(enum sensor_channel)QMI8658_CHAN_STEP_COUNT, &val));
+	zassert_equal(val.val1, 0x011234);
+}
+#endif /* CONFIG_QMI8658_MOTION */
+
+#ifdef CONFIG_PM_DEVICE
+#include <zephyr/pm/device.h>
+
+ZTEST_F(qmi8658, test_pm_suspend_resume)
+{
+	const struct emul *target = fixture->target;
+
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_LOW);
+
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_SUSPEND));
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)), 0,
+		"sensors not disabled");
+	zassert_true(qmi8658_emul_get_reg(target, REG_CTRL1) & BIT(0),
+		"oscillator not disabled");
+
+	/* Changes while suspended are applied on resume */
+	set_odr(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, 500);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)), 0,
+		"sensors enabled while suspended");
+
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_RESUME));
+	zassert_false(qmi8658_emul_get_reg(target, REG_CTRL1) & BIT(0),
+		"oscillator not enabled");
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(4) | BIT(1) | BIT(0)),
+		BIT(4) | BIT(1) | BIT(0), "power modes not restored");
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x04);
+}
+#endif /* CONFIG_PM_DEVICE */
+
+#ifdef CONFIG_QMI8658_WAKE_ON_MOTION
+#define REG_CAL1_H 0x0C
+
+ZTEST_F(qmi8658, test_wake_on_motion)
+{
+	const struct emul *target = fixture->target;
+	struct sensor_trigger trig = {
+		.type = (enum sensor_trigger_type)QMI8658_TRIG_WAKE_ON_MOTION,
+		.chan = SENSOR_CHAN_ACCEL_XYZ,
+	};
+	/* 0.1 g */
+	struct sensor_value val = {.val1 = 0, .val2 = 980665};
+
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_WOM_TH, &val));
+	val.val1 = 64;
+	val.val2 = 0;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_WOM_BLANKING, &val), -EINVAL);
+	val.val1 = 8;
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ,
+		(enum sensor_attribute)QMI8658_ATTR_WOM_BLANKING, &val));
+
+	zassert_ok(gpio_emul_input_set(int_gpio.port, int_gpio.pin, 0));
+	zassert_ok(sensor_trigger_set(fixture->dev, &trig, event_handler));
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CAL1_L), 100);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CAL1_H) & GENMASK(5, 0), 8);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)), BIT(0),
+		"only the accel should run");
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x0D);
+
+#ifdef CONFIG_PM_DEVICE
+	/* Armed WoM survives suspend as the wake-up source */
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_SUSPEND));
+	zassert_true(qmi8658_emul_get_reg(target, REG_CTRL7) & BIT(0), "accel stopped");
+#endif
+
+	/* Each event toggles the line, both edges are reported */
+	for (int level = 1; level >= 0; level--) {
+		k_sem_reset(&event_sem);
+		qmi8658_emul_set_reg(target, REG_STATUS1, BIT(2));
+		zassert_ok(gpio_emul_input_set(int_gpio.port, int_gpio.pin, level));
+		zassert_ok(k_sem_take(&event_sem, K_MSEC(100)), "no event at level %d", level);
+		zassert_equal((int)event_type, QMI8658_TRIG_WAKE_ON_MOTION);
+	}
+
+#ifdef CONFIG_PM_DEVICE
+	zassert_ok(pm_device_action_run(fixture->dev, PM_DEVICE_ACTION_RESUME));
+#endif
+
+	/* Disarming restores the configured power modes */
+	zassert_ok(sensor_trigger_set(fixture->dev, &trig, NULL));
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CAL1_L), 0);
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)),
+		BIT(1) | BIT(0), "sensors not restored");
+	zassert_equal(FIELD_GET(ODR_MASK, qmi8658_emul_get_reg(target, REG_CTRL2)), 0x03);
+}
+#endif /* CONFIG_QMI8658_WAKE_ON_MOTION */
+
+#ifdef CONFIG_QMI8658_SYNC_SAMPLE
+#define REG_TIMESTAMP_L 0x30
+
+static void set_timestamp(const struct emul *target, uint32_t count)
+{
+	for (int i = 0; i < 3; i++) {
+		qmi8658_emul_set_reg(target, REG_TIMESTAMP_L + i, (count >> (i * 8)) & 0xFF);
+	}
+}
+
+static int64_t fetch_sample_time(const struct device *dev, uint32_t *count)
+{
+	struct sensor_value val[2];
+
+	zassert_ok(sensor_sample_fetch(dev));
+	zassert_ok(sensor_channel_get(dev, (enum sensor_channel)QMI8658_CHAN_TIMESTAMP, val));
+	*count = val[1].val1;
+	return sensor_value_to_micro(&val[0]);
+}
+
+ZTEST_F(qmi8658, test_sync_sample)
+{
+	const struct emul *target = fixture->target;
+	static const int64_t accel[] = {0, 0, 9806650};
+	static const int64_t gyro[] = {0, 0, 0};
+	struct qmi8658_emul_stats stats;
+	uint32_t count;
+	int64_t t0, t1;
+
+	zassert_true(qmi8658_emul_get_reg(target, REG_CTRL7) & BIT(7), "syncSample not enabled");
+
+	inject(target, SENSOR_CHAN_ACCEL_X, accel);
+	inject(target, SENSOR_CHAN_GYRO_X, gyro);
+
+	/* Status, then timestamp through gyro in one burst */
+	set_timestamp(target, 0xFFFFF0);
+	qmi8658_emul_reset_stats(target);
+	t0 = fetch_sample_time(fixture->dev, &count);
+	qmi8658_emul_get_stats(target, &stats);
+	zassert_equal(stats.transfers, 2, "%u transfers per sample", stats.transfers);
+	zassert_equal(count, 0xFFFFF0);
+
+	/* 20 samples at 1 kHz, across the counter wrap */
+	k_sleep(K_MSEC(20));
+	set_timestamp(target, 0x000004);
+	t1 = fetch_sample_time(fixture->dev, &count);
+	zassert_equal(count, 4);
+	zassert_within(t1 - t0, 20000, 2000, "samples %lld us apart", t1 - t0);
+	zassert_true(t1 <= k_ticks_to_us_ceil64(k_uptime_ticks()), "sample time in the future");
+
+	/* Without the lock the data is not coherent yet */
+	qmi8658_emul_set_reg(target, REG_STATUS_INT, BIT(0));
+	zassert_equal(sensor_sample_fetch(fixture->dev), -EBUSY);
+}
+#endif /* CONFIG_QMI8658_SYNC_SAMPLE */
+
+#ifdef CONFIG_QMI8658_CALIBRATION
+#define REG_CAL1_H 0x0C
+#define REG_CAL1_L 0x0B
+#define REG_CAL2_L 0x0D
+
+static int16_t get_cal(const struct emul *target, uint8_t reg)
+{
+	return (int16_t)(qmi8658_emul_get_reg(target, reg) |
+			 (qmi8658_emul_get_reg(target, reg + 1) << 8));
+}
+
+ZTEST_F(qmi8658, test_cal_offset_attr)
+{
+	const struct emul *target = fixture->target;
+	/* 0.1 g, -0.1 g, 0 */
+	struct sensor_value val[3] = {{0, 980665}, {0, -980665}, {0, 0}};
+	struct sensor_value out[3];
+
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OFFSET, val));
+	/* Signed 4.12 g, host delta offset arguments in CAL1..CAL3 */
+	zassert_equal(get_cal(target, REG_CAL1_L), 410);
+	zassert_equal(get_cal(target, REG_CAL2_L), -410);
+
+	zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OFFSET, out));
+	for (int i = 0; i < 3; i++) {
+		zassert_within(sensor_value_to_micro(&out[i]), sensor_value_to_micro(&val[i]), 2400,
+			"axis %d", i);
+	}
+
+	/* 1 dps is 32 in signed 11.5 dps */
+	val[0] = (struct sensor_value){0, 17453};
+	zassert_ok(sensor_attr_set(fixture->dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_OFFSET, val));
+	zassert_equal(get_cal(target, REG_CAL1_L), 32);
+
+	/* Offsets are limited to 8 g */
+	val[0].val1 = 100;
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OFFSET, val),
+		-EINVAL);
+	zassert_equal(sensor_attr_set(fixture->dev, SENSOR_CHAN_ACCEL_X, SENSOR_ATTR_OFFSET, val),
+		-ENOTSUP);
+}
+
+ZTEST_F(qmi8658, test_self_test)
+{
+	const struct emul *target = fixture->target;
+	static const int16_t weak[3] = {2048, 100, 2048};
+
+	zassert_ok(qmi8658_self_test(fixture->dev, SENSOR_CHAN_ACCEL_XYZ));
+	zassert_ok(qmi8658_self_test(fixture->dev, SENSOR_CHAN_GYRO_XYZ));
+	zassert_equal(qmi8658_self_test(fixture->dev, SENSOR_CHAN_ALL), -ENOTSUP);
+
+	qmi8658_emul_set_self_test(target, SENSOR_CHAN_ACCEL_XYZ, weak);
+	zassert_equal(qmi8658_self_test(fixture->dev, SENSOR_CHAN_ACCEL_XYZ), -EIO);
+	qmi8658_emul_set_self_test(target, SENSOR_CHAN_ACCEL_XYZ, (int16_t[3]){2048, 2048, 2048});
+
+	/* Self-test mode is left and sampling restored, pass or fail */
+	zassert_false(qmi8658_emul_get_reg(target, REG_CTRL2) & BIT(7));
+	zassert_false(qmi8658_emul_get_reg(target, REG_CTRL3) & BIT(7));
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)),
+		BIT(1) | BIT(0), "sensors not restored");
+}
+
+ZTEST_F(qmi8658, test_calibrate_gyro_gain)
+{
+	const struct emul *target = fixture->target;
+
+	zassert_ok(qmi8658_calibrate_gyro_gain(fixture->dev));
+	zassert_equal(qmi8658_emul_get_reg(target, REG_CTRL7) & (BIT(1) | BIT(0)),
+		BIT(1) | BIT(0), "sensors not restored");
+}
+
+ZTEST_F(qmi8658, test_calibrate_bias)
+{
+	const struct emul *target = fixture->target;
+	/* Lying flat with a 0.05 g and 1 dps bias */
+	static const int64_t accel[] = {490332, -196133, 9806650};
+	static const int64_t gyro[] = {17453, 0, -17453};
+	struct sensor_value out[3];
+
+	inject(target, SENSOR_CHAN_ACCEL_X, accel);
+	inject(target, SENSOR_CHAN_GYRO_X, gyro);
+
+	zassert_equal(qmi8658_calibrate_bias(fixture->dev, 0), -EINVAL);
+	zassert_ok(qmi8658_calibrate_bias(fixture->dev, 8));
+
+	/* Gravity is kept, only the residual is compensated */
+	zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OFFSET, out));
+	zassert_within(sensor_value_to_micro(&out[0]), accel[0], 5000);
+	zassert_within(sensor_value_to_micro(&out[1]), accel[1], 5000);
+	zassert_within(sensor_value_to_micro(&out[2]), 0, 5000);
+
+	zassert_ok(sensor_attr_get(fixture->dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_OFFSET, out));
+	for (int i = 0; i < 3; i++) {
+		zassert_within(sensor_value_to_micro(&out[i]), gyro[i], 600, "axis %d", i);
+	}
+
+	/* Both sensors must be sampling */
+	set_power_mode(fixture->dev, SENSOR_CHAN_GYRO_XYZ, QMI8658_POWER_OFF);
+	zassert_equal(qmi8658_calibrate_bias(fixture->dev, 8), -EBUSY);
+}
+#endif /* CONFIG_QMI8658_CALIBRATION */
+
+ZTEST_SUITE(qmi8658, NULL, qmi8658_setup, qmi8658_before, NULL, NULL);
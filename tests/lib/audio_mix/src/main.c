@@ -0,0 +1,358 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test audio_mix library
+ *
+ * This suite mixes constant and oscillator sounds from a RAM cache and
+ * checks the voice gains, pan, fades, voice lifetime and handles, then
+ * benchmarks a block with a growing number of voices.
+ */
+
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include <app/lib/audio_mix.h>
+#include <app/lib/audio_osc.h>
+
+#include <bench.h>
+
+#define RATE 16000
+/* 10 ms blocks */
+#define FRAMES 160
+#define VOICES 8
+#define HALF 16384
+/* Mixing budget of each voice, 1% of the 10 ms block period */
+#define VOICE_BUDGET_NS 100000
+/* Blocks mixed in each timed run */
+#define BENCH_BLOCKS 100
+
+AUDIO_MIX_DEFINE(mono, VOICES, 1, FRAMES);
+AUDIO_MIX_DEFINE(stereo, 2, 2, FRAMES);
+AUDIO_MIX_CACHE_DEFINE(cache, 4 * RATE, 4);
+
+static int16_t block[2 * FRAMES];
+
+static const struct audio_mix_voice_cfg unity = {.gain = INT16_MAX};
+
+static int decode_const(int16_t *dst, size_t frames, void *user_data)
+{
+	const int16_t value = (int16_t)POINTER_TO_INT(user_data);
+
+	for (size_t i = 0; i < frames; i++) {
+		dst[i] = value;
+	}
+
+	return 0;
+}
+
+static int decode_fail(int16_t *dst, size_t frames, void *user_data)
+{
+	return -EIO;
+}
+
+static int decode_sine(int16_t *dst, size_t frames, void *user_data)
+{
+	struct audio_osc osc;
+
+	audio_osc_init(&osc, AUDIO_OSC_SINE, POINTER_TO_UINT(user_data), RATE, 16000);
+	audio_osc_fill(&osc, dst, frames, 1);
+
+	return 0;
+}
+
+static const struct audio_mix_sound *add_const(int16_t value, size_t frames)
+{
+	const struct audio_mix_sound *sound =
+		audio_mix_cache_add(&cache, frames, decode_const, INT_TO_POINTER(value));
+
+	zassert_not_null(sound);
+
+	return sound;
+}
+
+static void mix(struct audio_mix *m)
+{
+	zassert_ok(audio_mix_fill(block, FRAMES * m->channels * sizeof(block[0]), m));
+}
+
+static void before(void *fixture)
+{
+	audio_mix_cache_clear(&cache);
+	audio_mix_init(&mono, RATE);
+	audio_mix_init(&stereo, RATE);
+}
+
+ZTEST(audio_mix, test_gain_sum)
+{
+	const struct audio_mix_sound *a = add_const(HALF, FRAMES);
+	const struct audio_mix_sound *b = add_const(-8192, FRAMES);
+	const struct audio_mix_voice_cfg half = {.gain = HALF};
+
+	zassert_true(audio_mix_play(&mono, a, &unity) >= 0);
+	zassert_true(audio_mix_play(&mono, b, &half) >= 0);
+	mix(&mono);
+
+	/* 16384 - 8192 / 2, within the truncation of the Q15 gains */
+	for (size_t i = 0; i < FRAMES; i++) {
+		zassert_within(block[i], HALF - 4096, 2, "frame %zu: %d", i, block[i]);
+	}
+}
+
+ZTEST(audio_mix, test_saturation)
+{
+	const struct audio_mix_sound *a = add_const(30000, FRAMES);
+	const struct audio_mix_sound *b = add_const(-30000, FRAMES);
+
+	for (int i = 0; i < 3; i++) {
+		zassert_true(audio_mix_play(&mono, a, &unity) >= 0);
+	}
+	mix(&mono);
+	zassert_equal(block[0], INT16_MAX);
+	zassert_equal(block[FRAMES - 1], INT16_MAX);
+
+	for (int i = 0; i < 3; i++) {
+		zassert_true(audio_mix_play(&mono, b, &unity) >= 0);
+	}
+	mix(&mono);
+	zassert_equal(block[0], INT16_MIN);
+}
+
+ZTEST(audio_mix, test_pan)
+{
+	const struct audio_mix_sound *s = add_const(HALF, 4 * FRAMES);
+	struct audio_mix_voice_cfg cfg = unity;
+	int v;
+
+	/* Constant power, -3 dB on each side at the centre */
+	v = audio_mix_play(&stereo, s, &cfg);
+	zassert_true(v >= 0);
+	mix(&stereo);
+	zassert_within(block[0], 11585, 8, "left %d", block[0]);
+	zassert_within(block[1], 11585, 8, "right %d", block[1]);
+
+	zassert_ok(audio_mix_set_gain(&stereo, v, INT16_MAX, -INT16_MAX, 0));
+	mix(&stereo);
+	zassert_within(block[0], HALF, 2, "left %d", block[0]);
+	zassert_within(block[1], 0, 2, "right %d", block[1]);
+
+	zassert_ok(audio_mix_set_gain(&stereo, v, INT16_MAX, INT16_MAX, 0));
+	mix(&stereo);
+	zassert_within(block[0], 0, 2, "left %d", block[0]);
+	zassert_within(block[1], HALF, 2, "right %d", block[1]);
+
+	/* The pan does not apply to a mono output */
+	zassert_true(audio_mix_play(&mono, s, &cfg) >= 0);
+	cfg.pan = -INT16_MAX;
+	zassert_true(audio_mix_play(&mono, s, &cfg) >= 0);
+	mix(&mono);
+	zassert_within(block[0], 2 * HALF - 1, 2, "%d", block[0]);
+}
+
+ZTEST(audio_mix, test_fade)
+{
+	const struct audio_mix_sound *s = add_const(HALF, RATE);
+	const struct audio_mix_voice_cfg cfg = {.gain = INT16_MAX, .fade_ms = 20};
+	int v;
+
+	/* Fade in over two blocks, rising every frame */
+	v = audio_mix_play(&mono, s, &cfg);
+	zassert_true(v >= 0);
+	mix(&mono);
+	zassert_true(block[0] < 200, "%d", block[0]);
+	for (size_t i = 1; i < FRAMES; i++) {
+		zassert_true(block[i] >= block[i - 1], "frame %zu", i);
+	}
+	zassert_within(block[FRAMES - 1], HALF / 2, 200, "%d", block[FRAMES - 1]);
+	mix(&mono);
+	zassert_within(block[FRAMES - 1], HALF, 200, "%d", block[FRAMES - 1]);
+	mix(&mono);
+	zassert_within(block[0], HALF, 200, "%d", block[0]);
+
+	/* Fade out over one block, then the voice ends */
+	zassert_ok(audio_mix_stop(&mono, v, 10));
+	zassert_equal(audio_mix_stop(&mono, v, 10), -ENOENT);
+	zassert_true(audio_mix_is_playing(&mono, v));
+	mix(&mono);
+	zassert_true(block[0] > HALF - 300, "%d", block[0]);
+	zassert_true(block[FRAMES - 1] < 300, "%d", block[FRAMES - 1]);
+	mix(&mono);
+	zassert_false(audio_mix_is_playing(&mono, v));
+	zassert_equal(block[0], 0);
+}
+
+ZTEST(audio_mix, test_sound_end)
+{
+	const struct audio_mix_sound *s = add_const(1000, FRAMES + FRAMES / 2);
+	struct audio_mix_voice_cfg cfg = unity;
+	int once, loop;
+
+	once = audio_mix_play(&mono, s, &cfg);
+	cfg.loop = true;
+	loop = audio_mix_play(&mono, s, &cfg);
+	zassert_true((once >= 0) && (loop >= 0));
+
+	mix(&mono);
+	zassert_within(block[FRAMES - 1], 2000, 2);
+	mix(&mono);
+	zassert_false(audio_mix_is_playing(&mono, once));
+	zassert_true(audio_mix_is_playing(&mono, loop));
+	/* The sound ends half way, the looping voice goes on */
+	zassert_within(block[FRAMES / 2 - 1], 2000, 2);
+	zassert_within(block[FRAMES / 2], 1000, 2);
+	zassert_within(block[FRAMES - 1], 1000, 2);
+
+	for (int i = 0; i < 10; i++) {
+		mix(&mono);
+	}
+	zassert_true(audio_mix_is_playing(&mono, loop));
+	zassert_ok(audio_mix_stop(&mono, loop, 0));
+	mix(&mono);
+	zassert_false(audio_mix_is_playing(&mono, loop));
+	zassert_equal(block[0], 0);
+}
+
+ZTEST(audio_mix, test_handles)
+{
+	const struct audio_mix_sound *s = add_const(1000, FRAMES);
+	struct audio_mix_stats stats;
+	int voices[VOICES];
+	int v;
+
+	for (int i = 0; i < VOICES; i++) {
+		voices[i] = audio_mix_play(&mono, s, &unity);
+		zassert_true(voices[i] >= 0);
+	}
+
+	/* The pool is the budget, one more trigger is refused */
+	zassert_equal(audio_mix_play(&mono, s, &unity), -EBUSY);
+	audio_mix_get_stats(&mono, &stats);
+	zassert_equal(stats.refused, 1);
+
+	mix(&mono);
+	zassert_within(block[0], VOICES * 1000, 2 * VOICES);
+	audio_mix_get_stats(&mono, &stats);
+	zassert_equal(stats.blocks, 1);
+	zassert_equal(stats.max_voices, VOICES);
+
+	/* Every voice has ended, a new one reuses a slot under a new handle */
+	v = audio_mix_play(&mono, s, &unity);
+	zassert_true(v >= 0);
+	zassert_not_equal(v, voices[0]);
+	zassert_false(audio_mix_is_playing(&mono, voices[0]));
+	zassert_equal(audio_mix_set_gain(&mono, voices[0], 0, 0, 0), -ENOENT);
+	zassert_equal(audio_mix_stop(&mono, voices[0], 0), -ENOENT);
+	zassert_equal(audio_mix_stop(&mono, -1, 0), -ENOENT);
+	zassert_ok(audio_mix_stop(&mono, v, 0));
+
+	audio_mix_reset_stats(&mono);
+	audio_mix_get_stats(&mono, &stats);
+	zassert_equal(stats.blocks, 0);
+	zassert_equal(stats.refused, 0);
+}
+
+ZTEST(audio_mix, test_cache)
+{
+	static const int16_t pcm[] = {1, -2, 3, -4};
+	const struct audio_mix_sound *s;
+
+	s = audio_mix_cache_copy(&cache, pcm, ARRAY_SIZE(pcm));
+	zassert_not_null(s);
+	zassert_equal(s->frames, ARRAY_SIZE(pcm));
+	zassert_mem_equal(s->pcm, pcm, sizeof(pcm));
+
+	zassert_is_null(audio_mix_cache_add(&cache, 8, decode_fail, NULL));
+	zassert_is_null(audio_mix_cache_add(&cache, 4 * RATE, decode_const, NULL));
+	zassert_not_null(audio_mix_cache_add(&cache, 8, decode_const, NULL));
+	zassert_not_null(audio_mix_cache_add(&cache, 8, decode_const, NULL));
+	zassert_not_null(audio_mix_cache_add(&cache, 8, decode_const, NULL));
+	/* Out of sound slots */
+	zassert_is_null(audio_mix_cache_add(&cache, 8, decode_const, NULL));
+
+	audio_mix_cache_clear(&cache);
+	zassert_not_null(audio_mix_cache_add(&cache, 4 * RATE, decode_const, NULL));
+}
+
+struct stream {
+	struct audio_osc osc;
+	size_t left;
+};
+
+static size_t render(int16_t *dst, size_t frames, void *user_data)
+{
+	struct stream *st = user_data;
+	const size_t n = MIN(frames, st->left);
+
+	audio_osc_fill(&st->osc, dst, n, 1);
+	st->left -= n;
+
+	return n;
+}
+
+ZTEST(audio_mix, test_stream)
+{
+	static int16_t ref[FRAMES];
+	struct stream st = {.left = FRAMES + 10};
+	struct audio_osc osc;
+	int v;
+
+	audio_osc_init(&st.osc, AUDIO_OSC_SINE, 1000, RATE, 16000);
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 1000, RATE, 16000);
+	audio_osc_fill(&osc, ref, FRAMES, 1);
+
+	v = audio_mix_play_stream(&mono, render, &st, &unity);
+	zassert_true(v >= 0);
+	mix(&mono);
+	for (size_t i = 0; i < FRAMES; i++) {
+		zassert_within(block[i], ref[i], 1, "frame %zu", i);
+	}
+
+	/* The stream runs dry after 10 frames and the voice ends */
+	mix(&mono);
+	zassert_false(audio_mix_is_playing(&mono, v));
+	zassert_equal(block[10], 0);
+}
+
+ZTEST(audio_mix, test_benchmark)
+{
+	static const uint8_t counts[] = {1, 4, 8};
+	const struct audio_mix_voice_cfg cfg = {.gain = 4000, .loop = true};
+	const struct audio_mix_sound *sounds[4];
+	struct audio_mix_stats stats;
+	uint64_t start, best;
+
+	for (size_t i = 0; i < ARRAY_SIZE(sounds); i++) {
+		sounds[i] = audio_mix_cache_add(&cache, RATE / 4, decode_sine,
+						UINT_TO_POINTER(300 + 200 * i));
+		zassert_not_null(sounds[i]);
+	}
+
+	for (size_t c = 0; c < ARRAY_SIZE(counts); c++) {
+		audio_mix_init(&mono, RATE);
+
+		for (uint8_t i = 0; i < counts[c]; i++) {
+			zassert_true(audio_mix_play(&mono, sounds[i % ARRAY_SIZE(sounds)], &cfg) >= 0);
+		}
+
+		best = UINT64_MAX;
+		for (int run = 0; run < BENCH_RUNS; run++) {
+			start = bench_start();
+			for (int b = 0; b < BENCH_BLOCKS; b++) {
+				mix(&mono);
+			}
+			bench_stop(&best, start);
+		}
+		best /= BENCH_BLOCKS;
+
+		audio_mix_get_stats(&mono, &stats);
+		TC_PRINT("%u voices: %u ns per %u frame block\n", counts[c], (uint32_t)best,
+			 FRAMES);
+		zassert_equal(stats.max_voices, counts[c]);
+		zassert_true(best < counts[c] * VOICE_BUDGET_NS, "%u voices took %u ns",
+			     counts[c], (uint32_t)best);
+	}
+}
+
+ZTEST_SUITE(audio_mix, NULL, NULL, before, NULL, NULL);
@@ -0,0 +1,174 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test audio_osc library
+ *
+ * This suite checks the oscillator against libm and benchmarks it against a
+ * per-sample double precision sin().
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <zephyr/ztest.h>
+
+#include <app/lib/audio_osc.h>
+
+#include <bench.h>
+
+#define RATE 16000
+#define FRAMES 1024
+/* Interpolation error of the 256 entry table, in Q15 LSB */
+#define SIN_TOLERANCE 4
+
+static int16_t buf[FRAMES * 2];
+
+ZTEST(audio_osc, test_sin)
+{
+	int32_t max_err = 0;
+
+	for (uint64_t p = 0; p < BIT64(32); p += 0x10001) {
+		const int32_t ref = (int32_t)lround(32767.0 * sin(2.0 * M_PI * (double)p / BIT64(32)));
+
+		max_err = MAX(max_err, abs(audio_osc_sin((uint32_t)p) - ref));
+	}
+	TC_PRINT("sine: max error %d LSB\n", max_err);
+	zassert_true(max_err <= SIN_TOLERANCE, "max error %d", max_err);
+
+	zassert_equal(audio_osc_sin(0), 0);
+	zassert_equal(audio_osc_sin(BIT(30)), 32767);
+	zassert_equal(audio_osc_sin(BIT(31)), 0);
+	zassert_equal(audio_osc_sin(3 * BIT(30)), -32767);
+}
+
+ZTEST(audio_osc, test_sine_block)
+{
+	struct audio_osc osc;
+
+	/* 1 kHz is 16 samples per turn, channels carry the same sample */
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 1000, RATE, 16384);
+	audio_osc_fill(&osc, buf, 16, 2);
+
+	for (int i = 0; i < 16; i++) {
+		const double ref = 16384.0 * sin(2.0 * M_PI * i / 16);
+
+		zassert_within(buf[2 * i], ref, SIN_TOLERANCE, "sample %d: %d", i, buf[2 * i]);
+		zassert_equal(buf[2 * i], buf[2 * i + 1]);
+	}
+	zassert_equal(osc.phase, 0, "a whole turn must wrap exactly");
+}
+
+ZTEST(audio_osc, test_set_freq_keeps_phase)
+{
+	struct audio_osc osc;
+	uint32_t phase;
+
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 440, RATE, 32767);
+	audio_osc_fill(&osc, buf, 101, 1);
+	phase = osc.phase;
+	zassert_not_equal(phase, 0);
+
+	audio_osc_set_freq(&osc, 880, RATE);
+	zassert_equal(osc.phase, phase);
+
+	/* The first sample at the new frequency continues the waveform */
+	audio_osc_fill(&osc, buf, 1, 1);
+	zassert_within(buf[0], audio_osc_sin(phase), 1);
+	zassert_equal(osc.phase, phase + osc.step);
+}
+
+ZTEST(audio_osc, test_square_saw)
+{
+	struct audio_osc osc;
+
+	audio_osc_init(&osc, AUDIO_OSC_SQUARE, RATE / 8, RATE, 1000);
+	audio_osc_fill(&osc, buf, 8, 1);
+	for (int i = 0; i < 8; i++) {
+		zassert_equal(buf[i], (i < 4) ? 1000 : -1000, "sample %d: %d", i, buf[i]);
+	}
+
+	audio_osc_init(&osc, AUDIO_OSC_SAW, RATE / 4, RATE, 32767);
+	audio_osc_fill(&osc, buf, 4, 1);
+	zassert_equal(buf[0], -32767);
+	zassert_equal(buf[1], -16384);
+	zassert_equal(buf[2], 0);
+	zassert_equal(buf[3], 16383);
+}
+
+ZTEST(audio_osc, test_noise)
+{
+	struct audio_osc osc;
+	int64_t sum = 0;
+	int16_t min = INT16_MAX, max = INT16_MIN;
+
+	audio_osc_init(&osc, AUDIO_OSC_NOISE, 0, RATE, 32767);
+	audio_osc_fill(&osc, buf, FRAMES, 1);
+
+	for (int i = 0; i < FRAMES; i++) {
+		sum += buf[i];
+		min = MIN(min, buf[i]);
+		max = MAX(max, buf[i]);
+	}
+	/* Zero mean within a few standard deviations, near full scale */
+	zassert_true(llabs(sum / FRAMES) < 2048, "mean %lld", sum / FRAMES);
+	zassert_true((min < -30000) && (max > 30000), "range %d..%d", min, max);
+}
+
+/* The per-sample path the oscillator replaces */
+static void double_sin_fill(int16_t *samples, size_t frames, uint32_t *phase, uint32_t freq)
+{
+	for (size_t i = 0; i < frames; i++) {
+		const double rad = 2.0 * M_PI * (double)((*phase * freq) % RATE) / RATE;
+
+		samples[2 * i] = (int16_t)(8000 * sin(rad));
+		samples[2 * i + 1] = samples[2 * i];
+		*phase = (*phase + 1) % RATE;
+	}
+}
+
+ZTEST(audio_osc, test_benchmark)
+{
+	static const struct {
+		const char *name;
+		enum audio_osc_wave wave;
+	} waves[] = {
+		{"sine", AUDIO_OSC_SINE},
+		{"square", AUDIO_OSC_SQUARE},
+		{"saw", AUDIO_OSC_SAW},
+		{"noise", AUDIO_OSC_NOISE},
+	};
+	struct audio_osc osc;
+	uint64_t start, best, sine = 0;
+	uint32_t phase = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(waves); i++) {
+		audio_osc_init(&osc, waves[i].wave, 440, RATE, 8000);
+		best = UINT64_MAX;
+		for (int run = 0; run < BENCH_RUNS; run++) {
+			start = bench_start();
+			audio_osc_fill(&osc, buf, FRAMES, 2);
+			bench_stop(&best, start);
+		}
+		if (waves[i].wave == AUDIO_OSC_SINE) {
+			sine = best;
+		}
+		TC_PRINT("%s: %u ns per 1000 stereo frames\n", waves[i].name,
+			 (uint32_t)(best * 1000 / FRAMES));
+	}
+
+	best = UINT64_MAX;
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		start = bench_start();
+		double_sin_fill(buf, FRAMES, &phase, 440);
+		bench_stop(&best, start);
+	}
+	TC_PRINT("double sin(): %u ns per 1000 stereo frames\n", (uint32_t)(best * 1000 / FRAMES));
+
+	/* The table oscillator has to beat libm to be worth having */
+	zassert_true(sine < best, "DDS sine %u ns, double sin() %u ns", (uint32_t)sine,
+		     (uint32_t)best);
+}
+
+ZTEST_SUITE(audio_osc, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,355 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test audio_out library
+ *
+ * This suite runs the audio output engine against a fake I2S TX stream that
+ * releases one block per period from a timer and enters the error state
+ * when its queue runs dry, as DMA based drivers do. It can refuse mono
+ * streams like controllers without a mono mode.
+ */
+
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2s.h>
+#include <zephyr/ztest.h>
+
+#include <app/lib/audio_out.h>
+
+#define RATE 16000
+#define CHANNELS 2
+/* 64 stereo frames, 4 ms */
+#define BLOCK_SIZE 256
+#define BLOCK_US 4000
+#define DEPTH 3
+
+struct fake_i2s_data {
+	struct i2s_config cfg;
+	enum i2s_state state;
+	bool draining;
+	bool no_mono;
+	uint32_t played;
+	/* Copy of the first block written */
+	uint8_t first[BLOCK_SIZE];
+	bool captured;
+	struct k_timer timer;
+};
+
+K_MSGQ_DEFINE(fake_i2s_queue, sizeof(void *), DEPTH + 1, sizeof(void *));
+
+static struct fake_i2s_data fake_i2s_data;
+
+static void fake_i2s_flush(struct fake_i2s_data *data)
+{
+	void *block;
+
+	k_timer_stop(&data->timer);
+	while (k_msgq_get(&fake_i2s_queue, &block, K_NO_WAIT) == 0) {
+		k_mem_slab_free(data->cfg.mem_slab, block);
+	}
+	data->draining = false;
+}
+
+/* One block goes out per period */
+static void fake_i2s_tick(struct k_timer *timer)
+{
+	struct fake_i2s_data *data = CONTAINER_OF(timer, struct fake_i2s_data, timer);
+	void *block;
+
+	if (k_msgq_get(&fake_i2s_queue, &block, K_NO_WAIT) == 0) {
+		k_mem_slab_free(data->cfg.mem_slab, block);
+		data->played++;
+		return;
+	}
+
+	k_timer_stop(timer);
+	data->state = data->draining ? I2S_STATE_READY : I2S_STATE_ERROR;
+	data->draining = false;
+}
+
+static int fake_i2s_configure(const struct device *dev, enum i2s_dir dir,
+			      const struct i2s_config *cfg)
+{
+	struct fake_i2s_data *data = dev->data;
+
+	if ((dir != I2S_DIR_TX) || (data->no_mono && (cfg->channels == 1))) {
+		return -ENOTSUP;
+	}
+
+	fake_i2s_flush(data);
+	data->cfg = *cfg;
+	data->state = I2S_STATE_READY;
+	return 0;
+}
+
+static const struct i2s_config *fake_i2s_config_get(const struct device *dev, enum i2s_dir dir)
+{
+	struct fake_i2s_data *data = dev->data;
+
+	return &data->cfg;
+}
+
+static int fake_i2s_write(const struct device *dev, void *mem_block, size_t size)
+{
+	struct fake_i2s_data *data = dev->data;
+
+	if ((data->state != I2S_STATE_READY) && (data->state != I2S_STATE_RUNNING)) {
+		return -EIO;
+	}
+	zassert_equal(size, data->cfg.block_size);
+	if (!data->captured) {
+		memcpy(data->first, mem_block, size);
+		data->captured = true;
+	}
+
+	return k_msgq_put(&fake_i2s_queue, &mem_block, K_MSEC(data->cfg.timeout)) ? -ENOMEM : 0;
+}
+
+static int fake_i2s_trigger(const struct device *dev, enum i2s_dir dir, enum i2s_trigger_cmd cmd)
+{
+	struct fake_i2s_data *data = dev->data;
+
+	switch (cmd) {
+	case I2S_TRIGGER_START:
+		if ((data->state != I2S_STATE_READY) || (k_msgq_num_used_get(&fake_i2s_queue) == 0)) {
+			return -EIO;
+		}
+		data->state = I2S_STATE_RUNNING;
+		k_timer_start(&data->timer, K_USEC(BLOCK_US), K_USEC(BLOCK_US));
+		return 0;
+	case I2S_TRIGGER_DRAIN:
+		if (data->state != I2S_STATE_RUNNING) {
+			return -EIO;
+		}
+		data->draining = true;
+		return 0;
+	case I2S_TRIGGER_DROP:
+	case I2S_TRIGGER_PREPARE:
+		fake_i2s_flush(data);
+		data->state = I2S_STATE_READY;
+		return 0;
+	default:
+		return -EIO;
+	}
+}
+
+static int fake_i2s_init(const struct device *dev)
+{
+	struct fake_i2s_data *data = dev->data;
+
+	k_timer_init(&data->timer, fake_i2s_tick, NULL);
+	data->state = I2S_STATE_NOT_READY;
+	return 0;
+}
+
+static const struct i2s_driver_api fake_i2s_api = {
+	.configure = fake_i2s_configure,
+	.config_get = fake_i2s_config_get,
+	.write = fake_i2s_write,
+	.trigger = fake_i2s_trigger,
+};
+
+DEVICE_DEFINE(fake_i2s, "fake_i2s", fake_i2s_init, NULL, &fake_i2s_data, NULL, POST_KERNEL,
+	      CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &fake_i2s_api);
+
+AUDIO_OUT_DEFINE(test_out, BLOCK_SIZE, DEPTH);
+
+struct producer {
+	uint32_t filled;
+	/* End the stream after this many blocks, 0 to run until stopped */
+	uint32_t end_after;
+	/* Block that takes stall_us to fill */
+	uint32_t stall_block;
+	uint32_t stall_us;
+};
+
+static int produce(void *block, size_t size, void *user_data)
+{
+	struct producer *p = user_data;
+	uint8_t *buf = block;
+
+	if (p->end_after && (p->filled == p->end_after)) {
+		return 1;
+	}
+	if (p->stall_us && (p->filled == p->stall_block)) {
+		k_busy_wait(p->stall_us);
+	}
+
+	memset(buf, (uint8_t)p->filled, size);
+	p->filled++;
+	return 0;
+}
+
+/* Mono ramp of 16-bit samples counting from 1 */
+static int produce_ramp(void *block, size_t size, void *user_data)
+{
+	struct producer *p = user_data;
+	int16_t *samples = block;
+
+	for (size_t i = 0; i < size / sizeof(int16_t); i++) {
+		samples[i] = (int16_t)(i + 1);
+	}
+	p->filled++;
+	return 0;
+}
+
+static const struct i2s_config stream_cfg = {
+	.word_size = 16,
+	.channels = CHANNELS,
+	.format = I2S_FMT_DATA_FORMAT_I2S,
+	.options = I2S_OPT_BIT_CLK_MASTER | I2S_OPT_FRAME_CLK_MASTER,
+	.frame_clk_freq = RATE,
+	.timeout = 100,
+};
+
+static void audio_out_before(void *f)
+{
+	ARG_UNUSED(f);
+
+	fake_i2s_data.played = 0;
+	fake_i2s_data.captured = false;
+	fake_i2s_data.no_mono = false;
+}
+
+static void audio_out_after(void *f)
+{
+	ARG_UNUSED(f);
+
+	(void)audio_out_stop(&test_out);
+}
+
+ZTEST(audio_out, test_playback)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct producer p = {0};
+	struct audio_out_stats stats;
+
+	zassert_ok(audio_out_start(&test_out, i2s, &stream_cfg, produce, &p));
+	/* The queue is full before the stream starts */
+	zassert_equal(p.filled, DEPTH);
+
+	k_sleep(K_USEC(BLOCK_US * 25));
+	zassert_ok(audio_out_stop(&test_out));
+
+	audio_out_get_stats(&test_out, &stats);
+	TC_PRINT("%u blocks, %u underruns, %u late fills, min depth %u, max fill %u us\n",
+		 stats.blocks, stats.underruns, stats.late_fills, stats.min_depth,
+		 stats.max_fill_us);
+	zassert_true(stats.blocks >= 20, "%u blocks", stats.blocks);
+	zassert_equal(stats.underruns, 0);
+	zassert_equal(stats.late_fills, 0);
+	zassert_true(stats.min_depth >= 1);
+
+	/* Stopping plays out what was queued */
+	zassert_equal(fake_i2s_data.played, stats.blocks);
+	zassert_equal(k_mem_slab_num_used_get(test_out.slab), 0);
+}
+
+ZTEST(audio_out, test_underrun)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct producer p = {
+		.stall_block = 10,
+		.stall_us = BLOCK_US * (DEPTH + 2),
+	};
+	struct audio_out_stats stats;
+
+	zassert_ok(audio_out_start(&test_out, i2s, &stream_cfg, produce, &p));
+	k_sleep(K_USEC(BLOCK_US * 40));
+
+	audio_out_get_stats(&test_out, &stats);
+	TC_PRINT("%u blocks, %u underruns, %u late fills, min depth %u, max fill %u us\n",
+		 stats.blocks, stats.underruns, stats.late_fills, stats.min_depth,
+		 stats.max_fill_us);
+	zassert_equal(stats.underruns, 1, "%u underruns", stats.underruns);
+	zassert_true(stats.late_fills >= 1);
+	zassert_true(stats.max_fill_us >= p.stall_us);
+
+	/* Playback went on after the restart */
+	zassert_true(p.filled > p.stall_block + DEPTH, "%u blocks filled", p.filled);
+	zassert_ok(audio_out_stop(&test_out));
+}
+
+ZTEST(audio_out, test_end_of_stream)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct producer p = {.end_after = 10};
+	struct audio_out_stats stats;
+
+	zassert_ok(audio_out_start(&test_out, i2s, &stream_cfg, produce, &p));
+	k_sleep(K_USEC(BLOCK_US * 15));
+	zassert_ok(audio_out_stop(&test_out));
+
+	audio_out_get_stats(&test_out, &stats);
+	zassert_equal(stats.blocks, 10);
+	zassert_equal(fake_i2s_data.played, 10);
+	zassert_equal(stats.underruns, 0);
+}
+
+ZTEST(audio_out, test_mono)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct i2s_config mono = stream_cfg;
+	const int16_t *samples = (const int16_t *)fake_i2s_data.first;
+	struct producer p = {0};
+
+	/* The controller takes mono, a block holds twice the frames */
+	mono.channels = 1;
+	zassert_ok(audio_out_start(&test_out, i2s, &mono, produce_ramp, &p));
+	zassert_false(audio_out_is_expanding(&test_out));
+	zassert_equal(test_out.block_us, 2 * BLOCK_US);
+	zassert_ok(audio_out_stop(&test_out));
+
+	for (int i = 0; i < BLOCK_SIZE / 2; i++) {
+		zassert_equal(samples[i], i + 1);
+	}
+}
+
+ZTEST(audio_out, test_mono_expand)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct i2s_config mono = stream_cfg;
+	const int16_t *samples = (const int16_t *)fake_i2s_data.first;
+	struct producer p = {0};
+
+	/* Without a mono mode the engine sends every frame on both slots */
+	fake_i2s_data.no_mono = true;
+	mono.channels = 1;
+	zassert_ok(audio_out_start(&test_out, i2s, &mono, produce_ramp, &p));
+	zassert_true(audio_out_is_expanding(&test_out));
+	zassert_equal(fake_i2s_data.cfg.channels, 2);
+	zassert_equal(test_out.block_us, BLOCK_US);
+	zassert_ok(audio_out_stop(&test_out));
+
+	for (int i = 0; i < BLOCK_SIZE / 4; i++) {
+		zassert_equal(samples[2 * i], i + 1, "frame %d", i);
+		zassert_equal(samples[2 * i + 1], i + 1, "frame %d", i);
+	}
+
+	/* Only 16-bit mono is expanded */
+	mono.word_size = 32;
+	zassert_equal(audio_out_start(&test_out, i2s, &mono, produce_ramp, &p), -ENOTSUP);
+}
+
+ZTEST(audio_out, test_state)
+{
+	const struct device *i2s = DEVICE_GET(fake_i2s);
+	struct i2s_config odd = stream_cfg;
+	struct producer p = {0};
+
+	zassert_equal(audio_out_stop(&test_out), -EALREADY);
+
+	/* 256 bytes do not hold whole 3 channel frames */
+	odd.channels = 3;
+	zassert_equal(audio_out_start(&test_out, i2s, &odd, produce, &p), -EINVAL);
+
+	zassert_ok(audio_out_start(&test_out, i2s, &stream_cfg, produce, &p));
+	zassert_equal(audio_out_start(&test_out, i2s, &stream_cfg, produce, &p), -EBUSY);
+	zassert_ok(audio_out_stop(&test_out));
+	zassert_equal(audio_out_stop(&test_out), -EALREADY);
+}
+
+ZTEST_SUITE(audio_out, NULL, NULL, audio_out_before, audio_out_after, NULL);
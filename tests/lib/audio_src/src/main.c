@@ -0,0 +1,220 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file test audio_src library
+ *
+ * This suite streams oscillator tones through the converter, checks the
+ * output rate, gain and alias rejection, and benchmarks the fixed-point
+ * filter against the same filter in float.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include <app/lib/audio_osc.h>
+#include <app/lib/audio_src.h>
+
+#include <bench.h>
+
+#define AMPLITUDE 20000
+/* 10 ms at 44.1 kHz */
+#define BLOCK_FRAMES 441
+#define BLOCKS 50
+/* Blocks left out of the measurements while the filter fills */
+#define WARMUP 2
+
+AUDIO_SRC_DEFINE(src_16, 16, 64);
+AUDIO_SRC_DEFINE(src_32, 32, 128);
+
+/* Room for upsampling a block by 3 */
+static int16_t buf[3 * BLOCK_FRAMES + 8];
+
+struct run_result {
+	size_t frames;
+	double rms;
+};
+
+/* Convert BLOCKS blocks of a tone, freq_hz 0 for DC */
+static struct run_result run(struct audio_src *src, uint32_t in_rate, uint32_t out_rate,
+			     uint32_t freq_hz, size_t block_frames)
+{
+	struct run_result res = {0};
+	struct audio_osc osc;
+	double sum = 0;
+	size_t n = 0;
+
+	zassert_ok(audio_src_set_rates(src, in_rate, out_rate));
+	audio_osc_init(&osc, freq_hz ? AUDIO_OSC_SINE : AUDIO_OSC_SQUARE, freq_hz, in_rate,
+		       AMPLITUDE);
+
+	for (int b = 0; b < BLOCKS; b++) {
+		size_t out;
+
+		audio_osc_fill(&osc, buf, block_frames, 1);
+		zassert_true(audio_src_out_max(src, block_frames) <= ARRAY_SIZE(buf));
+		out = audio_src_process(src, buf, block_frames, ARRAY_SIZE(buf));
+		res.frames += out;
+
+		if (b >= WARMUP) {
+			for (size_t i = 0; i < out; i++) {
+				sum += (double)buf[i] * buf[i];
+			}
+			n += out;
+		}
+	}
+	res.rms = sqrt(sum / n);
+
+	return res;
+}
+
+static double gain_db(double rms)
+{
+	return 20 * log10(rms / (AMPLITUDE / sqrt(2)));
+}
+
+ZTEST(audio_src, test_rates)
+{
+	static const struct {
+		uint32_t in, out;
+	} ratios[] = {
+		{44100, 16000}, {22050, 16000}, {48000, 16000}, {16000, 48000}, {8000, 11025},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(ratios); i++) {
+		const size_t block = ratios[i].in / 100;
+		const double expect = (double)BLOCKS * block * ratios[i].out / ratios[i].in;
+		struct run_result res = run(&src_16, ratios[i].in, ratios[i].out, 0, block);
+
+		/* The converter does not drift, DC passes at unity gain */
+		zassert_within(res.frames, expect, 1.5, "%u -> %u: %zu frames", ratios[i].in,
+			       ratios[i].out, res.frames);
+		zassert_within(res.rms, AMPLITUDE, 2, "%u -> %u: rms %d", ratios[i].in,
+			       ratios[i].out, (int)res.rms);
+	}
+
+	zassert_equal(audio_src_set_rates(&src_16, 0, 16000), -EINVAL);
+	zassert_equal(audio_src_set_rates(&src_16, 192000, 16000), -EINVAL);
+	zassert_equal(audio_src_set_rates(&src_16, 8000, 96000), -EINVAL);
+}
+
+ZTEST(audio_src, test_block_split)
+{
+	static int16_t whole[BLOCK_FRAMES];
+	struct audio_osc osc;
+	size_t n = 0, total, out;
+
+	/* One block in one go */
+	zassert_ok(audio_src_set_rates(&src_16, 44100, 16000));
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 1000, 44100, AMPLITUDE);
+	audio_osc_fill(&osc, buf, BLOCK_FRAMES, 1);
+	total = audio_src_process(&src_16, buf, BLOCK_FRAMES, ARRAY_SIZE(buf));
+	memcpy(whole, buf, total * sizeof(buf[0]));
+
+	/* The same samples in blocks of 7, the history carries over */
+	audio_src_reset(&src_16);
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 1000, 44100, AMPLITUDE);
+	for (size_t i = 0; i < BLOCK_FRAMES; i += 7) {
+		int16_t part[8];
+
+		audio_osc_fill(&osc, part, 7, 1);
+		out = audio_src_process(&src_16, part, 7, ARRAY_SIZE(part));
+		for (size_t j = 0; j < out; j++, n++) {
+			zassert_equal(part[j], whole[n], "frame %zu", n);
+		}
+	}
+	zassert_equal(n, total);
+}
+
+ZTEST(audio_src, test_passband)
+{
+	static const uint32_t freqs[] = {100, 1000, 2000, 3000};
+
+	for (size_t i = 0; i < ARRAY_SIZE(freqs); i++) {
+		const double db = gain_db(run(&src_32, 44100, 16000, freqs[i], BLOCK_FRAMES).rms);
+
+		TC_PRINT("44.1 kHz -> 16 kHz, %u Hz: %d mdB\n", freqs[i], (int)(db * 1000));
+		zassert_within(db, 0, 0.5, "%u Hz", freqs[i]);
+	}
+
+	zassert_within(gain_db(run(&src_16, 16000, 48000, 1000, 160).rms), 0, 0.1);
+}
+
+ZTEST(audio_src, test_alias_rejection)
+{
+	/* Above the 8 kHz output Nyquist, these would fold back into the audio band */
+	static const uint32_t freqs[] = {10000, 12000, 16000, 20000};
+
+	for (size_t i = 0; i < ARRAY_SIZE(freqs); i++) {
+		const double db = gain_db(run(&src_32, 44100, 16000, freqs[i], BLOCK_FRAMES).rms);
+
+		TC_PRINT("44.1 kHz -> 16 kHz, %u Hz: %d dB\n", freqs[i], (int)db);
+		zassert_true(db < -38, "%u Hz at %d dB", freqs[i], (int)db);
+	}
+}
+
+/* The same 32 x 128 polyphase filter with float coefficients and accumulation */
+static size_t float_src(const float *coeffs, uint64_t step, const int16_t *in,
+			size_t in_frames, int16_t *out)
+{
+	size_t n = 0;
+
+	for (uint64_t pos = (uint64_t)31 << 32; (pos >> 32) < in_frames; pos += step) {
+		const int16_t *win = &in[(pos >> 32) - 31];
+		const float *c = &coeffs[((((uint32_t)pos >> 24) + 1) >> 1) * 32];
+		float acc = 0;
+
+		for (int k = 0; k < 32; k++) {
+			acc += win[k] * c[k];
+		}
+		out[n++] = (int16_t)acc;
+	}
+
+	return n;
+}
+
+ZTEST(audio_src, test_benchmark)
+{
+	static struct audio_src *const srcs[] = {&src_16, &src_32};
+	static int16_t in[BLOCK_FRAMES];
+	static float coeffs[32 * 129];
+	struct audio_osc osc;
+	uint64_t start, best;
+	size_t out = 0;
+
+	audio_osc_init(&osc, AUDIO_OSC_SINE, 1000, 44100, AMPLITUDE);
+	audio_osc_fill(&osc, in, BLOCK_FRAMES, 1);
+
+	for (size_t i = 0; i < ARRAY_SIZE(srcs); i++) {
+		zassert_ok(audio_src_set_rates(srcs[i], 44100, 16000));
+		best = UINT64_MAX;
+
+		for (int run = 0; run < BENCH_RUNS; run++) {
+			audio_src_reset(srcs[i]);
+			memcpy(buf, in, sizeof(in));
+			start = bench_start();
+			out = audio_src_process(srcs[i], buf, BLOCK_FRAMES, ARRAY_SIZE(buf));
+			bench_stop(&best, start);
+		}
+		TC_PRINT("q14, %u taps x %u phases: %u ns per 1000 output frames\n",
+			 srcs[i]->taps, srcs[i]->phases, (uint32_t)(best * 1000 / out));
+	}
+
+	for (size_t k = 0; k < ARRAY_SIZE(coeffs); k++) {
+		coeffs[k] = src_32.coeffs[k] / 16384.0f;
+	}
+	best = UINT64_MAX;
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		start = bench_start();
+		out = float_src(coeffs, ((uint64_t)44100 << 32) / 16000, in, BLOCK_FRAMES, buf);
+		bench_stop(&best, start);
+	}
+	TC_PRINT("float, 32 taps x 128 phases: %u ns per 1000 output frames\n",
+		 (uint32_t)(best * 1000 / out));
+	zassert_true(best > 0, "host clock did not advance");
+}
+
+ZTEST_SUITE(audio_src, NULL, NULL, NULL, NULL, NULL);